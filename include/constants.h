@@ -75,6 +75,14 @@ extern "C"
  */
 #define DEFAULT_TTY_WIDTH 80
 
+/**
+ * @def RESULTS_ARENA_BLOCK
+ *
+ * Size in bytes of each block of memory allocated for inspection
+ * results and their strings.
+ */
+#define RESULTS_ARENA_BLOCK 65536
+
 /** @} */
 
 /**
@@ -128,6 +136,31 @@ extern "C"
  */
 #define PRODUCT_RELEASE_CFGFILE_SUBDIR "product-release"
 
+/**
+ * @def SNAPSHOT_MAGIC
+ *
+ * The first bytes of a configuration snapshot written by
+ * --compile-config.  Used to tell a snapshot from a configuration
+ * file given with -c.
+ */
+#define SNAPSHOT_MAGIC "RPMISNAP"
+
+/**
+ * @def SNAPSHOT_MAGIC_LEN
+ *
+ * Length of SNAPSHOT_MAGIC without the terminating NUL.
+ */
+#define SNAPSHOT_MAGIC_LEN 8
+
+/**
+ * @def SNAPSHOT_FORMAT
+ *
+ * Version of the configuration snapshot format.  Increment this when
+ * the layout changes or struct rpminspect gains a configuration
+ * setting so older snapshots are rejected.
+ */
+#define SNAPSHOT_FORMAT 1
+
 /**
  * @def DEFAULT_WORKDIR
  *
@@ -398,6 +431,82 @@ extern "C"
  */
 #define UDEVADM_CMD "udevadm"
 
+/**
+ * @def XZ_CMD
+ *
+ * Executable providing xz(1), used to decompress large xz payloads
+ * with multiple threads.
+ */
+#define XZ_CMD "xz"
+
+/**
+ * @def ZSTD_CMD
+ *
+ * Executable providing zstd(1), used to decompress large zstd
+ * payloads in a separate process.
+ */
+#define ZSTD_CMD "zstd"
+
+/**
+ * @def PAYLOAD_HELPER_THRESHOLD
+ *
+ * Packages at least this many bytes in size with an xz or zstd
+ * payload are decompressed by XZ_CMD or ZSTD_CMD running alongside
+ * rpminspect rather than by libarchive.  Below this size the cost of
+ * starting another process outweighs the gain.
+ */
+#define PAYLOAD_HELPER_THRESHOLD 67108864
+
+/**
+ * @def PARALLEL_WORKER_FOOTPRINT
+ *
+ * Memory in bytes each parallel worker process is expected to need.
+ * When rpminspect runs under a cgroup memory limit, the number of
+ * workers is reduced so this much is available to every one of them.
+ */
+#define PARALLEL_WORKER_FOOTPRINT 268435456
+
+/**
+ * @def SERVE_MAX_REQUEST
+ *
+ * Largest request in bytes accepted by the --serve mode.  A request is
+ * the working directory and command line of one rpminspect run.
+ */
+#define SERVE_MAX_REQUEST 1048576
+
+/**
+ * @def SERVE_IDLE_REFRESH
+ *
+ * Seconds the --serve mode waits without a request before checking
+ * whether the data it loaded ahead of time changed on disk.
+ */
+#define SERVE_IDLE_REFRESH 10
+
+/**
+ * @def PACKAGE_CACHE_SIZE
+ *
+ * Default size limit in MiB of the shared package cache set with the
+ * package_cache configuration setting.
+ */
+#define PACKAGE_CACHE_SIZE 10240
+
+/**
+ * @def RESULT_CACHE_FORMAT
+ *
+ * First line of every file in the result cache directory (-R).
+ * Change the version when the file format changes so old files are
+ * no longer used.
+ */
+#define RESULT_CACHE_FORMAT "rpminspect-results 2"
+
+/**
+ * @def COMMAND_CACHE_DIR
+ *
+ * Subdirectory of the result cache directory holding the saved output
+ * of external commands.
+ */
+#define COMMAND_CACHE_DIR "commands"
+
 /** @} */
 
 /**
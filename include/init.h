@@ -108,6 +108,8 @@ extern "C"
 #define RI_ON                       "on"
 #define RI_ORIGIN_PREFIX_TRIM       "origin_prefix_trim"
 #define RI_OWNERSHIP                "ownership"
+#define RI_PACKAGE_CACHE            "package_cache"
+#define RI_PACKAGE_CACHE_SIZE       "package_cache_size"
 #define RI_PATCHES                  "patches"
 #define RI_PATHMIGRATION            "pathmigration"
 #define RI_PERMISSIONS              "permissions"
@@ -156,7 +158,10 @@ extern "C"
 #define RI_VENDOR                   "vendor"
 #define RI_VIRUS                    "virus"
 #define RI_WORKDIR                  "workdir"
+#define RI_WORKERS                  "workers"
 #define RI_XML                      "xml"
+#define RI_XZ                       "xz"
+#define RI_ZSTD                     "zstd"
 
 #endif
 
@@ -103,6 +103,36 @@ const char *inspection_desc(const uint64_t id);
  */
 const char *inspection_header_to_desc(const char *header);
 
+/**
+ * @brief Return the data the given inspections need.
+ *
+ * Combine the NEEDS_* flags of every inspection selected in the
+ * tests bitfield.  The result tells the driver which pipeline phases
+ * can be skipped, for example extracting payloads when only header
+ * based inspections were selected.  Inspections that require a
+ * before build are ignored when single_build is true.
+ *
+ * @param tests Bitfield of selected INSPECT_* values.
+ * @param single_build True if only an after build is being inspected.
+ * @return Bitfield of NEEDS_* values.
+ */
+unsigned int inspection_needs(const uint64_t tests, const bool single_build);
+
+/**
+ * @brief Return true if any selected inspection reads the file.
+ *
+ * Used while extracting a payload to decide whether a member is
+ * written to disk.  Every member is still recorded in the file list
+ * with its fullpath set, but members no selected inspection reads are
+ * not written there.  An inspection that needs file contents and has
+ * no want_file_func reads all files.
+ *
+ * @param ri Pointer to the struct rpminspect used for the program.
+ * @param file The file to check, with fullpath already set.
+ * @return True if the file needs to be unpacked.
+ */
+bool inspection_wants_file(struct rpminspect *ri, const rpmfile_entry_t *file);
+
 /** @} */
 
 /**
@@ -139,6 +169,24 @@ bool inspect_elf(struct rpminspect *ri);
  */
 bool inspect_license(struct rpminspect *ri);
 
+/**
+ * @brief Build the license database indexes used by the 'license'
+ * inspection.
+ *
+ * The indexes do not depend on the build being inspected, so they
+ * are built once and kept.  They are built again only if the
+ * configuration names other license databases.  Used by the --serve
+ * mode so jobs forked from the server start with the indexes built.
+ *
+ * @param ri Pointer to the struct rpminspect for the program.
+ */
+void load_license_index(struct rpminspect *ri);
+
+/**
+ * @brief Free the license database indexes.
+ */
+void free_license_index(void);
+
 /**
  * @brief Perform the 'emptyrpm' inspection.
  *
@@ -161,6 +209,19 @@ bool inspect_emptyrpm(struct rpminspect *ri);
  */
 bool inspect_xml(struct rpminspect *ri);
 
+/**
+ * @brief Return true if the file is a candidate for the 'xml'
+ * inspection.
+ *
+ * Regular files in binary packages matching the xml path settings
+ * are candidates.  Used to decide which files to unpack.
+ *
+ * @param ri Pointer to the struct rpminspect for the program.
+ * @param file The file to check.
+ * @return True if the 'xml' inspection reads the file.
+ */
+bool is_xml_candidate(struct rpminspect *ri, const rpmfile_entry_t *file);
+
 /**
  * @brief Perform the 'manpage' inspection.
  *
@@ -174,6 +235,19 @@ bool inspect_xml(struct rpminspect *ri);
  */
 bool inspect_manpage(struct rpminspect *ri);
 
+/**
+ * @brief Return true if the file is a man page for the 'manpage'
+ * inspection.
+ *
+ * Regular files in binary packages matching the manpage path
+ * settings are man pages.  Used to decide which files to unpack.
+ *
+ * @param ri Pointer to the struct rpminspect for the program.
+ * @param file The file to check.
+ * @return True if the 'manpage' inspection reads the file.
+ */
+bool is_manpage_file(struct rpminspect *ri, const rpmfile_entry_t *file);
+
 /**
  * @brief Perform the 'metadata' inspection.
  *
@@ -640,6 +714,30 @@ bool inspect_patches(struct rpminspect *ri);
  */
 bool inspect_virus(struct rpminspect *ri);
 
+/**
+ * @brief Free the clamav engine loaded by the 'virus' inspection.
+ *
+ * The engine stays loaded after the inspection runs so batch mode
+ * does not reload the databases for every comparison.
+ */
+void free_virus_engine(void);
+
+/**
+ * @brief Load the clamav engine before any inspection runs.
+ *
+ * Used by the --serve mode so jobs forked from the server start with
+ * the virus databases already loaded.
+ */
+void preload_virus_engine(void);
+
+/**
+ * @brief Load the clamav engine again if its databases changed.
+ *
+ * Used by the --serve mode before each request so a long running
+ * server picks up signature updates.
+ */
+void refresh_virus_engine(void);
+
 /**
  * @brief Main driver for the 'politics' inspection.
  *
@@ -727,6 +825,19 @@ bool inspect_debuginfo(struct rpminspect *ri);
  */
 bool inspect_udevrules(struct rpminspect *ri);
 
+/**
+ * @brief Return true if the file is a udev rules file.
+ *
+ * Regular files in binary packages ending with the rules file
+ * extension in one of the udev_rules_dirs are udev rules files.
+ * Used to decide which files to unpack.
+ *
+ * @param ri Pointer to the struct rpminspect for the program.
+ * @param file The file to check.
+ * @return True if the 'udevrules' inspection reads the file.
+ */
+bool is_udev_rules_file(struct rpminspect *ri, const rpmfile_entry_t *file);
+
 /** @} */
 
 /**
@@ -1033,6 +1144,49 @@ bool inspect_udevrules(struct rpminspect *ri);
 
 /** @} */
 
+/**
+ * @defgroup INSPECTION_NEEDS Inspection data requirements
+ *
+ * Each inspection declares the data it reads so the driver only
+ * performs the phases the selected inspections need.  Headers are
+ * always available since peers are built from them.  Inspections
+ * reading the contents of files must also declare NEEDS_FILES.
+ *
+ * @{
+ */
+
+/**
+ * @def NEEDS_HEADERS
+ * Inspection reads RPM header tags.
+ */
+#define NEEDS_HEADERS                       (1 << 0)
+
+/**
+ * @def NEEDS_FILES
+ * Inspection reads the per-package file lists from the payload.
+ */
+#define NEEDS_FILES                         (1 << 1)
+
+/**
+ * @def NEEDS_CONTENTS
+ * Inspection reads the contents of extracted files.
+ */
+#define NEEDS_CONTENTS                      (1 << 2)
+
+/**
+ * @def NEEDS_PEERS
+ * Inspection compares files between the before and after builds.
+ */
+#define NEEDS_PEERS                         (1 << 3)
+
+/**
+ * @def NEEDS_ALL
+ * Everything, used when the inspection selection is not known yet.
+ */
+#define NEEDS_ALL                           (NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS)
+
+/** @} */
+
 /**
  * @defgroup INSPECTION_NAMES Names of inspections
  *
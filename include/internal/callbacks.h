@@ -31,13 +31,49 @@ typedef struct {
     string_map_t **table;
 } tabledict_cb_data;
 
-/* Context structure for lic_cb() in lib/inspect_license.c. */
+/*
+ * One key in a license database index in lib/inspect_license.c.  The
+ * count is the number of approved entries carrying the key.  In the
+ * legacy identifier index, spdx is how many of those entries also
+ * have an SPDX expression matching the key.  Entries allowed only for
+ * some packages are counted in packages, keyed by package name.
+ */
+typedef struct _license_index_t {
+    char *key;
+    int count;
+    int spdx;
+    struct _license_index_t *packages;
+    UT_hash_handle hh;
+} license_index_t;
+
+/* Indexes built from one license database in lib/inspect_license.c. */
+typedef struct _license_db_t {
+    license_index_t *spdx;      /* lowercase SPDX expressions */
+    license_index_t *legacy;    /* Fedora abbreviations and names */
+    TAILQ_ENTRY(_license_db_t) items;
+} license_db_t;
+
+typedef TAILQ_HEAD(license_db_s, _license_db_t) license_db_list_t;
+
+/* A validated License tag in lib/inspect_license.c, cached by the tag. */
+typedef struct _license_tag_t {
+    char *license;
+    bool balanced;               /* parens in the tag are balanced */
+    bool whole;                  /* the entire tag matched a db entry */
+    string_list_t *unapproved;   /* tokens not found in any db */
+    string_list_t *booleans;     /* AND/OR keywords as written */
+    string_list_t *keywords;     /* mixed case SPDX keywords found */
+    int nspdx;
+    int nlegacy;
+    int ndual;
+    UT_hash_handle hh;
+} license_tag_t;
+
+/* Context structure for index_cb() in lib/inspect_license.c. */
 typedef struct {
-    struct rpminspect *ri;
     parser_plugin *p;
     parser_context *db;
-    const char *lic;
-    bool valid;
+    license_db_t *index;
 } lic_cb_data;
 
 #endif /* _LIBRPMINSPECT_CALLBACKS_H */
@@ -0,0 +1,65 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * Static tracepoints (USDT) for profiling with SystemTap or bpftrace.
+ * Enabled by building with '-D with_usdt=true'.  Otherwise the probes
+ * compile to nothing and their arguments are not evaluated.
+ *
+ * All probes are in the 'rpminspect' provider and come in start/done
+ * pairs:
+ *
+ *     inspection__start(name)
+ *     inspection__done(name, result)
+ *     file__start(inspection, package, localpath)
+ *     file__done(inspection, package, localpath, result)
+ *     extract__start(package, subdir)
+ *     extract__done(package, subdir)
+ *     command__start(command)
+ *     command__done(command, status)
+ *     checksum__start(filename, type)
+ *     checksum__done(filename, type, digest)
+ *     mime__start(filename)
+ *     mime__done(filename, type)
+ *     download__start(url, destination)
+ *     download__done(url, destination, curlcode)
+ *
+ * Strings are passed as pointers and results as 0 or 1.  The command
+ * status is the waitpid(2) status, or -1 if the command could not be
+ * started.  A NULL digest or MIME type means the lookup failed.  For example:
+ *
+ *     bpftrace -e 'usdt:/usr/bin/rpminspect:rpminspect:file__start
+ *                  { @start[tid] = nsecs; }
+ *                  usdt:/usr/bin/rpminspect:rpminspect:file__done
+ *                  /@start[tid]/ { @ns[str(arg0), str(arg1)] = sum(nsecs - @start[tid]); }'
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifndef _LIBRPMINSPECT_PROBES_H
+#define _LIBRPMINSPECT_PROBES_H
+
+#ifdef _WITH_USDT
+#include <sys/sdt.h>
+
+#define RI_PROBE1(name, a) DTRACE_PROBE1(rpminspect, name, a)
+#define RI_PROBE2(name, a, b) DTRACE_PROBE2(rpminspect, name, a, b)
+#define RI_PROBE3(name, a, b, c) DTRACE_PROBE3(rpminspect, name, a, b, c)
+#define RI_PROBE4(name, a, b, c, d) DTRACE_PROBE4(rpminspect, name, a, b, c, d)
+#else
+#define RI_PROBE1(name, a) do { } while (0)
+#define RI_PROBE2(name, a, b) do { } while (0)
+#define RI_PROBE3(name, a, b, c) do { } while (0)
+#define RI_PROBE4(name, a, b, c, d) do { } while (0)
+#endif
+
+#endif /* _LIBRPMINSPECT_PROBES_H */
+
+#ifdef __cplusplus
+}
+#endif
@@ -34,6 +34,7 @@ typedef struct {
 
 extern unsigned default_parallel_processes;
 
+unsigned parallel_workers(unsigned long footprint);
 parallel_t *new_parallel(int max);
 void delete_parallel(parallel_t *col, int kill_sig);
 
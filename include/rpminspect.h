@@ -105,11 +105,14 @@ bool init_politics(struct rpminspect *ri);
 bool init_security(struct rpminspect *ri);
 bool init_icons(struct rpminspect *ri);
 struct rpminspect *xalloc_rpminspect(struct rpminspect *);
+struct rpminspect *read_rpminspect_config(struct rpminspect *, const char *, const char *);
+struct rpminspect *init_local_rpminspect(struct rpminspect *);
 struct rpminspect *init_rpminspect(struct rpminspect *, const char *, const char *);
 
 /* free.c */
 void free_string_hash(string_hash_t *hash);
 void free_string_map(string_map_t *table);
+void free_string_list_map(string_list_map_t *table);
 void free_regex(regex_t *regex);
 void free_rpminspect(struct rpminspect *);
 void free_deprules(deprule_list_t *list);
@@ -222,6 +225,8 @@ int copyfile(const char *, const char *, bool, bool);
 /* rpm.c */
 int init_librpm(struct rpminspect *ri);
 Header get_rpm_header(struct rpminspect *, const char *);
+int open_rpm_payload(struct rpminspect *, const char *);
+void uncache_rpm_header(struct rpminspect *ri, const char *pkg);
 char *get_rpmtag_str(Header, rpmTagVal);
 char *get_nevr(Header);
 char *get_nevra(Header);
@@ -237,6 +242,8 @@ bool is_debugsource_rpm(Header hdr);
 rpmpeer_t *init_peers(void);
 void free_peers(rpmpeer_t *);
 void add_peer(rpmpeer_t **, deprule_ignore_map_t *, int, bool, const char *, Header);
+void extract_peer(struct rpminspect *ri, rpmpeer_entry_t *peer, int whichbuild);
+void release_after_peers(rpmpeer_t *peers);
 
 /**
  * @brief Iterate over all packages and extract them.
@@ -260,29 +267,45 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
 bool process_file_path(const rpmfile_entry_t *file, regex_t *include_regex, regex_t *exclude_regex);
 void find_file_peers(struct rpminspect *ri, rpmfile_t *before, rpmfile_t *after);
 bool is_debug_or_build_path(const char *path);
+bool is_srpm_spec_file(struct rpminspect *ri, const rpmfile_entry_t *file);
 
 /* tty.c */
 size_t tty_width(void);
 
+/* arena.c */
+arena_t *new_arena(const size_t blocksize);
+void *arena_alloc(arena_t *arena, const size_t size);
+char *arena_strdup(arena_t *arena, const char *s);
+const char *arena_intern(arena_t *arena, const char *s);
+void free_arena(arena_t *arena);
+
 /* results.c */
 void init_result_params(struct result_params *);
 results_t *init_results(void);
 void free_results(results_t *);
 void add_result_entry(results_t **, struct result_params *);
 void add_result(struct rpminspect *, struct result_params *);
+results_header_t *get_results_header(const results_t *results, const char *header);
 bool suppressed_results(const results_t *results, const char *header, const severity_t suppress);
 void debug_print_result(const results_entry_t *result);
 
 /* output.c */
 const char *format_desc(unsigned int);
+output_stream_t *open_output_stream(const int format, const char *dest, const severity_t threshold, const severity_t suppress);
+void write_output_stream(output_stream_t *stream, const results_t *results);
+void close_output_stream(output_stream_t *stream, const results_t *results);
 
 /* output_text.c */
 void output_text(const results_t *, const char *, const severity_t, const severity_t);
 
 /* output_json.c */
+void json_stream_group(output_stream_t *stream, const results_entry_t *first);
+void json_stream_finish(output_stream_t *stream);
 void output_json(const results_t *, const char *, const severity_t, const severity_t);
 
 /* output_xunit.c */
+void xunit_stream_result(output_stream_t *stream, const results_entry_t *result);
+void xunit_stream_finish(output_stream_t *stream);
 void output_xunit(const results_t *, const char *, const severity_t, const severity_t);
 
 /* output_summary.c */
@@ -295,6 +318,7 @@ int unpack_archive(const char *, const char *, const bool);
 const char *mime_type(struct rpminspect *, const char *);
 const char *get_mime_type(struct rpminspect *, const rpmfile_entry_t *);
 bool is_text_file(struct rpminspect *, rpmfile_entry_t *);
+void preload_magic(void);
 
 /* checksums.c */
 char *compute_checksum(const char *, mode_t *, int);
@@ -307,6 +331,12 @@ void free_argv_table(struct rpminspect *ri, string_list_map_t *table);
 char **build_argv(const char *cmd);
 void free_argv(char **argv);
 
+/* vendorindex.c */
+vendor_index_t *new_vendor_index(const bool wildcards);
+void vendor_index_add(vendor_index_t *index, const char *key, void *data);
+void *vendor_index_find(const vendor_index_t *index, const char *s);
+void free_vendor_index(vendor_index_t *index);
+
 /* fileinfo.c */
 bool match_fileinfo_mode(struct rpminspect *, const rpmfile_entry_t *, const char *, bool *, bool *);
 bool match_fileinfo_owner(struct rpminspect *, const rpmfile_entry_t *, const char *, const char *, const char *, const char *, bool *, bool *);
@@ -340,6 +370,7 @@ const char *get_after_rel(struct rpminspect *);
 
 /* builds.c */
 int gather_builds(struct rpminspect *, bool);
+int regather_after_build(struct rpminspect *ri);
 
 /* macros.c */
 void load_macros(struct rpminspect *ri);
@@ -406,6 +437,7 @@ bool ignore_rpmfile_entry(const struct rpminspect *ri, const char *inspection, c
  * @return True if the packages are a rebase, false otherwise
  */
 bool is_rebase(struct rpminspect *ri);
+bool is_rebaseable(struct rpminspect *ri, const char *pkg);
 
 /* arches.c */
 void init_arches(struct rpminspect *ri);
@@ -431,10 +463,53 @@ string_list_t *gather_diags(struct rpminspect *ri, const char *progname, const c
 
 /* secrule.c */
 security_entry_t *get_secrule_by_path(struct rpminspect *ri, const rpmfile_entry_t *file);
+void free_secrule_pkgs(secrule_pkg_t *pkgs);
 severity_t get_secrule_result_severity(struct rpminspect *ri, const rpmfile_entry_t *file, const int type);
 secrule_type_t get_secrule_type(const char *s);
 severity_t get_secrule_severity(const char *s);
 
+/* pkgcache.c */
+void cached_get_file(struct rpminspect *ri, const char *src, const char *dst);
+void trim_package_cache(struct rpminspect *ri);
+
+/* rescache.c */
+void find_cached_results(struct rpminspect *ri);
+bool replay_cached_results(struct rpminspect *ri, const struct inspect *inspection, bool *ires);
+void save_cached_results(struct rpminspect *ri, const struct inspect *inspection, const results_entry_t *last, const bool ires);
+pid_t start_header_inspections(struct rpminspect *ri, FILE **fp);
+void finish_header_inspections(struct rpminspect *ri, const pid_t proc, FILE *fp);
+char *cached_run_cmd(const struct rpminspect *ri, int *exitcode, const char *workdir, const char *cmd, ...) __attribute__((__sentinel__));
+
+/* timings.c */
+void count_timed_file(void);
+void count_timed_command(void);
+void start_timing(const struct rpminspect *ri, const char *type, const char *name, struct timing_mark *mark);
+void stop_timing(struct rpminspect *ri, const char *type, const char *name, const struct timing_mark *mark);
+void measure_timing(const struct timing_mark *mark, timing_entry_t *used);
+void add_timing(struct rpminspect *ri, const char *type, const char *name, const timing_entry_t *used);
+void add_timings_result(struct rpminspect *ri);
+void write_timings(const struct rpminspect *ri, const char *path);
+void free_timings(timing_list_t *timings);
+
+/* events.c */
+bool is_events_fd(const char *dest);
+bool open_events(struct rpminspect *ri, const char *dest);
+void emit_timing_event(const struct rpminspect *ri, const char *type, const char *name, const timing_entry_t *used);
+void emit_result_event(const struct result_params *params);
+void emit_finish_event(const struct rpminspect *ri);
+void close_events(struct rpminspect *ri);
+
+/* snapshot.c */
+int write_snapshot(struct rpminspect *ri, const char *path, const char *profile, const char *release);
+bool is_snapshot(const char *path);
+bool read_snapshot(struct rpminspect *ri, const char *path, const char *profile, char **source);
+bool read_snapshot_section(struct rpminspect *ri, const snapshot_section_t section);
+void free_snapshot(struct snapshot *snapshot);
+
+/* serve.c */
+int serve(const char *path, int (*job)(int, char **), void (*refresh)(void));
+int serve_request(const char *path, int argc, char **argv);
+
 /* deprules.c */
 deprule_list_t *gather_deprules(Header hdr, deprule_ignore_map_t *ignores);
 void find_deprule_peers(deprule_list_t *before, deprule_list_t *after);
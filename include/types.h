@@ -15,6 +15,8 @@ extern "C"
 #include <regex.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
 #include <sys/stat.h>
 #include <rpm/rpmlib.h>
 #include <rpm/rpmfi.h>
@@ -89,7 +91,9 @@ typedef TAILQ_HEAD(regex_entry_s, _regex_entry_t) regex_list_t;
  * file.  Not every file is unpacked (e.g., block and char special
  * files are skipped).  The ownership and permissions of the unpacked
  * file may not match the intended owner and mode from the RPM
- * metadata.
+ * metadata.  Files no selected inspection wants to read are not
+ * written to disk either, but still have a fullpath, see
+ * inspection_wants_file().
  *
  * "localpath" is file path from the RPM payload, and "st" is the
  * metadata about the file, as described by the RPM payload. localpath
@@ -137,6 +141,8 @@ typedef struct _rpmfile_entry_t {
     signed char is_elf_file;
     signed char is_elf_executable;
     signed char is_elf_shared_library;
+    signed char has_secrule;                /* 0 unknown, 1 secrule set, -1 none */
+    struct _security_entry_t *secrule;      /* see get_secrule_by_path() */
     TAILQ_ENTRY(_rpmfile_entry_t) items;
 } rpmfile_entry_t;
 
@@ -253,6 +259,30 @@ typedef enum _verb_t {
     VERB_MISSING = 7    /* item sought is missing */
 } verb_t;
 
+/*
+ * Memory arena.  Allocations are carved out of large blocks and are
+ * all released at once when the arena is freed.  The memory of a block
+ * follows its arena_block_t header.  Strings added with
+ * arena_intern() are stored once no matter how many times they are
+ * added.  See arena.c.
+ */
+typedef struct _arena_block_t {
+    struct _arena_block_t *next;
+    size_t size;              /* usable bytes in data */
+    size_t used;              /* bytes handed out */
+} arena_block_t;
+
+typedef struct _arena_string_t {
+    const char *s;
+    UT_hash_handle hh;
+} arena_string_t;
+
+typedef struct _arena_t {
+    size_t blocksize;         /* size of a new block */
+    arena_block_t *blocks;    /* current block first */
+    arena_string_t *strings;  /* interned strings */
+} arena_t;
+
 /*
  * struct to make it easier to make multiple calls to add_result()
  * See the results_entry_t for details.
@@ -278,15 +308,80 @@ typedef struct _results_entry_t {
     char *details;            /* details (optional, can be NULL) */
     unsigned int remedy;      /* suggested correction for the result */
     verb_t verb;              /* verb indicating what happened */
-    char *noun;               /* noun impacted by 'verb', one line
+    const char *noun;         /* noun impacted by 'verb', one line
                                  (e.g., a file path or an RPM dependency
                                         string) */
-    char *arch;               /* architecture impacted (${ARCH}) */
-    char *file;               /* file impacted (${FILE}) */
+    const char *arch;         /* architecture impacted (${ARCH}) */
+    const char *file;         /* file impacted (${FILE}) */
     TAILQ_ENTRY(_results_entry_t) items;
 } results_entry_t;
 
-typedef TAILQ_HEAD(results_s, _results_entry_t) results_t;
+/*
+ * Totals for the results of one inspection, updated as results are
+ * added so suppression checks do not have to walk the results list.
+ */
+typedef struct _results_header_t {
+    const char *header;       /* header string for reporting */
+    unsigned long int count;  /* number of results */
+    severity_t worst;         /* worst severity of the results */
+    UT_hash_handle hh;
+} results_header_t;
+
+/*
+ * The results list.  The first two members are the same as a
+ * TAILQ_HEAD so the TAILQ macros work on it as usual.
+ */
+typedef struct results_s {
+    struct _results_entry_t *tqh_first;   /* first element */
+    struct _results_entry_t **tqh_last;   /* addr of last next element */
+    results_header_t *headers;            /* totals per header */
+    arena_t *arena;                       /* entries and their strings */
+} results_t;
+
+/*
+ * Resource usage taken at the start of a phase or inspection and the
+ * totals recorded for each one when -m is given.  See timings.c.
+ */
+struct timing_mark {
+    struct timespec wall;     /* CLOCK_MONOTONIC at the start */
+    double cpu;               /* user + system seconds, self and children */
+    long maxrss;              /* peak RSS in KiB */
+    unsigned long int files;  /* files visited so far */
+    unsigned long int commands; /* external commands run so far */
+};
+
+typedef struct _timing_entry_t {
+    const char *type;         /* "phase" or "inspection" */
+    char *name;               /* phase or inspection name */
+    char *build;              /* after build, "" before one is known */
+    double wall;              /* wall clock seconds */
+    double cpu;               /* CPU seconds */
+    long rss;                 /* growth of the peak RSS in KiB */
+    unsigned long int files;  /* files visited */
+    unsigned long int commands; /* external commands run */
+    TAILQ_ENTRY(_timing_entry_t) items;
+} timing_entry_t;
+
+typedef TAILQ_HEAD(timing_s, _timing_entry_t) timing_list_t;
+
+/*
+ * Sections of a configuration snapshot (--compile-config).  The
+ * configuration is loaded with the snapshot, the vendor data sections
+ * are loaded when the inspections ask for them.  See snapshot.c.
+ */
+typedef enum _snapshot_section_t {
+    SNAPSHOT_CONFIG = 0,
+    SNAPSHOT_FILEINFO = 1,
+    SNAPSHOT_CAPS = 2,
+    SNAPSHOT_REBASEABLE = 3,
+    SNAPSHOT_POLITICS = 4,
+    SNAPSHOT_SECURITY = 5,
+    SNAPSHOT_ICONS = 6,
+    SNAPSHOT_SECTIONS = 7      /* number of sections, keep last */
+} snapshot_section_t;
+
+/* A loaded configuration snapshot, defined in snapshot.c */
+struct snapshot;
 
 /*
  * Known types of Koji builds
@@ -310,6 +405,38 @@ typedef enum _fileinfo_field_t {
     FILENAME = 3
 } fileinfo_field_t;
 
+/*
+ * Index of a vendor data list built when it is first searched.
+ * Literal keys are found in a hash table.  Keys with fnmatch(3)
+ * wildcards are kept in file order and only tried when the part
+ * before the first wildcard matches.  The first entry in the file that
+ * matches wins, as it did when the lists were searched in order.  See
+ * vendorindex.c.
+ */
+typedef struct _vendor_key_t {
+    const char *key;
+    unsigned int pos;         /* order in the vendor data file */
+    void *data;
+    UT_hash_handle hh;
+} vendor_key_t;
+
+typedef struct _vendor_pattern_t {
+    const char *pattern;
+    size_t prefix;            /* length of pattern before the first wildcard */
+    unsigned int pos;
+    void *data;
+    TAILQ_ENTRY(_vendor_pattern_t) items;
+} vendor_pattern_t;
+
+typedef TAILQ_HEAD(vendor_pattern_s, _vendor_pattern_t) vendor_pattern_list_t;
+
+typedef struct _vendor_index_t {
+    bool wildcards;           /* false if every key is literal */
+    unsigned int count;       /* keys added */
+    vendor_key_t *keys;
+    vendor_pattern_list_t patterns;
+} vendor_index_t;
+
 typedef struct _fileinfo_entry_t {
     mode_t mode;
     char *owner;
@@ -341,6 +468,7 @@ typedef TAILQ_HEAD(caps_filelist_entry_s, _caps_filelist_entry_t) caps_filelist_
 typedef struct _caps_entry_t {
     char *pkg;
     caps_filelist_t *files;
+    vendor_index_t *index;    /* files by path, built on first lookup */
     TAILQ_ENTRY(_caps_entry_t) items;
 } caps_entry_t;
 
@@ -376,6 +504,8 @@ typedef enum _specname_primary_t {
 typedef struct _header_cache_t {
     char *pkg;
     Header hdr;
+    char *path;                  /* full path the header was read from */
+    off_t payload;               /* offset of the payload in path */
     UT_hash_handle hh;
 } header_cache_t;
 
@@ -414,6 +544,8 @@ struct command_paths {
     char *annocheck;
 #endif
     char *udevadm;
+    char *xz;
+    char *zstd;
 };
 
 /* Hash table used for key/value situations where each is a string. */
@@ -463,6 +595,17 @@ typedef struct _security_entry_t {
 
 typedef TAILQ_HEAD(security_entry_s, _security_entry_t) security_list_t;
 
+/*
+ * Security list entries that apply to one package, indexed by path.
+ * Keyed by the package name, version, and release and built the first
+ * time a file from that package is looked up.  See secrule.c.
+ */
+typedef struct _secrule_pkg_t {
+    char *nvr;
+    vendor_index_t *paths;
+    UT_hash_handle hh;
+} secrule_pkg_t;
+
 /*
  * Patches hash table used by the patches inspection
  * Maps the patch file name to the patch number in the spec file (that
@@ -508,9 +651,13 @@ struct rpminspect {
     string_list_t *cfgfiles;   /* list of full path config files read (in order) */
     char *localcfg;            /* Name of the optional local config file */
     string_list_t *locallines; /* Contents of optional local config file */
+    struct snapshot *snapshot; /* configuration snapshot in use, if any */
+    bool compile_config;       /* writing a snapshot (--compile-config)? */
     char *workdir;             /* full path to working directory */
     char *profiledir;          /* full path to profiles directory */
     char *remedyfile;          /* full path to remedy strings override file */
+    char *package_cache;       /* shared cache of downloaded packages */
+    unsigned long int package_cache_size; /* package cache limit in MiB */
     char *worksubdir;          /* within workdir, where these builds go */
 
     /* Commands */
@@ -527,13 +674,17 @@ struct rpminspect {
     /* Populated at runtime for the product release */
     char *fileinfo_filename;
     fileinfo_t *fileinfo;
+    vendor_index_t *fileinfo_index;
     caps_t *caps;
+    vendor_index_t *caps_index;
     char *caps_filename;
     string_list_t *rebaseable;
+    vendor_index_t *rebaseable_index;
     char *rebaseable_filename;
     politics_list_t *politics;
     char *politics_filename;
     security_list_t *security;
+    secrule_pkg_t *secrule_pkgs;
     char *security_filename;
     bool security_initialized;
     string_list_t *icons;
@@ -727,6 +878,7 @@ struct rpminspect {
 
     /* unicode inspection lists */
     regex_t *unicode_exclude;
+    char *unicode_exclude_pattern;
     string_list_t *unicode_excluded_mime_types;
     string_list_t *unicode_forbidden_codepoints;
 
@@ -749,6 +901,13 @@ struct rpminspect {
     bool verbose;              /* verbose inspection output? */
     bool rebase_detection;     /* Is rebase detection enabled for
                                   builds? (default true) */
+    bool pipeline;             /* extract packages as they download? */
+    unsigned int needs;        /* NEEDS_* data the selected tests read */
+    char *result_cache;        /* directory of cached results (-R) */
+    char *result_cache_key;    /* digest of the inputs to this comparison */
+    string_map_t *cached_results; /* cached results found, by inspection */
+    timing_list_t *timings;    /* per phase and inspection timings (-m) */
+    FILE *events;              /* live NDJSON event stream (-e) */
 
     /* Failure threshold and results suppression threshold */
     severity_t threshold;
@@ -811,6 +970,30 @@ struct buildtype {
     bool supported;
 };
 
+/*
+ * A results writer that writes each inspection's results as soon as
+ * the inspection finishes.  Used by the JSON and xUnit formats, see
+ * output.c.
+ */
+typedef struct _output_stream_t {
+    int format;                       /* FORMAT_JSON or FORMAT_XUNIT */
+    char *dest;                       /* output file, NULL for stdout */
+    off_t start;                      /* where the output starts in a regular file, or -1 */
+    severity_t threshold;
+    severity_t suppress;
+    FILE *fp;                         /* destination, opened on first write */
+    FILE *body;                       /* xUnit test cases until the totals are known */
+    bool failed;                      /* destination could not be opened */
+    bool rewrite;                     /* a group written earlier got more results */
+    const results_entry_t *last;      /* last result handled */
+    string_list_t *headers;           /* headers of the groups handled */
+    const char *header;               /* header of the last group written */
+    unsigned int groups;              /* groups written */
+    int count;                        /* xUnit: result number in the test case */
+    int tests;                        /* xUnit: test cases in the results */
+    int failures;                     /* xUnit: results at or above threshold */
+} output_stream_t;
+
 /*
  * Definition for an output format.
  */
@@ -831,6 +1014,13 @@ struct format {
  * driver function needs to take a struct rpminspect pointer as the only
  * argument.  The driver returns true on success and false on failure.
  */
+/*
+ * Predicate used by the inspections table to say which files an
+ * inspection reads the contents of.  Returns true if the file must
+ * be unpacked for the inspection.
+ */
+typedef bool (*want_file_func)(struct rpminspect *, const rpmfile_entry_t *);
+
 struct inspect {
     /* the inspection flag from inspect.h */
     uint64_t flag;
@@ -856,6 +1046,18 @@ struct inspect {
      */
     bool single_build;
 
+    /*
+     * What data does this inspection read?  NEEDS_* values from
+     * inspect.h ORed together.
+     */
+    unsigned int needs;
+
+    /*
+     * Which files does this inspection read the contents of?  NULL
+     * means all of them.  Only used with NEEDS_CONTENTS.
+     */
+    want_file_func wants;
+
     /* the driver function for the inspection */
     bool (*driver)(struct rpminspect *);
 };
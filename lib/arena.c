@@ -0,0 +1,178 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/**
+ * @file arena.c
+ * @brief Memory arena with string interning.
+ * @copyright LGPL-3.0-or-later
+ *
+ * Large builds can produce hundreds of thousands of inspection
+ * results, each with a handful of small strings.  An arena_t hands
+ * out memory from large blocks so each result costs no separate
+ * malloc(3) calls.  The header, noun and architecture of a result
+ * come from a small set and repeat, so arena_intern() keeps one copy
+ * of each; messages, details and file paths are copied as they are.
+ * Nothing allocated from an arena is freed on its own; free_arena()
+ * releases everything at once.
+ */
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "uthash.h"
+#include "rpminspect.h"
+
+/* alignment of every allocation */
+#define ARENA_ALIGN alignof(max_align_t)
+
+/* round n up to a multiple of ARENA_ALIGN */
+#define ARENA_ROUND(n) (((n) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+/* start of the memory in a block, just past the header */
+#define BLOCK_DATA(b) ((char *) (b) + ARENA_ROUND(sizeof(arena_block_t)))
+
+/**
+ * @brief Create an empty arena.
+ *
+ * @param blocksize Size of each block of memory the arena allocates.
+ *        Requests larger than a quarter of this get a block of their
+ *        own.
+ * @return Newly allocated arena; free with free_arena().
+ */
+arena_t *new_arena(const size_t blocksize)
+{
+    arena_t *arena = xalloc(sizeof(*arena));
+
+    assert(blocksize > 0);
+    arena->blocksize = blocksize;
+    return arena;
+}
+
+/**
+ * @brief Allocate zeroed memory from an arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param size Number of bytes needed.
+ * @return Pointer to the memory, valid until the arena is freed.
+ */
+void *arena_alloc(arena_t *arena, const size_t size)
+{
+    arena_block_t *block = NULL;
+    size_t need = ARENA_ROUND(size == 0 ? 1 : size);
+    size_t blocksize = 0;
+
+    assert(arena != NULL);
+
+    block = arena->blocks;
+
+    if (block != NULL && (block->size - block->used) >= need) {
+        block->used += need;
+        return BLOCK_DATA(block) + block->used - need;
+    }
+
+    /* big requests get their own block behind the current one */
+    if (need > arena->blocksize / 4) {
+        block = xalloc(ARENA_ROUND(sizeof(*block)) + need);
+        block->size = need;
+        block->used = need;
+
+        if (arena->blocks == NULL) {
+            arena->blocks = block;
+        } else {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        }
+
+        return BLOCK_DATA(block);
+    }
+
+    blocksize = ARENA_ROUND(arena->blocksize);
+    block = xalloc(ARENA_ROUND(sizeof(*block)) + blocksize);
+    block->size = blocksize;
+    block->used = need;
+    block->next = arena->blocks;
+    arena->blocks = block;
+    return BLOCK_DATA(block);
+}
+
+/**
+ * @brief Copy a string in to an arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param s The string to copy.
+ * @return The copy, or NULL if s is NULL.
+ */
+char *arena_strdup(arena_t *arena, const char *s)
+{
+    size_t len = 0;
+    char *r = NULL;
+
+    if (s == NULL) {
+        return NULL;
+    }
+
+    len = strlen(s) + 1;
+    r = arena_alloc(arena, len);
+    memcpy(r, s, len);
+    return r;
+}
+
+/**
+ * @brief Return the arena's copy of a string, copying it in to the
+ * arena the first time it is seen.  Interned strings must not be
+ * modified.
+ *
+ * @param arena The arena to allocate from.
+ * @param s The string to intern.
+ * @return The interned string, or NULL if s is NULL.
+ */
+const char *arena_intern(arena_t *arena, const char *s)
+{
+    arena_string_t *entry = NULL;
+
+    assert(arena != NULL);
+
+    if (s == NULL) {
+        return NULL;
+    }
+
+    HASH_FIND_STR(arena->strings, s, entry);
+
+    if (entry == NULL) {
+        entry = arena_alloc(arena, sizeof(*entry));
+        entry->s = arena_strdup(arena, s);
+        HASH_ADD_KEYPTR(hh, arena->strings, entry->s, strlen(entry->s), entry);
+    }
+
+    return entry->s;
+}
+
+/**
+ * @brief Free an arena and everything allocated from it.
+ *
+ * @param arena The arena to free.
+ */
+void free_arena(arena_t *arena)
+{
+    arena_block_t *block = NULL;
+
+    if (arena == NULL) {
+        return;
+    }
+
+    /* the entries live in the blocks, only the hash buckets are separate */
+    HASH_CLEAR(hh, arena->strings);
+
+    while (arena->blocks != NULL) {
+        block = arena->blocks;
+        arena->blocks = block->next;
+        free(block);
+    }
+
+    free(arena);
+    return;
+}
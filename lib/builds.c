@@ -22,6 +22,8 @@
 #include <dirent.h>
 #include <unistd.h>
 #include <signal.h>
+#include <sys/wait.h>
+#include <poll.h>
 #include <errno.h>
 #include <err.h>
 #include <rpm/rpmlib.h>
@@ -34,6 +36,9 @@ static int whichbuild = BEFORE_BUILD;
 static bool fetch_only = false;
 static int mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
 
+/* bytes the pipelined downloader has yet to write */
+static unsigned long int pending = 0;
+
 /* This array holds strings that map to the whichbuild index value. */
 static char *build_desc[] = { "before", "after" };
 
@@ -111,6 +116,184 @@ static void get_rpm_info(const char *pkg)
     return;
 }
 
+/*
+ * Extract one downloaded package that has not been extracted yet.
+ * The space still to be written by the downloader is kept free.
+ * Packages that do not fit are left for extract_peers(), which
+ * reports the space problem.  Returns true if a package was
+ * extracted.
+ */
+static bool extract_waiting_peer(void)
+{
+    rpmpeer_entry_t *peer = NULL;
+    unsigned long int avail = 0;
+
+    if (!(workri->needs & NEEDS_FILES)) {
+        return false;
+    }
+
+    TAILQ_FOREACH(peer, workri->peers, items) {
+        if (peer->before_hdr && peer->before_rpm && peer->before_root == NULL) {
+            avail = get_available_space(workri->workdir);
+
+            if (avail > peer->before_unpacked_size + pending) {
+                extract_peer(workri, peer, BEFORE_BUILD);
+                return true;
+            }
+        }
+
+        if (peer->after_hdr && peer->after_rpm && peer->after_root == NULL) {
+            avail = get_available_space(workri->workdir);
+
+            if (avail > peer->after_unpacked_size + pending) {
+                extract_peer(workri, peer, AFTER_BUILD);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Download a list of packages and gather the RPM header of each one.
+ * Each key in the list is the source URL and the value is the
+ * destination path.  total is the size of the whole download.
+ *
+ * In pipelined mode the downloads happen in a child process which
+ * writes one byte to a pipe as each package finishes.  This process
+ * reads the header of each package as soon as the byte arrives and
+ * extracts the packages it has while waiting for the next one, so
+ * the network and the disk are busy at the same time and every
+ * header is read as soon as the last download finishes.  Returns
+ * RI_SUCCESS, or -1 if the downloader failed.
+ */
+static int fetch_packages(struct rpminspect *ri, pair_list_t *pkgs, const unsigned long int total)
+{
+    pair_entry_t *entry = NULL;
+    pid_t proc = 0;
+    int pfd[2];
+    int status = 0;
+    int r = RI_SUCCESS;
+    char c = 0;
+    ssize_t n = 0;
+    struct pollfd pl;
+    struct stat sb;
+
+    assert(ri != NULL);
+
+    if (pkgs == NULL || TAILQ_EMPTY(pkgs)) {
+        return RI_SUCCESS;
+    }
+
+    if (ri->pipeline && !fetch_only) {
+        fflush(stdout);
+        fflush(stderr);
+
+        if (pipe(pfd) == -1) {
+            warn("*** pipe");
+        } else if ((proc = fork()) == -1) {
+            warn("*** fork");
+            close(pfd[0]);
+            close(pfd[1]);
+            proc = 0;
+        } else if (proc == 0) {
+            /* the downloader */
+            close(pfd[0]);
+
+            TAILQ_FOREACH(entry, pkgs, items) {
+                cached_get_file(ri, entry->key, entry->value);
+
+                if (write(pfd[1], "", 1) == -1) {
+                    fflush(stdout);
+                    fflush(stderr);
+                    _exit(EXIT_FAILURE);
+                }
+            }
+
+            /* _exit() does not flush the progress output */
+            close(pfd[1]);
+            fflush(stdout);
+            fflush(stderr);
+            _exit(EXIT_SUCCESS);
+        } else {
+            close(pfd[1]);
+            pending = total;
+        }
+    }
+
+    TAILQ_FOREACH(entry, pkgs, items) {
+        if (proc > 0) {
+            pl.fd = pfd[0];
+            pl.events = POLLIN;
+
+            /* unpack what has arrived until the next one is ready */
+            while (poll(&pl, 1, 0) == 0 && extract_waiting_peer()) {
+                continue;
+            }
+
+            /* wait for the downloader to finish this one */
+            while ((n = read(pfd[0], &c, 1)) == -1 && errno == EINTR) {
+                continue;
+            }
+
+            if (n != 1) {
+                /* downloader went away */
+                r = -1;
+                break;
+            }
+
+            if (stat(entry->value, &sb) == 0) {
+                pending -= ((unsigned long int) sb.st_size < pending) ? (unsigned long int) sb.st_size : pending;
+            }
+        } else {
+            cached_get_file(ri, entry->key, entry->value);
+        }
+
+        get_rpm_info(entry->value);
+    }
+
+    if (proc > 0) {
+        close(pfd[0]);
+        pending = 0;
+
+        if (waitpid(proc, &status, 0) == -1) {
+            warn("*** waitpid");
+            r = -1;
+        } else if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+            warnx(_("*** package downloader exited with status %d"), WEXITSTATUS(status));
+            r = -1;
+        } else if (WIFSIGNALED(status)) {
+            warnx(_("*** package downloader killed by signal %d"), WTERMSIG(status));
+            r = -1;
+        }
+    }
+
+    trim_package_cache(ri);
+    return r;
+}
+
+/* Add a package to download to the list for fetch_packages() */
+static pair_list_t *add_package(pair_list_t *pkgs, char *src, char *dst)
+{
+    pair_entry_t *entry = NULL;
+
+    assert(src != NULL);
+    assert(dst != NULL);
+
+    if (pkgs == NULL) {
+        pkgs = xalloc(sizeof(*pkgs));
+        TAILQ_INIT(pkgs);
+    }
+
+    entry = xalloc(sizeof(*entry));
+    entry->key = src;
+    entry->value = dst;
+    TAILQ_INSERT_TAIL(pkgs, entry, items);
+
+    return pkgs;
+}
+
 /*
  * Walk a local build tree and prune empty arch subdirectories.
  */
@@ -258,6 +441,7 @@ static void report_unknown_space(const char *workdir, const char *type)
  */
 static int download_build(struct rpminspect *ri, const struct koji_build *build)
 {
+    int r = RI_SUCCESS;
     unsigned long int avail = 0;
     size_t total_width = 0;
     koji_buildlist_entry_t *buildentry = NULL;
@@ -275,6 +459,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
     parser_plugin *p = &yaml_parser;
     parser_context *ctx = NULL;
     string_list_t *filter = NULL;
+    pair_list_t *pkgs = NULL;
 
     assert(build != NULL);
     assert(build->builds != NULL);
@@ -359,7 +544,8 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
 
             if (mkdirp(dst, mode)) {
                 free(dst);
-                return -1;
+                r = -1;
+                goto cleanup;
             }
 
             /* Get the main metadata file */
@@ -373,7 +559,8 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
                 if (p->parse_file(&ctx, dst)) {
                     warnx(_("*** ignoring malformed module metadata file: %s"), dst);
                     free(dst);
-                    return -1;
+                    r = -1;
+                    goto cleanup;
                 }
 
                 /* Initialize a string list. */
@@ -382,9 +569,10 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
 
                 if (p->strarray_foreach(ctx, "filter", "rpms", filter_cb, filter)) {
                     warnx(_("*** malformed rpm filters in file: %s"), dst);
-                    list_free(filter, free);
+                    p->fini(ctx);
                     free(dst);
-                    return -1;
+                    r = -1;
+                    goto cleanup;
                 }
 
                 p->fini(ctx);
@@ -410,7 +598,8 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
 
             if (mkdirp(dst, mode)) {
                 free(dst);
-                return -1;
+                r = -1;
+                goto cleanup;
             }
 
             free(dst);
@@ -465,15 +654,10 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
                       rpm->arch,
                       pkg);
 
-            /* download the package */
-            curl_get_file(workri->verbose, src, dst);
-
-            /* gather the RPM header */
-            get_rpm_info(dst);
+            /* queue the package for download */
+            pkgs = add_package(pkgs, src, dst);
 
             /* start over */
-            free(src);
-            free(dst);
             free(pkg);
         }
 
@@ -481,7 +665,13 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
         filter = NULL;
     }
 
-    return RI_SUCCESS;
+    /* download the packages and gather the RPM headers */
+    r = fetch_packages(ri, pkgs, build->total_size);
+
+cleanup:
+    list_free(filter, free);
+    free_pair(pkgs);
+    return r;
 }
 
 /*
@@ -490,6 +680,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
  */
 static int download_task(struct rpminspect *ri, struct koji_task *task)
 {
+    int r = RI_SUCCESS;
     unsigned long int avail = 0;
     long int sz = 0;
     size_t total_width = 0;
@@ -504,6 +695,7 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
     char *tail = NULL;
     koji_task_entry_t *descendent = NULL;
     string_entry_t *entry = NULL;
+    pair_list_t *pkgs = NULL;
 
     assert(ri != NULL);
     assert(task != NULL);
@@ -616,7 +808,8 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
 
         if (mkdirp(dst, mode)) {
             free(dst);
-            return -1;
+            r = -1;
+            goto cleanup;
         }
 
         free(dst);
@@ -634,7 +827,8 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
 
                 if (mkdirp(dst, mode)) {
                     free(dst);
-                    return -1;
+                    r = -1;
+                    goto cleanup;
                 }
 
                 len = strlen(dst);
@@ -647,17 +841,17 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
                 xasprintf(&src, "%s/work/%s", workri->kojiursine, entry->data);
 
                 /* skip if we already have this one */
-                if (access(dst, F_OK | R_OK) == 0) {
+                if (access(dst, F_OK | R_OK) == 0 || pair_contains_key(pkgs, src)) {
                     sz = curl_get_size(src);
 
                     if (sz < 0) {
                         task->total_size -= sz;
                     }
                 } else {
-                    curl_get_file(workri->verbose, src, dst);
-
-                    /* gather the RPM header */
-                    get_rpm_info(dst);
+                    /* queue the package for download */
+                    pkgs = add_package(pkgs, src, dst);
+                    src = NULL;
+                    dst = NULL;
                 }
 
                 free(dst);
@@ -680,17 +874,18 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
             }
 
             xasprintf(&src, "%s/work/%s", workri->kojiursine, entry->data);
-            curl_get_file(workri->verbose, src, dst);
-
-            /* gather the RPM header */
-            get_rpm_info(dst);
 
-            free(dst);
-            free(src);
+            /* queue the package for download */
+            pkgs = add_package(pkgs, src, dst);
         }
     }
 
-    return RI_SUCCESS;
+    /* download the packages and gather the RPM headers */
+    r = fetch_packages(ri, pkgs, task->total_size);
+
+cleanup:
+    free_pair(pkgs);
+    return r;
 }
 
 /*
@@ -897,6 +1092,7 @@ static int _gather_build_types(struct rpminspect *ri)
     struct koji_build *innerbuild = NULL;
     struct koji_task *task = NULL;
     const char *spec = NULL;
+    struct timing_mark mark;
 
     assert(ri != NULL);
 
@@ -908,7 +1104,11 @@ static int _gather_build_types(struct rpminspect *ri)
 
     /* try for a local Koji build or local RPM */
     if (!gathered && (is_local_build(ri->workdir, spec, fetch_only) || is_local_rpm(ri, spec))) {
-        if (gather_local_build(ri, spec) == -1) {
+        start_timing(ri, "phase", "download", &mark);
+        r = gather_local_build(ri, spec);
+        stop_timing(ri, "phase", "download", &mark);
+
+        if (r == -1) {
             warnx(_("*** unable to find local build: %s"), spec);
             return -1;
         } else {
@@ -918,7 +1118,9 @@ static int _gather_build_types(struct rpminspect *ri)
 
     /* try for remote RPM */
     if (!gathered && is_remote_rpm(spec)) {
+        start_timing(ri, "phase", "download", &mark);
         r = download_rpm(ri, spec);
+        stop_timing(ri, "phase", "download", &mark);
 
         if (r != RI_SUCCESS) {
             warnx(_("*** unable to download RPM: %s"), spec);
@@ -930,13 +1132,17 @@ static int _gather_build_types(struct rpminspect *ri)
 
     /* try for a Koji task identifier */
     if (!gathered && is_task_id(spec)) {
+        start_timing(ri, "phase", "koji", &mark);
         task = get_koji_task(ri, spec);
+        stop_timing(ri, "phase", "koji", &mark);
 
         if (task != NULL) {
             innerbuild = get_koji_task_as_build(task);
 
             if (innerbuild) {
+                start_timing(ri, "phase", "download", &mark);
                 r = download_build(ri, innerbuild);
+                stop_timing(ri, "phase", "download", &mark);
                 free_koji_build(innerbuild);
 
                 if (r != RI_SUCCESS) {
@@ -947,7 +1153,9 @@ static int _gather_build_types(struct rpminspect *ri)
                     gathered = true;
                 }
             } else {
+                start_timing(ri, "phase", "download", &mark);
                 r = download_task(ri, task);
+                stop_timing(ri, "phase", "download", &mark);
 
                 if (r != RI_SUCCESS) {
                     warnx(_("*** unable to find task %s in Koji hub %s"), spec, ri->kojihub);
@@ -964,10 +1172,14 @@ static int _gather_build_types(struct rpminspect *ri)
 
     /* try for a Koji build */
     if (!gathered) {
+        start_timing(ri, "phase", "koji", &mark);
         build = get_koji_build(ri, spec);
+        stop_timing(ri, "phase", "koji", &mark);
 
         if (build != NULL) {
+            start_timing(ri, "phase", "download", &mark);
             r = download_build(ri, build);
+            stop_timing(ri, "phase", "download", &mark);
             free_koji_build(build);
 
             if (r != RI_SUCCESS) {
@@ -998,6 +1210,11 @@ static int _gather_build_types(struct rpminspect *ri)
  * in the program working directory.  This function gathers both
  * before and after builds if specified at run time.
  *
+ * In pipelined mode (-P) only the packages extracted while
+ * downloading are unpacked here.  The caller runs extract_peers() for
+ * the rest once it has started the inspections that only read the
+ * headers.
+ *
  * @param ri The main program data structure; contains the before and
  *        after build specifications from the command line.
  * @param fo True if '-f' (fetch only) specified, false otherwise.
@@ -1025,7 +1242,7 @@ int gather_builds(struct rpminspect *ri, bool fo)
 
     /* did we get a before build specified? */
     if (ri->before == NULL) {
-        return extract_peers(ri, fo);
+        return (ri->pipeline && !fo) ? RI_SUCCESS : extract_peers(ri, fo);
     }
 
     whichbuild = BEFORE_BUILD;
@@ -1044,5 +1261,64 @@ int gather_builds(struct rpminspect *ri, bool fo)
     /*
      * extract the RPMs
      */
-    return extract_peers(ri, fo);
+    return (ri->pipeline && !fo) ? RI_SUCCESS : extract_peers(ri, fo);
+}
+
+/*
+ * Replace the after build with the one named in ri->after while
+ * keeping the before build gathered by an earlier gather_builds()
+ * call.  The before build is neither downloaded nor extracted again
+ * and its headers and file lists stay in memory.  Used by batch mode.
+ * In pipelined mode the caller finishes extraction, see
+ * gather_builds().
+ */
+int regather_after_build(struct rpminspect *ri)
+{
+    int r = 0;
+    char *path = NULL;
+    rpmpeer_entry_t *peer = NULL;
+
+    assert(ri != NULL);
+    assert(ri->after != NULL);
+    assert(ri->worksubdir != NULL);
+
+    workri = ri;
+    fetch_only = false;
+
+    /* forget everything about the previous after build */
+    if (ri->peers != NULL) {
+        TAILQ_FOREACH(peer, ri->peers, items) {
+            if (peer->after_rpm != NULL) {
+                uncache_rpm_header(ri, peer->after_rpm);
+            }
+        }
+    }
+
+    release_after_peers(ri->peers);
+
+    xasprintf(&path, "%s/%s/", ri->worksubdir, build_desc[AFTER_BUILD]);
+    assert(path != NULL);
+    (void) rmtree(path, true, false);
+    free(path);
+
+    xasprintf(&path, "%s/%s/%s", ri->worksubdir, ROOT_SUBDIR, AFTER_SUBDIR);
+    assert(path != NULL);
+    (void) rmtree(path, true, false);
+    free(path);
+
+    free(ri->after_rel);
+    ri->after_rel = NULL;
+    ri->rebase_build = 0;
+    ri->download_size = 0;
+    ri->unpacked_size = 0;
+
+    /* gather and extract the new after build */
+    whichbuild = AFTER_BUILD;
+    r = _gather_build_types(ri);
+
+    if (r) {
+        return r;
+    }
+
+    return ri->pipeline ? RI_SUCCESS : extract_peers(ri, false);
 }
@@ -47,22 +47,10 @@
 #include <openssl/sha.h>
 
 #include "rpminspect.h"
+#include "internal/probes.h"
 
-/**
- * @brief Take in a file, return a checksum.
- *
- * Given a file, its **mode_t**, and a valid checksum type, compute
- * the checksum and return the human-readable digest string for that
- * checksum.  This function allocates memory for the string and the
- * caller must free it when done.
- *
- * @param filename Filename the function should use.
- * @param st_mode The **mode_t** for the specified file, gathered from **stat(2)**.
- * @param type Which checksum type to calculate.
- * @note Caller must free returned string when done.
- * @return String containing the human-readable checksum digest, or NULL on failure.
- */
-char *compute_checksum(const char *filename, mode_t *st_mode, int type)
+/* Does the work for compute_checksum() */
+static char *digest_file(const char *filename, mode_t *st_mode, int type)
 {
     struct stat sb;
     mode_t *mode = NULL;
@@ -195,6 +183,31 @@ char *compute_checksum(const char *filename, mode_t *st_mode, int type)
     return ret;
 }
 
+/**
+ * @brief Take in a file, return a checksum.
+ *
+ * Given a file, its **mode_t**, and a valid checksum type, compute
+ * the checksum and return the human-readable digest string for that
+ * checksum.  This function allocates memory for the string and the
+ * caller must free it when done.
+ *
+ * @param filename Filename the function should use.
+ * @param st_mode The **mode_t** for the specified file, gathered from **stat(2)**.
+ * @param type Which checksum type to calculate.
+ * @note Caller must free returned string when done.
+ * @return String containing the human-readable checksum digest, or NULL on failure.
+ */
+char *compute_checksum(const char *filename, mode_t *st_mode, int type)
+{
+    char *ret = NULL;
+
+    RI_PROBE2(checksum__start, filename, type);
+    ret = digest_file(filename, st_mode, type);
+    RI_PROBE3(checksum__done, filename, type, ret);
+
+    return ret;
+}
+
 /**
  * @brief Return checksum string of the given **rpmfile_entry_t**.
  *
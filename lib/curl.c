@@ -14,6 +14,7 @@
 #include <err.h>
 #include <curl/curl.h>
 #include "rpminspect.h"
+#include "internal/probes.h"
 
 /* Globals used by programs linking with the library */
 volatile sig_atomic_t terminal_resized = 0;
@@ -211,7 +212,9 @@ void curl_get_file(const bool verbose, const char *src, const char *dst)
 #ifdef CURLOPT_TCP_FASTOPEN /* not available on all versions of libcurl (e.g., <= 7.29) */
     curl_easy_setopt(c, CURLOPT_TCP_FASTOPEN, 1L);
 #endif
+    RI_PROBE2(download__start, src, dst);
     cc = curl_easy_perform(c);
+    RI_PROBE3(download__done, src, dst, (int) cc);
 
     if (verbose) {
         printf("\n");
@@ -15,6 +15,7 @@
 #include <assert.h>
 #include "rpminspect.h"
 #include "uthash.h"
+#include "parallel.h"
 
 /*
  * Given an inspection, print any per-inspection ignores.
@@ -98,6 +99,15 @@ void dump_cfg(const struct rpminspect *ri)
         if (ri->remedyfile) {
             printf("    remedyfile: %s\n", ri->remedyfile);
         }
+
+        if (ri->package_cache) {
+            printf("    package_cache: %s\n", ri->package_cache);
+            printf("    package_cache_size: %lu\n", ri->package_cache_size);
+        }
+
+        if (default_parallel_processes > 0) {
+            printf("    workers: %u\n", default_parallel_processes);
+        }
     }
 
     /* environment */
@@ -154,6 +164,14 @@ void dump_cfg(const struct rpminspect *ri)
         printf("    udevadm: %s\n", ri->commands.udevadm);
     }
 
+    if (ri->commands.xz) {
+        printf("    xz: %s\n", ri->commands.xz);
+    }
+
+    if (ri->commands.zstd) {
+        printf("    zstd: %s\n", ri->commands.zstd);
+    }
+
     /* vendor */
 
     printf("vendor:\n");
@@ -0,0 +1,249 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/**
+ * @file events.c
+ * @brief Live event stream of a run (-e).
+ * @copyright LGPL-3.0-or-later
+ *
+ * A long run, such as inspecting a kernel build, can take hours before
+ * any results are written.  With -e every phase and inspection start
+ * and end and every result added to the run is written to the events
+ * file as it happens, one JSON object per line (NDJSON), so the run
+ * can be watched and a failure acted on before the run ends.  Each
+ * line is flushed when it is written.  Nothing is written unless
+ * ri->events was opened, and the only cost then is the check for it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <err.h>
+#include <json.h>
+
+#include "rpminspect.h"
+
+/*
+ * The run that opened the events destination.  Results are added with
+ * add_result_entry(), which only has the results list, so result
+ * events are written for this run.
+ */
+static const struct rpminspect *emitter = NULL;
+
+/*
+ * Start an event object of the given kind with the time and the build
+ * it belongs to.
+ */
+static struct json_object *new_event(const struct rpminspect *ri, const char *kind)
+{
+    struct timespec now;
+    struct json_object *event = NULL;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    event = json_object_new_object();
+    json_object_object_add(event, "event", json_object_new_string(kind));
+    json_object_object_add(event, "time", json_object_new_double(now.tv_sec + (now.tv_nsec / 1000000000.0)));
+    json_object_object_add(event, "build", json_object_new_string(ri->after ? ri->after : ""));
+    return event;
+}
+
+/* Write the event as one line and free it */
+static void write_event(const struct rpminspect *ri, struct json_object *event)
+{
+    const char *s = NULL;
+
+    s = json_object_to_json_string_ext(event, JSON_C_TO_STRING_PLAIN);
+
+    if (s == NULL) {
+        errx(RI_PROGRAM_ERROR, "*** failed to stringify object to json format");
+    }
+
+    if (fprintf(ri->events, "%s\n", s) < 0 || fflush(ri->events) != 0) {
+        warn("*** writing event");
+    }
+
+    json_object_put(event);
+    return;
+}
+
+/*
+ * True if the events destination is a file descriptor number rather
+ * than a file name.
+ */
+bool is_events_fd(const char *dest)
+{
+    assert(dest != NULL);
+    return (*dest != '\0' && strspn(dest, "0123456789") == strlen(dest));
+}
+
+/*
+ * Open the events destination.  A string of digits is a file
+ * descriptor already open for writing, anything else is a file to
+ * create.  Returns false with errno set if it cannot be opened.
+ */
+bool open_events(struct rpminspect *ri, const char *dest)
+{
+    int fd = -1;
+
+    assert(ri != NULL);
+    assert(dest != NULL);
+
+    if (is_events_fd(dest)) {
+        fd = (int) strtol(dest, NULL, 10);
+        ri->events = fdopen(fd, "w");
+
+        /* the commands rpminspect runs do not get it */
+        if (ri->events != NULL && fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+            warn("*** fcntl");
+        }
+    } else {
+        ri->events = fopen(dest, "we");
+    }
+
+    if (ri->events != NULL) {
+        emitter = ri;
+    }
+
+    return (ri->events != NULL);
+}
+
+/*
+ * Write the start of a phase or inspection, or its end when used holds
+ * what it used.  The end of an inspection also carries the worst
+ * result it has added so far.
+ */
+void emit_timing_event(const struct rpminspect *ri, const char *type, const char *name, const timing_entry_t *used)
+{
+    struct json_object *event = NULL;
+    const results_header_t *hentry = NULL;
+
+    assert(ri != NULL);
+    assert(type != NULL);
+    assert(name != NULL);
+
+    if (ri->events == NULL) {
+        return;
+    }
+
+    event = new_event(ri, (used == NULL) ? "start" : "end");
+    json_object_object_add(event, "type", json_object_new_string(type));
+    json_object_object_add(event, "name", json_object_new_string(name));
+
+    if (used != NULL) {
+        json_object_object_add(event, "wall", json_object_new_double(used->wall));
+        json_object_object_add(event, "cpu", json_object_new_double(used->cpu));
+        json_object_object_add(event, "rss delta", json_object_new_int64(used->rss));
+        json_object_object_add(event, "files", json_object_new_int64(used->files));
+        json_object_object_add(event, "commands", json_object_new_int64(used->commands));
+
+        if (!strcmp(type, "inspection")) {
+            hentry = get_results_header(ri->results, name);
+            json_object_object_add(event, "result", json_object_new_string(strseverity(hentry ? hentry->worst : RESULT_OK)));
+        }
+    }
+
+    write_event(ri, event);
+    return;
+}
+
+/*
+ * Write a result as it is added.  Called by add_result_entry() for
+ * every result of the run that opened the events destination.  The
+ * members are named the same as in the JSON output format.
+ */
+void emit_result_event(const struct result_params *params)
+{
+    struct json_object *event = NULL;
+
+    assert(params != NULL);
+
+    if (emitter == NULL || emitter->events == NULL) {
+        return;
+    }
+
+    event = new_event(emitter, "result");
+    json_object_object_add(event, "inspection", json_object_new_string(params->header ? params->header : ""));
+    json_object_object_add(event, "result", json_object_new_string(strseverity(params->severity)));
+
+    if (params->waiverauth > NULL_WAIVERAUTH) {
+        json_object_object_add(event, "waiver authorization", json_object_new_string(strwaiverauth(params->waiverauth)));
+    }
+
+    if (params->msg != NULL) {
+        json_object_object_add(event, "message", json_object_new_string(params->msg));
+    }
+
+    if (params->details != NULL) {
+        json_object_object_add(event, "details", json_object_new_string(params->details));
+    }
+
+    if (params->remedy != REMEDY_NULL) {
+        json_object_object_add(event, "remedy", json_object_new_string(get_remedy(params->remedy)));
+    }
+
+    if (params->noun != NULL) {
+        json_object_object_add(event, "noun", json_object_new_string(params->noun));
+    }
+
+    if (params->arch != NULL) {
+        json_object_object_add(event, "arch", json_object_new_string(params->arch));
+    }
+
+    if (params->file != NULL) {
+        json_object_object_add(event, "file", json_object_new_string(params->file));
+    }
+
+    write_event(emitter, event);
+    return;
+}
+
+/*
+ * Write the end of a comparison with its worst result and whether that
+ * meets the failure threshold.
+ */
+void emit_finish_event(const struct rpminspect *ri)
+{
+    struct json_object *event = NULL;
+
+    assert(ri != NULL);
+
+    if (ri->events == NULL) {
+        return;
+    }
+
+    event = new_event(ri, "finish");
+    json_object_object_add(event, "result", json_object_new_string(strseverity(ri->worst_result)));
+    json_object_object_add(event, "failed", json_object_new_boolean(ri->worst_result >= ri->threshold));
+    write_event(ri, event);
+    return;
+}
+
+/*
+ * Close the events destination.
+ */
+void close_events(struct rpminspect *ri)
+{
+    assert(ri != NULL);
+
+    if (ri->events == NULL) {
+        return;
+    }
+
+    if (fclose(ri->events) != 0) {
+        warn("*** fclose");
+    }
+
+    ri->events = NULL;
+
+    if (emitter == ri) {
+        emitter = NULL;
+    }
+
+    return;
+}
@@ -9,7 +9,6 @@
 #include <assert.h>
 #include <err.h>
 #include <errno.h>
-#include <fnmatch.h>
 #include <rpm/header.h>
 #include "rpminspect.h"
 
@@ -20,6 +19,29 @@ static mode_t get_interesting_perms(const mode_t mode)
     return mode & interesting;
 }
 
+/*
+ * Return the fileinfo list entry for the given path or NULL if there
+ * is none.  Loads the fileinfo list and indexes it the first time.
+ */
+static fileinfo_entry_t *find_fileinfo(struct rpminspect *ri, const char *path)
+{
+    fileinfo_entry_t *fientry = NULL;
+
+    if (!init_fileinfo(ri)) {
+        return NULL;
+    }
+
+    if (ri->fileinfo_index == NULL) {
+        ri->fileinfo_index = new_vendor_index(false);
+
+        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
+            vendor_index_add(ri->fileinfo_index, fientry->filename, fientry);
+        }
+    }
+
+    return vendor_index_find(ri->fileinfo_index, path);
+}
+
 /**
  * @brief Check for the given path on the fileinfo list.  If found,
  * check the st_mode value and report accordingly.
@@ -50,32 +72,28 @@ bool match_fileinfo_mode(struct rpminspect *ri, const rpmfile_entry_t *file, con
     params.arch = get_rpm_header_arch(file->rpm_header);
     params.file = file->localpath;
 
-    if (init_fileinfo(ri)) {
-        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
-            if (!strcmp(file->localpath, fientry->filename)) {
-                if (file->st_mode == fientry->mode) {
-                    xasprintf(&params.msg, _("%s in %s on %s carries expected mode %04o"), file->localpath, pkg, params.arch, perms);
-                    params.severity = RESULT_INFO;
-                    params.waiverauth = NOT_WAIVABLE;
-                    add_result(ri, &params);
-                    free(params.msg);
-                    *reported = true;
-                    return true;
-                } else {
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        xasprintf(&params.msg, _("%s in %s on %s carries unexpected mode %04o; expected mode %04o; requires inspection by the Security Team"), file->localpath, pkg, params.arch, perms, fientry->mode);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        *result = false;
-                        *reported = true;
-                        return true;
-                    }
-                }
-
-                break;
+    fientry = find_fileinfo(ri, file->localpath);
+
+    if (fientry != NULL) {
+        if (file->st_mode == fientry->mode) {
+            xasprintf(&params.msg, _("%s in %s on %s carries expected mode %04o"), file->localpath, pkg, params.arch, perms);
+            params.severity = RESULT_INFO;
+            params.waiverauth = NOT_WAIVABLE;
+            add_result(ri, &params);
+            free(params.msg);
+            *reported = true;
+            return true;
+        } else {
+            params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
+
+            if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                params.waiverauth = WAIVABLE_BY_SECURITY;
+                xasprintf(&params.msg, _("%s in %s on %s carries unexpected mode %04o; expected mode %04o; requires inspection by the Security Team"), file->localpath, pkg, params.arch, perms, fientry->mode);
+                add_result(ri, &params);
+                free(params.msg);
+                *result = false;
+                *reported = true;
+                return true;
             }
         }
     }
@@ -136,32 +154,28 @@ bool match_fileinfo_owner(struct rpminspect *ri, const rpmfile_entry_t *file, co
     params.arch = get_rpm_header_arch(file->rpm_header);
     params.file = file->localpath;
 
-    if (init_fileinfo(ri)) {
-        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
-            if (!strcmp(file->localpath, fientry->filename)) {
-                if (!strcmp(owner, fientry->owner)) {
-                    xasprintf(&params.msg, _("%s in %s on %s carries expected owner '%s'"), file->localpath, pkg, params.arch, fientry->owner);
-                    params.severity = RESULT_INFO;
-                    params.waiverauth = NOT_WAIVABLE;
-                    add_result(ri, &params);
-                    free(params.msg);
-                    *reported = true;
-                    return true;
-                } else {
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        xasprintf(&params.msg, _("%s in %s on %s carries unexpected owner '%s'; expected owner '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, owner, fientry->owner);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        *result = false;
-                        *reported = true;
-                        return true;
-                    }
-                }
-
-                break;
+    fientry = find_fileinfo(ri, file->localpath);
+
+    if (fientry != NULL) {
+        if (!strcmp(owner, fientry->owner)) {
+            xasprintf(&params.msg, _("%s in %s on %s carries expected owner '%s'"), file->localpath, pkg, params.arch, fientry->owner);
+            params.severity = RESULT_INFO;
+            params.waiverauth = NOT_WAIVABLE;
+            add_result(ri, &params);
+            free(params.msg);
+            *reported = true;
+            return true;
+        } else {
+            params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
+
+            if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                params.waiverauth = WAIVABLE_BY_SECURITY;
+                xasprintf(&params.msg, _("%s in %s on %s carries unexpected owner '%s'; expected owner '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, owner, fientry->owner);
+                add_result(ri, &params);
+                free(params.msg);
+                *result = false;
+                *reported = true;
+                return true;
             }
         }
     }
@@ -222,32 +236,28 @@ bool match_fileinfo_group(struct rpminspect *ri, const rpmfile_entry_t *file, co
     params.arch = get_rpm_header_arch(file->rpm_header);
     params.file = file->localpath;
 
-    if (init_fileinfo(ri)) {
-        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
-            if (!strcmp(file->localpath, fientry->filename)) {
-                if (!strcmp(group, fientry->group)) {
-                    xasprintf(&params.msg, _("%s in %s on %s carries expected group '%s'"), file->localpath, pkg, params.arch, fientry->group);
-                    params.severity = RESULT_INFO;
-                    params.waiverauth = NOT_WAIVABLE;
-                    add_result(ri, &params);
-                    free(params.msg);
-                    *reported = true;
-                    return true;
-                } else {
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        xasprintf(&params.msg, _("%s in %s on %s carries group unexpected '%s'; expected group '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, group, fientry->group);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        *result = false;
-                        *reported = true;
-                        return true;
-                    }
-                }
-
-                break;
+    fientry = find_fileinfo(ri, file->localpath);
+
+    if (fientry != NULL) {
+        if (!strcmp(group, fientry->group)) {
+            xasprintf(&params.msg, _("%s in %s on %s carries expected group '%s'"), file->localpath, pkg, params.arch, fientry->group);
+            params.severity = RESULT_INFO;
+            params.waiverauth = NOT_WAIVABLE;
+            add_result(ri, &params);
+            free(params.msg);
+            *reported = true;
+            return true;
+        } else {
+            params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
+
+            if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                params.waiverauth = WAIVABLE_BY_SECURITY;
+                xasprintf(&params.msg, _("%s in %s on %s carries group unexpected '%s'; expected group '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, group, fientry->group);
+                add_result(ri, &params);
+                free(params.msg);
+                *result = false;
+                *reported = true;
+                return true;
             }
         }
     }
@@ -278,8 +288,6 @@ bool match_fileinfo_group(struct rpminspect *ri, const rpmfile_entry_t *file, co
 #ifdef _WITH_LIBCAP
 caps_filelist_entry_t *get_caps_entry(struct rpminspect *ri, const char *pkg, const char *filepath)
 {
-    bool found = false;
-    int flags = FNM_NOESCAPE;
     caps_entry_t *entry = NULL;
     caps_filelist_entry_t *flentry = NULL;
 
@@ -287,35 +295,32 @@ caps_filelist_entry_t *get_caps_entry(struct rpminspect *ri, const char *pkg, co
     assert(pkg != NULL);
     assert(filepath != NULL);
 
-    if (init_caps(ri)) {
-        /* Look for the package in the caps list */
-        TAILQ_FOREACH(entry, ri->caps, items) {
-            if (!strcmp(entry->pkg, pkg) || !fnmatch(entry->pkg, pkg, flags)) {
-                found = true;
-                break;
-            }
-        }
+    if (!init_caps(ri)) {
+        return NULL;
+    }
 
-        if (!found) {
-            return NULL;
-        }
+    /* index the packages and each package's files the first time */
+    if (ri->caps_index == NULL) {
+        ri->caps_index = new_vendor_index(true);
 
-        found = false;
+        TAILQ_FOREACH(entry, ri->caps, items) {
+            vendor_index_add(ri->caps_index, entry->pkg, entry);
+            entry->index = new_vendor_index(true);
 
-        /* Look for this file's entry for that package */
-        TAILQ_FOREACH(flentry, entry->files, items) {
-            if (!strcmp(flentry->path, filepath) || !fnmatch(flentry->path, filepath, flags)) {
-                found = true;
-                break;
+            TAILQ_FOREACH(flentry, entry->files, items) {
+                vendor_index_add(entry->index, flentry->path, flentry);
             }
         }
+    }
 
-        /* No entry, make sure to return NULL */
-        if (!found) {
-            return NULL;
-        }
+    /* Look for the package in the caps list */
+    entry = vendor_index_find(ri->caps_index, pkg);
+
+    if (entry == NULL) {
+        return NULL;
     }
 
-    return flentry;
+    /* Look for this file's entry for that package */
+    return vendor_index_find(entry->index, filepath);
 }
 #endif
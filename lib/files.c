@@ -17,12 +17,14 @@
 #include <err.h>
 #include <regex.h>
 #include <ctype.h>
+#include <signal.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <sys/wait.h>
 
 #ifdef _WITH_LIBCAP
 #include <sys/capability.h>
@@ -37,6 +39,8 @@
 
 #include "rpminspect.h"
 #include "uthash.h"
+#include "parallel.h"
+#include "internal/probes.h"
 
 /*
  * hash table used for file entries
@@ -142,6 +146,163 @@ static struct archive *new_archive_reader(void)
     return a;
 }
 
+/**
+ * @brief Decompress a large xz or zstd payload in a helper process.
+ *
+ * libarchive decompresses on the same thread that parses the cpio
+ * stream and writes files to disk, so the largest packages are
+ * extracted on a single CPU.  For packages at least
+ * PAYLOAD_HELPER_THRESHOLD bytes in size with an xz or zstd payload,
+ * start xz(1) or zstd(1) reading from the payload descriptor and
+ * writing the uncompressed cpio stream to a pipe.  xz decompresses
+ * with one thread per CPU and both tools run concurrently with
+ * libarchive writing the files out.
+ *
+ * On success the payload descriptor is closed and replaced with the
+ * read end of the pipe.  If the payload does not qualify or the
+ * helper cannot be started, the descriptor is left untouched.
+ *
+ * @param ri The main program data structure.
+ * @param hdr RPM Header for the package.
+ * @param payload_fd Pointer to the descriptor positioned at the
+ *                   payload.
+ * @return The helper process ID, or 0 if no helper was started.
+ */
+static pid_t start_payload_helper(struct rpminspect *ri, Header hdr, int *payload_fd)
+{
+    pid_t proc = 0;
+    int pfd[2];
+    struct stat sb;
+    const char *compr = NULL;
+    char *cmd = NULL;
+    char *argv[6];
+    char threads[16];
+
+    assert(ri != NULL);
+    assert(hdr != NULL);
+    assert(payload_fd != NULL);
+
+    if (*payload_fd == -1) {
+        return 0;
+    }
+
+    /* only large packages benefit */
+    if (fstat(*payload_fd, &sb) == -1 || sb.st_size < PAYLOAD_HELPER_THRESHOLD) {
+        return 0;
+    }
+
+    compr = headerGetString(hdr, RPMTAG_PAYLOADCOMPRESSOR);
+
+    if (compr == NULL) {
+        return 0;
+    } else if (!strcmp(compr, "xz")) {
+        cmd = find_cmd(ri->commands.xz);
+        argv[0] = ri->commands.xz;
+        argv[1] = "-d";
+        argv[2] = "-c";
+        argv[3] = "-q";
+        /* -T0 would count every CPU on the host, not our cgroup quota */
+        snprintf(threads, sizeof(threads), "-T%u", parallel_workers(PARALLEL_WORKER_FOOTPRINT));
+        argv[4] = threads;
+        argv[5] = NULL;
+    } else if (!strcmp(compr, "zstd")) {
+        cmd = find_cmd(ri->commands.zstd);
+        argv[0] = ri->commands.zstd;
+        argv[1] = "-d";
+        argv[2] = "-c";
+        argv[3] = "-q";
+        argv[4] = NULL;
+    } else {
+        return 0;
+    }
+
+    if (cmd == NULL || access(cmd, X_OK) == -1) {
+        DEBUG_PRINT("no %s payload helper found, using libarchive\n", compr);
+        free(cmd);
+        return 0;
+    }
+
+    if (pipe(pfd) == -1) {
+        warn("*** pipe");
+        free(cmd);
+        return 0;
+    }
+
+    proc = fork();
+
+    if (proc == 0) {
+        /* closing the pipe early must stop the helper, see below */
+        signal(SIGPIPE, SIG_DFL);
+
+        /* the payload descriptor becomes stdin, the pipe stdout */
+        if (dup2(*payload_fd, STDIN_FILENO) == -1 || dup2(pfd[1], STDOUT_FILENO) == -1) {
+            _exit(EXIT_FAILURE);
+        }
+
+        close(*payload_fd);
+        close(pfd[0]);
+        close(pfd[1]);
+
+        execv(cmd, argv);
+        _exit(EXIT_FAILURE);
+    } else if (proc == -1) {
+        warn("*** fork");
+        close(pfd[0]);
+        close(pfd[1]);
+        free(cmd);
+        return 0;
+    }
+
+    DEBUG_PRINT("decompressing %s payload with %s (pid %d)\n", compr, cmd, proc);
+    free(cmd);
+
+    /* the helper owns the payload now */
+    if (close(pfd[1]) == -1 || close(*payload_fd) == -1) {
+        warn("*** close");
+    }
+
+    *payload_fd = pfd[0];
+    return proc;
+}
+
+/**
+ * @brief Reap a payload helper started by start_payload_helper().
+ *
+ * The caller must close the read end of the pipe first so a helper
+ * that is still writing gets SIGPIPE rather than blocking forever.
+ * That only happens when extraction stopped early, because a
+ * successful extraction reads the pipe to the end first, so SIGPIPE
+ * is not a helper failure.  Any other signal or a nonzero exit
+ * status means the payload was not decompressed correctly.
+ *
+ * @param proc The helper process ID.  Passing 0 is a no-op.
+ * @return True if the helper succeeded or there was none, false
+ *         otherwise.
+ */
+static bool finish_payload_helper(pid_t proc)
+{
+    int status = 0;
+
+    if (proc <= 0) {
+        return true;
+    }
+
+    if (waitpid(proc, &status, 0) == -1) {
+        warn("*** waitpid");
+        return false;
+    }
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+        warnx(_("*** payload helper exited with status %d"), WEXITSTATUS(status));
+        return false;
+    } else if (WIFSIGNALED(status) && WTERMSIG(status) != SIGPIPE) {
+        warnx(_("*** payload helper killed by signal %d"), WTERMSIG(status));
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * @brief Extract the RPM package specified to a working directory.
  *
@@ -149,8 +310,10 @@ static struct archive *new_archive_reader(void)
  * extraction path and extract all of the payload members to that
  * directory.  The function reads the payload member information from
  * the Header and uses libarchive to perform the actual payload
- * extraction.  Returns an rpmfile_t list of all the payload members.
- * The caller is responsible for freeing this returned list.
+ * extraction.  The payload is streamed from the descriptor returned
+ * by open_rpm_payload() so the package is only read once.  Returns an
+ * rpmfile_t list of all the payload members.  The caller is
+ * responsible for freeing this returned list.
  *
  * @param ri The main program data structure.
  * @param pkg Path to the RPM package to extract.
@@ -175,6 +338,10 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
     struct archive *archive = NULL;
     struct archive_entry *entry = NULL;
     const char *archive_path = NULL;
+    int payload_fd = -1;
+    pid_t helper = 0;
+    ssize_t nread = 0;
+    char drain[BUFSIZ];
     mode_t archive_perm = 0;
     int archive_result = 0;
 
@@ -194,6 +361,8 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
     assert(hdr != NULL);
     assert(subdir != NULL);
 
+    RI_PROBE2(extract__start, pkg, subdir);
+
     /* Capture the RPM header type for use later when creating the tar file */
     src = headerIsSource(hdr);
 
@@ -203,6 +372,7 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
 
     if (mkdirp(*output_dir, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == -1) {
         free(*output_dir);
+        RI_PROBE2(extract__done, pkg, subdir);
         return NULL;
     }
 
@@ -241,10 +411,34 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
         HASH_ADD_KEYPTR(hh, path_table, path_entry->path, strlen(path_entry->path), path_entry);
     }
 
-    /* Open the file with libarchive */
+    /*
+     * Open the payload with libarchive.  The descriptor is already
+     * positioned past the RPM header so libarchive only has to
+     * detect the payload compression and cpio format.
+     */
     archive = new_archive_reader();
+    payload_fd = open_rpm_payload(ri, pkg);
+    helper = start_payload_helper(ri, hdr, &payload_fd);
+
+    if (payload_fd == -1) {
+        /* no usable payload offset, let libarchive find the payload */
+        archive_result = archive_read_open_filename(archive, pkg, BUFSIZ);
+    } else {
+        archive_result = archive_read_open_fd(archive, payload_fd, BUFSIZ);
+    }
+
+    if (archive_result != ARCHIVE_OK) {
+        /* the helper's output is not used, whatever became of it */
+        if (helper > 0) {
+            if (close(payload_fd) == -1) {
+                warn("*** close");
+            }
+
+            payload_fd = -1;
+            finish_payload_helper(helper);
+            helper = 0;
+        }
 
-    if (archive_read_open_filename(archive, pkg, BUFSIZ) != ARCHIVE_OK) {
         /* maybe the payload has large files, so try to convert */
         payload = extract_rpm_payload(pkg);
 
@@ -309,6 +503,7 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
 
         /* Create a new rpmfile_entry_t for this file */
         file_entry = xalloc(sizeof(rpmfile_entry_t));
+        count_timed_file();
 
         file_entry->rpm_header = hdr;
         file_entry->idx = path_entry->index;
@@ -380,6 +575,22 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
         }
 
         xasprintf(&file_entry->fullpath, "%s%s%s", *output_dir, div, tmp);
+
+        /*
+         * Only write out the files the selected inspections read.
+         * The fullpath is kept either way because path checks such as
+         * ignore_rpmfile_entry() use it.  Hard links are written
+         * whenever file contents are needed because the link target
+         * may be a file that is wanted.
+         */
+        if ((file_entry->st_nlink < 2 || !(ri->needs & NEEDS_CONTENTS)) && !inspection_wants_file(ri, file_entry)) {
+            if (archive_read_data_skip(archive) != ARCHIVE_OK) {
+                err(EIO, "*** archive_read_data_skip: %s", archive_error_string(archive));
+            }
+
+            continue;
+        }
+
         archive_entry_set_pathname(entry, file_entry->fullpath);
 
         /* Ensure the resulting file is user-rw and global-unwritable */
@@ -420,6 +631,28 @@ cleanup:
         archive_read_free(archive);
     }
 
+    /*
+     * libarchive stops at the cpio trailer, so read what the helper
+     * has left and let it check the end of the compressed stream
+     */
+    if (helper > 0 && file_list != NULL) {
+        do {
+            nread = read(payload_fd, drain, sizeof(drain));
+        } while (nread > 0 || (nread == -1 && errno == EINTR));
+    }
+
+    /* libarchive does not close descriptors it did not open */
+    if (payload_fd != -1 && close(payload_fd) == -1) {
+        warn("*** close");
+    }
+
+    /* a failed helper may have cut the payload short */
+    if (!finish_payload_helper(helper) && file_list != NULL) {
+        warnx(_("*** unable to extract %s"), pkg);
+        free_files(file_list);
+        file_list = NULL;
+    }
+
     if (payload) {
         if (unlink(payload) == -1) {
             warn("*** unlink");
@@ -428,6 +661,7 @@ cleanup:
         free(payload);
     }
 
+    RI_PROBE2(extract__done, pkg, subdir);
     return file_list;
 }
 
@@ -895,7 +1129,7 @@ static void find_one_peer(struct rpminspect *ri, rpmfile_entry_t *file, rpmfile_
                  * Also try to match kernel modules between builds.
                  */
                 if (!(strstr(file->localpath, ELF_LIB_EXTENSION) && strstr(after_file->localpath, ELF_LIB_EXTENSION))
-                    && !(strstr(file->fullpath, KERNEL_MODULES_DIR) && strstr(after_file->fullpath, KERNEL_MODULES_DIR))) {
+                    && !(strstr(file->localpath, KERNEL_MODULES_DIR) && strstr(after_file->localpath, KERNEL_MODULES_DIR))) {
                     continue;
                 }
 
@@ -993,3 +1227,21 @@ bool is_debug_or_build_path(const char *path)
 
     return false;
 }
+
+/**
+ * @brief Return true if the file is the spec file in a source RPM.
+ *
+ * Used by inspections that only read the spec file to limit which
+ * files are unpacked from the SRPM.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param file The file to check.
+ * @return True if the file is the spec file of a source package.
+ */
+bool is_srpm_spec_file(struct rpminspect *ri, const rpmfile_entry_t *file)
+{
+    assert(ri != NULL);
+    assert(file != NULL);
+
+    return headerIsSource(file->rpm_header) && strsuffix(file->localpath, SPEC_FILENAME_EXTENSION);
+}
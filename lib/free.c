@@ -9,7 +9,7 @@
 #include "queue.h"
 #include "rpminspect.h"
 
-static void free_string_list_map(string_list_map_t *table)
+void free_string_list_map(string_list_map_t *table)
 {
     string_list_map_t *entry = NULL;
     string_list_map_t *tmp_entry = NULL;
@@ -120,9 +120,11 @@ void free_rpminspect(struct rpminspect *ri)
     list_free(ri->cfgfiles, free);
     free(ri->localcfg);
     list_free(ri->locallines, free);
+    free_snapshot(ri->snapshot);
     free(ri->workdir);
     free(ri->profiledir);
     free(ri->remedyfile);
+    free(ri->package_cache);
     free(ri->kojihub);
     free(ri->kojiursine);
     free(ri->kojimbs);
@@ -130,6 +132,7 @@ void free_rpminspect(struct rpminspect *ri)
 
     free(ri->vendor_data_dir);
     list_free(ri->licensedb, free);
+    free_vendor_index(ri->fileinfo_index);
 
     if (ri->fileinfo) {
         while (!TAILQ_EMPTY(ri->fileinfo)) {
@@ -147,6 +150,7 @@ void free_rpminspect(struct rpminspect *ri)
     }
 
     free(ri->fileinfo_filename);
+    free_vendor_index(ri->caps_index);
 
     if (ri->caps) {
         while (!TAILQ_EMPTY(ri->caps)) {
@@ -154,6 +158,7 @@ void free_rpminspect(struct rpminspect *ri)
             TAILQ_REMOVE(ri->caps, centry, items);
 
             free(centry->pkg);
+            free_vendor_index(centry->index);
 
             if (centry->files) {
                 while (!TAILQ_EMPTY(centry->files)) {
@@ -176,6 +181,7 @@ void free_rpminspect(struct rpminspect *ri)
     }
 
     free(ri->caps_filename);
+    free_vendor_index(ri->rebaseable_index);
     list_free(ri->rebaseable, free);
     free(ri->rebaseable_filename);
 
@@ -194,6 +200,8 @@ void free_rpminspect(struct rpminspect *ri)
 
     free(ri->politics_filename);
 
+    free_secrule_pkgs(ri->secrule_pkgs);
+
     if (ri->security) {
         while (!TAILQ_EMPTY(ri->security)) {
             sentry = TAILQ_FIRST(ri->security);
@@ -255,6 +263,8 @@ void free_rpminspect(struct rpminspect *ri)
     free(ri->commands.annocheck);
 #endif
     free(ri->commands.udevadm);
+    free(ri->commands.xz);
+    free(ri->commands.zstd);
 
 #ifdef _HAVE_MODULARITYLABEL
     free_string_map(ri->modularity_release);
@@ -302,6 +312,7 @@ void free_rpminspect(struct rpminspect *ri)
     free_string_list_map(ri->inspection_ignores);
     list_free(ri->expected_empty_rpms, free);
     free_regex(ri->unicode_exclude);
+    free(ri->unicode_exclude_pattern);
     list_free(ri->unicode_excluded_mime_types, free);
     list_free(ri->unicode_forbidden_codepoints, free);
     free_deprule_ignore_map(ri->deprules_ignore);
@@ -314,6 +325,7 @@ void free_rpminspect(struct rpminspect *ri)
     HASH_ITER(hh, ri->header_cache, hentry, tmp_hentry) {
         HASH_DEL(ri->header_cache, hentry);
         free(hentry->pkg);
+        free(hentry->path);
         headerFree(hentry->hdr);
         free(hentry);
     }
@@ -327,8 +339,15 @@ void free_rpminspect(struct rpminspect *ri)
     }
 
     free_string_hash(ri->magic_types);
+    free_virus_engine();
+    free_license_index();
     list_free(ri->remedy_overrides, free);
     free_results(ri->results);
+    free(ri->result_cache);
+    free(ri->result_cache_key);
+    free_string_map(ri->cached_results);
+    free_timings(ri->timings);
+    close_events(ri);
 
     free_remedy_strings();
 
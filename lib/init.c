@@ -19,6 +19,7 @@
 #include "init.h"
 #include "queue.h"
 #include "uthash.h"
+#include "parallel.h"
 
 /*
  * Debug printing on the config file parser is verbose, so it can be
@@ -368,7 +369,7 @@ static inline void add_ignores(struct rpminspect *ri, parser_plugin *p, parser_c
     s = p->getstr(ctx, #inspection, RI_INCLUDE_PATH);                   \
                                                                         \
     if (s != NULL) {                                                    \
-        if (debug_mode) {                                               \
+        if (debug_mode || ri->compile_config) {                         \
             ri->inspection ## _path_include_pattern = strdup(s);        \
         }                                                               \
                                                                         \
@@ -382,7 +383,7 @@ static inline void add_ignores(struct rpminspect *ri, parser_plugin *p, parser_c
     s = p->getstr(ctx, #inspection, RI_EXCLUDE_PATH);                   \
                                                                         \
     if (s != NULL) {                                                    \
-        if (debug_mode) {                                               \
+        if (debug_mode || ri->compile_config) {                         \
             ri->inspection ## _path_exclude_pattern = strdup(s);        \
         }                                                               \
                                                                         \
@@ -657,6 +658,8 @@ static void read_cfgfile(struct rpminspect *ri, const char *filename)
     parser_plugin *p = NULL;
     parser_context *ctx = NULL;
     char *s = NULL;
+    char *end = NULL;
+    unsigned long int workers = 0;
     tabledict_cb_data annocheck_cb_data = { false, false, &ri->annocheck };
     string_list_t *slist = NULL;
 
@@ -682,6 +685,36 @@ static void read_cfgfile(struct rpminspect *ri, const char *filename)
         read_remedy(ri->remedyfile, ri);
     }
 
+    strget(p, ctx, RI_COMMON, RI_PACKAGE_CACHE, &ri->package_cache);
+    s = p->getstr(ctx, RI_COMMON, RI_PACKAGE_CACHE_SIZE);
+
+    if (s != NULL) {
+        errno = 0;
+        ri->package_cache_size = strtoul(s, 0, 10);
+
+        if (ri->package_cache_size == ULONG_MAX && errno == ERANGE) {
+            warn("*** strtoul");
+            ri->package_cache_size = PACKAGE_CACHE_SIZE;
+        }
+
+        free(s);
+    }
+
+    s = p->getstr(ctx, RI_COMMON, RI_WORKERS);
+
+    if (s != NULL) {
+        errno = 0;
+        workers = strtoul(s, &end, 10);
+
+        if (errno != 0 || *end != '\0' || *s == '-' || workers > 1024) {
+            warnx(_("*** invalid %s setting: %s"), RI_WORKERS, s);
+        } else {
+            default_parallel_processes = workers;
+        }
+
+        free(s);
+    }
+
     /* Read in some other basic settings */
     strget(p, ctx, RI_KOJI, RI_HUB, &ri->kojihub);
     strget(p, ctx, RI_KOJI, RI_DOWNLOAD_URSINE, &ri->kojiursine);
@@ -691,6 +724,8 @@ static void read_cfgfile(struct rpminspect *ri, const char *filename)
     strget(p, ctx, RI_COMMANDS, RI_ABIDIFF, &ri->commands.abidiff);
     strget(p, ctx, RI_COMMANDS, RI_KMIDIFF, &ri->commands.kmidiff);
     strget(p, ctx, RI_COMMANDS, RI_UDEVADM, &ri->commands.udevadm);
+    strget(p, ctx, RI_COMMANDS, RI_XZ, &ri->commands.xz);
+    strget(p, ctx, RI_COMMANDS, RI_ZSTD, &ri->commands.zstd);
     strget(p, ctx, RI_VENDOR, RI_VENDOR_DATA_DIR, &ri->vendor_data_dir);
     array(p, ctx, RI_VENDOR, RI_LICENSEDB, &ri->licensedb);
 
@@ -927,6 +962,12 @@ static void read_cfgfile(struct rpminspect *ri, const char *filename)
         warnx(_("*** error reading unicode exclude regular expression: %s"), s);
     }
 
+    if (s != NULL && ri->compile_config) {
+        free(ri->unicode_exclude_pattern);
+        ri->unicode_exclude_pattern = s;
+        s = NULL;
+    }
+
     free(s);
 
     array(p, ctx, RI_UNICODE, RI_EXCLUDED_MIME_TYPES, &ri->unicode_excluded_mime_types);
@@ -1012,6 +1053,11 @@ bool init_fileinfo(struct rpminspect *ri)
         return true;
     }
 
+    /* compiled in to the configuration snapshot */
+    if (read_snapshot_section(ri, SNAPSHOT_FILEINFO)) {
+        return true;
+    }
+
     /* the actual fileinfo file */
     if (ri->fileinfo_filename == NULL) {
         xasprintf(&ri->fileinfo_filename, "%s/%s/%s", ri->vendor_data_dir, FILEINFO_DIR, ri->product_release);
@@ -1129,6 +1175,11 @@ bool init_caps(struct rpminspect *ri)
         return true;
     }
 
+    /* compiled in to the configuration snapshot */
+    if (read_snapshot_section(ri, SNAPSHOT_CAPS)) {
+        return true;
+    }
+
     /* the actual caps list file */
     if (ri->caps_filename == NULL) {
         xasprintf(&ri->caps_filename, "%s/%s/%s", ri->vendor_data_dir, CAPABILITIES_DIR, ri->product_release);
@@ -1259,6 +1310,11 @@ bool init_rebaseable(struct rpminspect *ri)
         return true;
     }
 
+    /* compiled in to the configuration snapshot */
+    if (read_snapshot_section(ri, SNAPSHOT_REBASEABLE)) {
+        return true;
+    }
+
     /* the actual rebaseable list file */
     if (ri->rebaseable_filename == NULL) {
         xasprintf(&ri->rebaseable_filename, "%s/%s/%s", ri->vendor_data_dir, REBASEABLE_DIR, ri->product_release);
@@ -1321,6 +1377,11 @@ bool init_politics(struct rpminspect *ri)
         return true;
     }
 
+    /* compiled in to the configuration snapshot */
+    if (read_snapshot_section(ri, SNAPSHOT_POLITICS)) {
+        return true;
+    }
+
     /* the actual politics file */
     xasprintf(&ri->politics_filename, "%s/%s/%s", ri->vendor_data_dir, POLITICS_DIR, ri->product_release);
     assert(ri->politics_filename != NULL);
@@ -1435,6 +1496,11 @@ bool init_security(struct rpminspect *ri)
         ri->security_initialized = true;
     }
 
+    /* compiled in to the configuration snapshot */
+    if (read_snapshot_section(ri, SNAPSHOT_SECURITY)) {
+        return true;
+    }
+
     /* the actual security file */
     xasprintf(&ri->security_filename, "%s/%s/%s", ri->vendor_data_dir, SECURITY_DIR, ri->product_release);
     assert(ri->security_filename != NULL);
@@ -1595,6 +1661,11 @@ bool init_icons(struct rpminspect *ri)
         return true;
     }
 
+    /* compiled in to the configuration snapshot */
+    if (read_snapshot_section(ri, SNAPSHOT_ICONS)) {
+        return true;
+    }
+
     /* the actual icons list file */
     xasprintf(&ri->icons_filename, "%s/%s/%s", ri->vendor_data_dir, ICONS_DIR, ri->product_release);
     assert(ri->icons_filename != NULL);
@@ -1649,6 +1720,7 @@ struct rpminspect *xalloc_rpminspect(struct rpminspect *ri)
     ri->vendor_data_dir = strdup(VENDOR_DATA_DIR);
     ri->favor_release = FAVOR_NEWEST;
     ri->tests = ~0;
+    ri->needs = NEEDS_ALL;
     ri->desktop_entry_files_dir = strdup(DESKTOP_ENTRY_FILES_DIR);
     ri->bin_paths = list_from_array(BIN_PATHS);
     ri->bin_owner = strdup(BIN_OWNER);
@@ -1663,6 +1735,7 @@ struct rpminspect *xalloc_rpminspect(struct rpminspect *ri)
     ri->kmidiff_debuginfo_path = strdup(DEBUG_PATH);
     ri->annocheck_failure_severity = RESULT_VERIFY;
     ri->size_threshold = -1;
+    ri->package_cache_size = PACKAGE_CACHE_SIZE;
     ri->debuginfo_sections = strdup(ELF_SYMTAB" "ELF_DEBUG_INFO);
     ri->udev_rules_dirs = list_from_array(UDEV_RULES_DIRS);
 
@@ -1675,6 +1748,8 @@ struct rpminspect *xalloc_rpminspect(struct rpminspect *ri)
     ri->commands.annocheck = strdup(ANNOCHECK_CMD);
 #endif
     ri->commands.udevadm = strdup(UDEVADM_CMD);
+    ri->commands.xz = strdup(XZ_CMD);
+    ri->commands.zstd = strdup(ZSTD_CMD);
 
     /* Store full paths to all config files read */
     if (ri->cfgfiles == NULL) {
@@ -1686,20 +1761,36 @@ struct rpminspect *xalloc_rpminspect(struct rpminspect *ri)
 }
 
 /*
- * Initialize a struct rpminspect.  Called by applications using
- * librpminspect before they began calling library functions.  If ri
- * passed in is NULL, the function will allocate and initialize a new
- * struct rpminspect.  The caller is responsible for freeing the
- * struct rpminspect.  Return 0 on success, -1 on failure.
+ * Add a profile that was read to the list of configuration files and
+ * take ownership of the path.
  */
-struct rpminspect *init_rpminspect(struct rpminspect *ri, const char *cfgfile, const char *profile)
+static void add_cfgfile(struct rpminspect *ri, char *path)
 {
-    int i = 0;
-    char cwd[PATH_MAX + 1];
+    string_entry_t *entry = NULL;
+
+    if (list_contains(ri->cfgfiles, path)) {
+        free(path);
+        return;
+    }
+
+    entry = xalloc(sizeof(*entry));
+    entry->data = path;
+    TAILQ_INSERT_TAIL(ri->cfgfiles, entry, items);
+    return;
+}
+
+/*
+ * Read the configuration file and profile in to a struct rpminspect,
+ * allocating it if ri is NULL.  This is the first half of
+ * init_rpminspect() and does not depend on the current directory, so
+ * the --serve mode reads it once ahead of time.  Finish with
+ * init_local_rpminspect().
+ */
+struct rpminspect *read_rpminspect_config(struct rpminspect *ri, const char *cfgfile, const char *profile)
+{
+    bool snapshot = false;
     char *tmp = NULL;
     char *cf = NULL;
-    char *bn = NULL;
-    char *kernelnames[] = KERNEL_FILENAMES;
     string_entry_t *cfg = NULL;
 
     if (ri == NULL) {
@@ -1718,8 +1809,30 @@ struct rpminspect *init_rpminspect(struct rpminspect *ri, const char *cfgfile, c
             errx(RI_PROGRAM_ERROR, _("*** missing configuration file `%s'"), cfgfile);
         }
 
+        /*
+         * A configuration snapshot replaces the main configuration
+         * file and profiles.  If it is out of date, read the
+         * configuration file it was compiled from instead.
+         */
+        if (is_snapshot(cfg->data)) {
+            snapshot = read_snapshot(ri, cfg->data, profile, &cf);
+
+            if (!snapshot) {
+                warnx(_("*** configuration snapshot %s is out of date, reading %s"), cfg->data, cf);
+                free(cfg->data);
+                cfg->data = cf;
+                cf = NULL;
+
+                if (access(cfg->data, F_OK|R_OK) == -1) {
+                    errx(RI_PROGRAM_ERROR, _("*** missing configuration file `%s'"), cfg->data);
+                }
+            }
+        }
+
         /* Read the main configuration file to get things started */
-        read_cfgfile(ri, cfg->data);
+        if (!snapshot) {
+            read_cfgfile(ri, cfg->data);
+        }
 
         /* Store this config file as one we read in */
         if (!list_contains(ri->cfgfiles, cfg->data)) {
@@ -1731,7 +1844,7 @@ struct rpminspect *init_rpminspect(struct rpminspect *ri, const char *cfgfile, c
     }
 
     /* Look for and autoload a product release profile if we have one */
-    if (ri->product_release) {
+    if (!snapshot && ri->product_release) {
         xasprintf(&tmp, "%s/%s", ri->profiledir, PRODUCT_RELEASE_CFGFILE_SUBDIR);
         assert(tmp != NULL);
         cf = find_cfgfile(tmp, ri->product_release);
@@ -1739,22 +1852,40 @@ struct rpminspect *init_rpminspect(struct rpminspect *ri, const char *cfgfile, c
 
         if (cf) {
             read_cfgfile(ri, cf);
-            free(cf);
+            add_cfgfile(ri, cf);
         }
     }
 
     /* If a profile is specified, read an overlay config file */
-    if (profile) {
+    if (!snapshot && profile) {
         cf = find_cfgfile(ri->profiledir, profile);
 
         if (cf) {
             read_cfgfile(ri, cf);
-            free(cf);
+            add_cfgfile(ri, cf);
         } else {
             errx(RI_MISSING_PROFILE, _("*** unable to find profile '%s'"), profile);
         }
     }
 
+    return ri;
+}
+
+/*
+ * Read the optional configuration file in the current directory and
+ * set up the members used at runtime.  This is the second half of
+ * init_rpminspect(), see read_rpminspect_config().
+ */
+struct rpminspect *init_local_rpminspect(struct rpminspect *ri)
+{
+    int i = 0;
+    char cwd[PATH_MAX + 1];
+    char *cf = NULL;
+    char *bn = NULL;
+    char *kernelnames[] = KERNEL_FILENAMES;
+
+    assert(ri != NULL);
+
     /* get current dir */
     memset(cwd, '\0', sizeof(cwd));
 
@@ -1762,8 +1893,8 @@ struct rpminspect *init_rpminspect(struct rpminspect *ri, const char *cfgfile, c
         err(RI_PROGRAM_ERROR, "*** getcwd");
     }
 
-    /* optional config file from current directory */
-    cf = find_cfgfile(cwd, COMMAND_NAME);
+    /* optional config file from current directory, never compiled in to a snapshot */
+    cf = ri->compile_config ? NULL : find_cfgfile(cwd, COMMAND_NAME);
 
     if (cf) {
         /* save a copy of the local rpminspect config file for diagnostics */
@@ -1799,3 +1930,16 @@ struct rpminspect *init_rpminspect(struct rpminspect *ri, const char *cfgfile, c
 
     return ri;
 }
+
+/*
+ * Initialize a struct rpminspect.  Called by applications using
+ * librpminspect before they began calling library functions.  If ri
+ * passed in is NULL, the function will allocate and initialize a new
+ * struct rpminspect.  The caller is responsible for freeing the
+ * struct rpminspect.  Return 0 on success, -1 on failure.
+ */
+struct rpminspect *init_rpminspect(struct rpminspect *ri, const char *cfgfile, const char *profile)
+{
+    ri = read_rpminspect_config(ri, cfgfile, profile);
+    return init_local_rpminspect(ri);
+}
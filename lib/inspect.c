@@ -9,6 +9,7 @@
 #include "queue.h"
 #include "rpminspect.h"
 #include "inspect.h"
+#include "internal/probes.h"
 
 /*
  * Debugging mode toggle, set at runtime.
@@ -25,65 +26,67 @@ struct inspect inspections[] = {
      *   "short name",
      *   bool--true if this inspection contains security checks,
      *   bool--true if for single build, false if before&after required,
+     *   NEEDS_* flags from inspect.h for the data the inspection reads,
+     *   &want_file_func or NULL if all file contents are read,
      *   &function_pointer },
      *
      * NOTE: long descriptions are inspect.h and returned by inspection_desc()
      */
-    { INSPECT_ABIDIFF,       "abidiff",       false, false, &inspect_abidiff },
-    { INSPECT_ADDEDFILES,    "addedfiles",    true,  true,  &inspect_addedfiles },
+    { INSPECT_ABIDIFF,       "abidiff",       false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_abidiff },
+    { INSPECT_ADDEDFILES,    "addedfiles",    true,  true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_addedfiles },
 #if defined(_WITH_ANNOCHECK) || defined(_WITH_LIBANNOCHECK)
-    { INSPECT_ANNOCHECK,     "annocheck",     true,  true,  &inspect_annocheck },
+    { INSPECT_ANNOCHECK,     "annocheck",     true,  true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_annocheck },
 #endif
-    { INSPECT_ARCH,          "arch",          false, false, &inspect_arch },
-    { INSPECT_BADFUNCS,      "badfuncs",      false, true,  &inspect_badfuncs },
+    { INSPECT_ARCH,          "arch",          false, false, NEEDS_HEADERS, NULL, &inspect_arch },
+    { INSPECT_BADFUNCS,      "badfuncs",      false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, NULL, &inspect_badfuncs },
 #ifdef _WITH_LIBCAP
-    { INSPECT_CAPABILITIES,  "capabilities",  true,  true,  &inspect_capabilities },
+    { INSPECT_CAPABILITIES,  "capabilities",  true,  true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_capabilities },
 #endif
-    { INSPECT_CHANGEDFILES,  "changedfiles",  true,  false, &inspect_changedfiles },
-    { INSPECT_CHANGELOG,     "changelog",     false, false, &inspect_changelog },
-    { INSPECT_CONFIG,        "config",        false, false, &inspect_config },
-    { INSPECT_DEBUGINFO,     "debuginfo",     false, true,  &inspect_debuginfo },
-    { INSPECT_DESKTOP,       "desktop",       false, true,  &inspect_desktop },
-    { INSPECT_DISTTAG,       "disttag",       false, true,  &inspect_disttag },
-    { INSPECT_DOC,           "doc",           false, false, &inspect_doc },
-    { INSPECT_DSODEPS,       "dsodeps",       false, false, &inspect_dsodeps },
-    { INSPECT_ELF,           "elf",           true,  true,  &inspect_elf },
-    { INSPECT_EMPTYRPM,      "emptyrpm",      false, true,  &inspect_emptyrpm },
-    { INSPECT_FILES,         "files",         false, true,  &inspect_files },
-    { INSPECT_FILESIZE,      "filesize",      false, false, &inspect_filesize },
-    { INSPECT_JAVABYTECODE,  "javabytecode",  false, true,  &inspect_javabytecode },
-    { INSPECT_KMIDIFF,       "kmidiff",       false, false, &inspect_kmidiff },
+    { INSPECT_CHANGEDFILES,  "changedfiles",  true,  false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_changedfiles },
+    { INSPECT_CHANGELOG,     "changelog",     false, false, NEEDS_HEADERS, NULL, &inspect_changelog },
+    { INSPECT_CONFIG,        "config",        false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_config },
+    { INSPECT_DEBUGINFO,     "debuginfo",     false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_debuginfo },
+    { INSPECT_DESKTOP,       "desktop",       false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_desktop },
+    { INSPECT_DISTTAG,       "disttag",       false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, &is_srpm_spec_file, &inspect_disttag },
+    { INSPECT_DOC,           "doc",           false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_doc },
+    { INSPECT_DSODEPS,       "dsodeps",       false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_dsodeps },
+    { INSPECT_ELF,           "elf",           true,  true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_elf },
+    { INSPECT_EMPTYRPM,      "emptyrpm",      false, true,  NEEDS_HEADERS | NEEDS_FILES, NULL, &inspect_emptyrpm },
+    { INSPECT_FILES,         "files",         false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, &is_srpm_spec_file, &inspect_files },
+    { INSPECT_FILESIZE,      "filesize",      false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_filesize },
+    { INSPECT_JAVABYTECODE,  "javabytecode",  false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_javabytecode },
+    { INSPECT_KMIDIFF,       "kmidiff",       false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_kmidiff },
 #ifdef _WITH_LIBKMOD
-    { INSPECT_KMOD,          "kmod",          false, false, &inspect_kmod },
+    { INSPECT_KMOD,          "kmod",          false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_kmod },
 #endif
-    { INSPECT_LICENSE,       "license",       false, true,  &inspect_license },
-    { INSPECT_LOSTPAYLOAD,   "lostpayload",   false, false, &inspect_lostpayload },
-    { INSPECT_LTO,           "lto",           false, true,  &inspect_lto },
-    { INSPECT_MANPAGE,       "manpage",       false, true,  &inspect_manpage },
-    { INSPECT_METADATA,      "metadata",      false, true,  &inspect_metadata },
+    { INSPECT_LICENSE,       "license",       false, true,  NEEDS_HEADERS, NULL, &inspect_license },
+    { INSPECT_LOSTPAYLOAD,   "lostpayload",   false, false, NEEDS_HEADERS | NEEDS_FILES, NULL, &inspect_lostpayload },
+    { INSPECT_LTO,           "lto",           false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, NULL, &inspect_lto },
+    { INSPECT_MANPAGE,       "manpage",       false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, &is_manpage_file, &inspect_manpage },
+    { INSPECT_METADATA,      "metadata",      false, true,  NEEDS_HEADERS, NULL, &inspect_metadata },
 #ifdef _HAVE_MODULARITYLABEL
-    { INSPECT_MODULARITY,    "modularity",    false, true,  &inspect_modularity },
+    { INSPECT_MODULARITY,    "modularity",    false, true,  NEEDS_HEADERS, NULL, &inspect_modularity },
 #endif
-    { INSPECT_MOVEDFILES,    "movedfiles",    false, false, &inspect_movedfiles },
-    { INSPECT_OWNERSHIP,     "ownership",     true,  true,  &inspect_ownership },
-    { INSPECT_PATCHES,       "patches",       false, true,  &inspect_patches },
-    { INSPECT_PATHMIGRATION, "pathmigration", false, true,  &inspect_pathmigration },
-    { INSPECT_PERMISSIONS,   "permissions",   true,  true,  &inspect_permissions },
-    { INSPECT_POLITICS,      "politics",      false, true,  &inspect_politics },
-    { INSPECT_REMOVEDFILES,  "removedfiles",  true,  false, &inspect_removedfiles },
-    { INSPECT_RPMDEPS,       "rpmdeps",       false, true,  &inspect_rpmdeps },
-    { INSPECT_RUNPATH,       "runpath",       false, true,  &inspect_runpath },
-    { INSPECT_SHELLSYNTAX,   "shellsyntax",   false, true,  &inspect_shellsyntax },
-    { INSPECT_SPECNAME,      "specname",      false, true,  &inspect_specname },
-    { INSPECT_SUBPACKAGES,   "subpackages",   false, false, &inspect_subpackages },
-    { INSPECT_SYMLINKS,      "symlinks",      false, true,  &inspect_symlinks },
-    { INSPECT_TYPES,         "types",         false, false, &inspect_types },
-    { INSPECT_UDEVRULES,     "udevrules",     false, true,  &inspect_udevrules },
-    { INSPECT_UNICODE,       "unicode",       false, true,  &inspect_unicode },
-    { INSPECT_UPSTREAM,      "upstream",      false, false, &inspect_upstream },
-    { INSPECT_VIRUS,         "virus",         true,  true,  &inspect_virus },
-    { INSPECT_XML,           "xml",           false, true,  &inspect_xml },
-    { 0,                     NULL,            false, false, NULL }
+    { INSPECT_MOVEDFILES,    "movedfiles",    false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_PEERS, NULL, &inspect_movedfiles },
+    { INSPECT_OWNERSHIP,     "ownership",     true,  true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_PEERS, NULL, &inspect_ownership },
+    { INSPECT_PATCHES,       "patches",       false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_patches },
+    { INSPECT_PATHMIGRATION, "pathmigration", false, true,  NEEDS_HEADERS | NEEDS_FILES, NULL, &inspect_pathmigration },
+    { INSPECT_PERMISSIONS,   "permissions",   true,  true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_permissions },
+    { INSPECT_POLITICS,      "politics",      false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, NULL, &inspect_politics },
+    { INSPECT_REMOVEDFILES,  "removedfiles",  true,  false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_removedfiles },
+    { INSPECT_RPMDEPS,       "rpmdeps",       false, true,  NEEDS_HEADERS | NEEDS_FILES, NULL, &inspect_rpmdeps },
+    { INSPECT_RUNPATH,       "runpath",       false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, NULL, &inspect_runpath },
+    { INSPECT_SHELLSYNTAX,   "shellsyntax",   false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_shellsyntax },
+    { INSPECT_SPECNAME,      "specname",      false, true,  NEEDS_HEADERS | NEEDS_FILES, NULL, &inspect_specname },
+    { INSPECT_SUBPACKAGES,   "subpackages",   false, false, NEEDS_HEADERS, NULL, &inspect_subpackages },
+    { INSPECT_SYMLINKS,      "symlinks",      false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_symlinks },
+    { INSPECT_TYPES,         "types",         false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_types },
+    { INSPECT_UDEVRULES,     "udevrules",     false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, &is_udev_rules_file, &inspect_udevrules },
+    { INSPECT_UNICODE,       "unicode",       false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, NULL, &inspect_unicode },
+    { INSPECT_UPSTREAM,      "upstream",      false, false, NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS | NEEDS_PEERS, NULL, &inspect_upstream },
+    { INSPECT_VIRUS,         "virus",         true,  true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, NULL, &inspect_virus },
+    { INSPECT_XML,           "xml",           false, true,  NEEDS_HEADERS | NEEDS_FILES | NEEDS_CONTENTS, &is_xml_candidate, &inspect_xml },
+    { 0,                     NULL,            false, false, 0, NULL, NULL }
 };
 
 /*
@@ -122,6 +125,7 @@ bool foreach_peer_file(struct rpminspect *ri, const char *inspection, foreach_pe
 {
     rpmpeer_entry_t *peer;
     rpmfile_entry_t *file;
+    bool r = true;
     bool result = true;
 
     assert(ri != NULL);
@@ -139,7 +143,12 @@ bool foreach_peer_file(struct rpminspect *ri, const char *inspection, foreach_pe
                 continue;
             }
 
-            if (!check_fn(ri, file)) {
+            count_timed_file();
+            RI_PROBE3(file__start, inspection, peer->after_rpm, file->localpath);
+            r = check_fn(ri, file);
+            RI_PROBE4(file__done, inspection, peer->after_rpm, file->localpath, r);
+
+            if (!r) {
                 result = false;
             }
         }
@@ -148,6 +157,62 @@ bool foreach_peer_file(struct rpminspect *ri, const char *inspection, foreach_pe
     return result;
 }
 
+/*
+ * Return the NEEDS_* flags of all the selected inspections combined.
+ * Inspections that will not run for a single build are left out.
+ */
+unsigned int inspection_needs(const uint64_t tests, const bool single_build)
+{
+    int i = 0;
+    unsigned int needs = NEEDS_HEADERS;
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if (!(tests & inspections[i].flag)) {
+            continue;
+        }
+
+        if (single_build && !inspections[i].single_build) {
+            continue;
+        }
+
+        needs |= inspections[i].needs;
+    }
+
+    return needs;
+}
+
+/*
+ * Returns true if any selected inspection reads the contents of the
+ * given file.
+ */
+bool inspection_wants_file(struct rpminspect *ri, const rpmfile_entry_t *file)
+{
+    int i = 0;
+
+    assert(ri != NULL);
+    assert(file != NULL);
+
+    if (!(ri->needs & NEEDS_CONTENTS)) {
+        return false;
+    }
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if (!(ri->tests & inspections[i].flag) || !(inspections[i].needs & NEEDS_CONTENTS)) {
+            continue;
+        }
+
+        if (ri->before == NULL && !inspections[i].single_build) {
+            continue;
+        }
+
+        if (inspections[i].wants == NULL || inspections[i].wants(ri, file)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /*
  * Return inspection ID given its name string.
  */
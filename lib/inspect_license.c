@@ -12,6 +12,7 @@
  */
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <err.h>
 #include <stdbool.h>
@@ -29,11 +30,13 @@
 /* Globals */
 static bool result = true;
 static const char *srpm = NULL;
-static int nspdx = 0;
-static int nlegacy = 0;
-static int ndual = 0;
-string_list_t *booleans = NULL;
-string_list_t *dual = NULL;
+static license_tag_t *license_tags = NULL;
+
+/* indexes kept from one run to the next, see load_license_index() */
+static char *licdbs_key = NULL;
+static license_db_list_t *licdbs = NULL;
+static license_index_t *dual = NULL;
+static license_index_t *dual_case = NULL;
 
 /* Helper to determine overall inspection result */
 static bool get_result(const bool result, const severity_t sev)
@@ -74,8 +77,12 @@ static parser_plugin *read_licensedb(struct rpminspect *ri, const char *db, pars
     return p;
 }
 
-/* another callback for dual_cb() and lic_cb() to get the actual strings */
-static bool get_db_strings(const char *license_name, void *cb_data, char **spdx_abbrev, string_list_t **fedora_abbrev, string_list_t **fedora_name, bool *approved)
+/*
+ * another callback for index_cb() to get the actual strings.  An entry
+ * that is not allowed except for some packages is not approved and
+ * those packages are returned in exceptions.
+ */
+static bool get_db_strings(const char *license_name, void *cb_data, char **spdx_abbrev, string_list_t **fedora_abbrev, string_list_t **fedora_name, bool *approved, string_list_t **exceptions)
 {
     lic_cb_data *data = cb_data;
     parser_plugin *p = data->p;
@@ -83,8 +90,9 @@ static bool get_db_strings(const char *license_name, void *cb_data, char **spdx_
     parser_context *cont = NULL;
     json_object *block = NULL;
     string_list_t *slist = NULL;
-    string_list_t *exceptions = NULL;
+    string_list_t *packages = NULL;
     string_entry_t *entry = NULL;
+    bool excepted = false;
     char *t = NULL;
 
     if (strlen(license_name) == 0) {
@@ -106,25 +114,36 @@ static bool get_db_strings(const char *license_name, void *cb_data, char **spdx_
 
         *approved = false;
         array(p, cont, "license", "status", &slist);
-        array(p, cont, "license", "packages_with_exceptions", &exceptions);
+        array(p, cont, "license", "packages_with_exceptions", &packages);
 
         if (list_len(slist)) {
             TAILQ_FOREACH(entry, slist, items) {
-                if (!strcmp(entry->data, "allowed") || strprefix(entry->data, "allowed-") || (!strcmp(entry->data, "not-allowed") && list_contains(exceptions, srpm))) {
+                if (!strcmp(entry->data, "allowed") || strprefix(entry->data, "allowed-")) {
                     *approved = true;
                     break;
+                } else if (!strcmp(entry->data, "not-allowed") && list_len(packages)) {
+                    excepted = true;
                 }
            }
        }
 
        list_free(slist, free);
-       list_free(exceptions, free);
+
+        if (!*approved && excepted) {
+            *exceptions = packages;
+        } else {
+            list_free(packages, free);
+        }
     }
 
     /* new format failed, fall back on previous format */
     if (*spdx_abbrev == NULL) {
         list_free(*fedora_abbrev, free);
         list_free(*fedora_name, free);
+        list_free(*exceptions, free);
+        *fedora_abbrev = NULL;
+        *fedora_name = NULL;
+        *exceptions = NULL;
         *approved = false;
 
         /* the new API format failed, fall back on the legacy format */
@@ -161,12 +180,48 @@ static bool get_db_strings(const char *license_name, void *cb_data, char **spdx_
     return true;
 }
 
-/* lambda: check the case and matching of SPDX special words */
-static bool check_spdx_special_words(struct rpminspect *ri, const char *pkg_word, const char *db_word)
+/* return a lowercase copy of a string, caller must free */
+static char *lowercase(const char *s)
+{
+    char *r = NULL;
+    char *c = NULL;
+
+    assert(s != NULL);
+
+    r = strdup(s);
+    assert(r != NULL);
+
+    for (c = r; *c != '\0'; c++) {
+        *c = tolower((unsigned char) *c);
+    }
+
+    return r;
+}
+
+/* report a mixed case SPDX keyword found while matching a License tag */
+static void report_spdx_keyword(struct rpminspect *ri, const char *word)
 {
     struct result_params params;
 
     assert(ri != NULL);
+    assert(word != NULL);
+
+    init_result_params(&params);
+    xasprintf(&params.msg, _("An invalid SPDX keyword was found.  The keyword '%s' must always be written in all lowercase or all uppercase (not mixed case)."), word);
+    params.header = NAME_LICENSE;
+    params.severity = RESULT_BAD;
+    params.remedy = REMEDY_INVALID_BOOLEAN;
+    params.verb = VERB_FAILED;
+    params.noun = _("invalid SPDX expression keyword");
+    add_result(ri, &params);
+    free(params.msg);
+    return;
+}
+
+/* lambda: check the case and matching of SPDX special words */
+static bool check_spdx_special_words(license_tag_t *lt, const char *pkg_word, const char *db_word)
+{
+    assert(lt != NULL);
     assert(pkg_word != NULL);
     assert(db_word != NULL);
 
@@ -186,18 +241,10 @@ static bool check_spdx_special_words(struct rpminspect *ri, const char *pkg_word
         } else {
             /*
              * Did we catch a forbidden capitalization of the words "and",
-             * "or", or "with"?  Call the police!
+             * "or", or "with"?  Call the police!  This is reported for
+             * every package using the tag, see is_valid_license().
              */
-            init_result_params(&params);
-            xasprintf(&params.msg, _("An invalid SPDX keyword was found.  The keyword '%s' must always be written in all lowercase or all uppercase (not mixed case)."), pkg_word);
-            params.header = NAME_LICENSE;
-            params.severity = RESULT_BAD;
-            params.remedy = REMEDY_INVALID_BOOLEAN;
-            params.verb = VERB_FAILED;
-            params.noun = _("invalid SPDX expression keyword");
-            add_result(ri, &params);
-            free(params.msg);
-
+            lt->keywords = list_add(lt->keywords, pkg_word);
             return false;
         }
     }
@@ -206,7 +253,7 @@ static bool check_spdx_special_words(struct rpminspect *ri, const char *pkg_word
 }
 
 /* lambda: see if two candidate SPDX expression strings match SPDX rules */
-static bool spdx_expression_match(struct rpminspect *ri, const char *pkg_license, const char *db_license)
+static bool spdx_expression_match(license_tag_t *lt, const char *pkg_license, const char *db_license)
 {
     bool match = false;
     string_list_t *pkgtokens = NULL;
@@ -214,7 +261,7 @@ static bool spdx_expression_match(struct rpminspect *ri, const char *pkg_license
     string_entry_t *pkg = NULL;
     string_entry_t *db = NULL;
 
-    assert(ri != NULL);
+    assert(lt != NULL);
 
     if ((pkg_license == NULL && db_license) || (pkg_license && db_license == NULL)) {
         return false;
@@ -246,7 +293,7 @@ static bool spdx_expression_match(struct rpminspect *ri, const char *pkg_license
     while (pkg && db) {
         /* check special words first */
         if (!strcasecmp(pkg->data, "AND") || !strcasecmp(pkg->data, "OR") || !strcasecmp(pkg->data, "WITH")) {
-            if (check_spdx_special_words(ri, pkg->data, db->data)) {
+            if (check_spdx_special_words(lt, pkg->data, db->data)) {
                 /* force a continue here since in SPDX-speak, "with == WITH" */
                 pkg = TAILQ_NEXT(pkg, items);
                 db = TAILQ_NEXT(db, items);
@@ -293,84 +340,161 @@ static bool list_contains_spdx_expression(string_list_t *list, const char *expre
     return match;
 }
 
-/* lambda; finds dual legacy and SPDX license expressions */
-static bool dual_cb(const char *license_name, void *cb_data)
+/* true if an earlier entry in the list holds the same string */
+static bool seen_before(const string_list_t *list, const string_entry_t *entry)
 {
-    string_list_t *fedora_abbrev = NULL;
-    string_list_t *fedora_name = NULL;
-    char *spdx_abbrev = NULL;
-    bool approved = false;
+    const string_entry_t *prev = NULL;
 
-    if (!get_db_strings(license_name, cb_data, &spdx_abbrev, &fedora_abbrev, &fedora_name, &approved)) {
-        return false;
+    for (prev = TAILQ_FIRST(list); prev != entry; prev = TAILQ_NEXT(prev, items)) {
+        if (!strcmp(prev->data, entry->data)) {
+            return true;
+        }
     }
 
-    /* no SPDX expression or not approved? done */
-    if (spdx_abbrev == NULL || !approved) {
-        goto done;
+    return false;
+}
+
+/*
+ * Count a license db entry under the given index key, also in the
+ * spdx member if spdx is set.  An entry only allowed for some packages
+ * is counted under each of those packages instead.
+ */
+static void index_add(license_index_t **index, const char *key, const string_list_t *packages, const bool spdx)
+{
+    license_index_t *entry = NULL;
+    string_entry_t *pkg = NULL;
+
+    assert(key != NULL);
+
+    HASH_FIND_STR(*index, key, entry);
+
+    if (entry == NULL) {
+        entry = xalloc(sizeof(*entry));
+        entry->key = strdup(key);
+        assert(entry->key != NULL);
+        HASH_ADD_KEYPTR(hh, *index, entry->key, strlen(entry->key), entry);
     }
 
-    /* collect any dual licenses */
-    if (approved && spdx_abbrev && (list_contains_spdx_expression(fedora_abbrev, spdx_abbrev) || list_contains_spdx_expression(fedora_name, spdx_abbrev))) {
-        dual = list_add(dual, spdx_abbrev);
+    if (packages == NULL) {
+        entry->count++;
+
+        if (spdx) {
+            entry->spdx++;
+        }
+
+        return;
     }
 
-done:
-    list_free(fedora_abbrev, free);
-    list_free(fedora_name, free);
-    free(spdx_abbrev);
+    TAILQ_FOREACH(pkg, packages, items) {
+        if (!seen_before(packages, pkg)) {
+            index_add(&entry->packages, pkg->data, NULL, spdx);
+        }
+    }
 
-    /*
-     * you may think this should be return true, but it can't be
-     * otherwise the parse_json() loopity loop will stop
-     */
-    return false;
+    return;
+}
+
+/*
+ * Number of entries under an index key that are approved for the
+ * package being inspected.  The number of those also counted as spdx
+ * is returned in spdx if it is not NULL.
+ */
+static int index_count(const license_index_t *entry, int *spdx)
+{
+    int n = 0;
+    int s = 0;
+    license_index_t *pentry = NULL;
+
+    if (entry != NULL) {
+        n = entry->count;
+        s = entry->spdx;
+
+        if (srpm != NULL && entry->packages != NULL) {
+            HASH_FIND_STR(entry->packages, srpm, pentry);
+
+            if (pentry != NULL) {
+                n += pentry->count;
+                s += pentry->spdx;
+            }
+        }
+    }
+
+    if (spdx != NULL) {
+        *spdx = s;
+    }
+
+    return n;
 }
 
-/* lambda; checks against an entry in the license database. */
-static bool lic_cb(const char *license_name, void *cb_data)
+static void free_index(license_index_t *index)
+{
+    license_index_t *entry = NULL;
+    license_index_t *tmp_entry = NULL;
+
+    HASH_ITER(hh, index, entry, tmp_entry) {
+        HASH_DEL(index, entry);
+        free_index(entry->packages);
+        free(entry->key);
+        free(entry);
+    }
+
+    return;
+}
+
+/*
+ * lambda; adds a license database entry to the indexes and collects
+ * dual legacy and SPDX license expressions.  Only approved entries
+ * and entries allowed for some packages are indexed since no other
+ * entry can validate a License tag.
+ */
+static bool index_cb(const char *license_name, void *cb_data)
 {
     lic_cb_data *data = cb_data;
     string_list_t *fedora_abbrev = NULL;
     string_list_t *fedora_name = NULL;
+    string_list_t *exceptions = NULL;
+    string_list_t *legacy = NULL;
+    string_entry_t *entry = NULL;
     char *spdx_abbrev = NULL;
+    char *key = NULL;
     bool approved = false;
 
-    if (!get_db_strings(license_name, cb_data, &spdx_abbrev, &fedora_abbrev, &fedora_name, &approved)) {
+    if (!get_db_strings(license_name, cb_data, &spdx_abbrev, &fedora_abbrev, &fedora_name, &approved, &exceptions)) {
         return false;
     }
 
-    /* No full tag match and no abbreviations; license entry invalid. */
-    if (spdx_abbrev == NULL && (fedora_abbrev == NULL || TAILQ_EMPTY(fedora_abbrev)) && (fedora_name == NULL || TAILQ_EMPTY(fedora_name))) {
+    if (!approved && exceptions == NULL) {
         goto done;
     }
 
+    if (spdx_abbrev) {
+        key = lowercase(spdx_abbrev);
+        index_add(&data->index->spdx, key, exceptions, false);
+
+        /* collect any dual licenses */
+        if (list_contains_spdx_expression(fedora_abbrev, spdx_abbrev) || list_contains_spdx_expression(fedora_name, spdx_abbrev)) {
+            index_add(&dual, spdx_abbrev, exceptions, false);
+            index_add(&dual_case, key, exceptions, false);
+        }
+
+        free(key);
+    }
+
     /*
-     * If the entire license string is approved, that is valid.
-     * If we hit 'fedora_abbrev', that is valid.
-     * If we hit 'spdx_abbrev' and approved is true, that is valid.
-     * NOTE: we only match the first hit in the license database
+     * Legacy identifiers match on the Fedora abbreviation, or on the
+     * Fedora name when there are no abbreviations.  Count each entry
+     * once per identifier.
      */
-    if (approved) {
-        if (spdx_expression_match(data->ri, data->lic, spdx_abbrev)) {
-            data->valid = true;
-            nspdx++;
-
-            if (list_case_contains(dual, spdx_abbrev)) {
-                /* license token is valid under the legacy system and SPDX */
-                ndual++;
-            }
-        } else if ((fedora_abbrev && list_len(fedora_abbrev) > 0 && list_contains(fedora_abbrev, data->lic))
-                   || ((fedora_abbrev == NULL || list_len(fedora_abbrev) == 0)
-                       && (fedora_name && list_len(fedora_name) > 0)
-                       && list_contains(fedora_name, data->lic))) {
-            /* Old Fedora abbreviation matches -or- there are no Fedora abbreviations but a Fedora name matches */
-            data->valid = true;
-            nlegacy++;
-
-            if (list_contains(dual, data->lic)) {
-                /* license token is valid under the legacy system and SPDX */
-                ndual++;
+    if (fedora_abbrev && !TAILQ_EMPTY(fedora_abbrev)) {
+        legacy = fedora_abbrev;
+    } else {
+        legacy = fedora_name;
+    }
+
+    if (legacy) {
+        TAILQ_FOREACH(entry, legacy, items) {
+            if (!seen_before(legacy, entry)) {
+                index_add(&data->index->legacy, entry->data, exceptions, spdx_abbrev && !strcasecmp(spdx_abbrev, entry->data));
             }
         }
     }
@@ -378,6 +502,7 @@ static bool lic_cb(const char *license_name, void *cb_data)
 done:
     list_free(fedora_abbrev, free);
     list_free(fedora_name, free);
+    list_free(exceptions, free);
     free(spdx_abbrev);
 
     /*
@@ -388,35 +513,189 @@ done:
 }
 
 /*
- * Gathers all approved licenses with the same abbreviation for the
- * SPDX expression and the legacy name.
+ * Read a license database and build its indexes.  The database is
+ * walked once here and then only the indexes are used.  Returns NULL
+ * if the database cannot be read.
  */
-static void gather_dual_licenses(struct rpminspect *ri, parser_plugin *p, parser_context *db)
+static license_db_t *index_licensedb(struct rpminspect *ri, const char *db)
 {
-    lic_cb_data data = { ri, p, db, NULL, false };
+    lic_cb_data data;
+    license_db_t *index = NULL;
+
+    assert(ri != NULL);
+    assert(db != NULL);
+
+    data.p = read_licensedb(ri, db, &data.db);
+
+    if (data.p == NULL) {
+        return NULL;
+    }
+
+    index = xalloc(sizeof(*index));
+    data.index = index;
+
+    if (data.p->keymap(data.db, NULL, NULL, index_cb, &data)) {
+        warnx(_("*** problem reading license database %s"), db);
+    }
+
+    data.p->fini(data.db);
+    return index;
+}
+
+/*
+ * Free the license database indexes built by load_license_index().
+ */
+void free_license_index(void)
+{
+    license_db_t *index = NULL;
+
+    if (licdbs != NULL) {
+        while (!TAILQ_EMPTY(licdbs)) {
+            index = TAILQ_FIRST(licdbs);
+            TAILQ_REMOVE(licdbs, index, items);
+            free_index(index->spdx);
+            free_index(index->legacy);
+            free(index);
+        }
+
+        free(licdbs);
+        licdbs = NULL;
+    }
+
+    free_index(dual);
+    free_index(dual_case);
+    dual = NULL;
+    dual_case = NULL;
+    free(licdbs_key);
+    licdbs_key = NULL;
+    return;
+}
+
+/*
+ * Read each license database named in the configuration once and
+ * build its indexes.  Entries allowed only for some packages are kept
+ * under those packages, so the indexes do not depend on the build
+ * being inspected and are kept until free_license_index().  They are
+ * only built again if the configuration names other databases.  The
+ * --serve mode calls this once so jobs start with the indexes built.
+ */
+void load_license_index(struct rpminspect *ri)
+{
+    char *key = NULL;
+    string_entry_t *entry = NULL;
+    license_db_t *index = NULL;
+
+    assert(ri != NULL);
+
+    if (ri->licensedb == NULL || TAILQ_EMPTY(ri->licensedb)) {
+        return;
+    }
+
+    /* the databases are found by name under the vendor data dir */
+    key = strdup(ri->vendor_data_dir ? ri->vendor_data_dir : "");
+    assert(key != NULL);
 
-    if (p->keymap(db, NULL, NULL, dual_cb, &data)) {
-        warnx(_("*** problem gathering dual SPDX/legacy license identifiers"));
+    TAILQ_FOREACH(entry, ri->licensedb, items) {
+        key = strappend(key, "\n", entry->data, NULL);
+    }
+
+    if (licdbs_key != NULL && !strcmp(licdbs_key, key)) {
+        free(key);
         return;
     }
 
+    free_license_index();
+    licdbs_key = key;
+    licdbs = xalloc(sizeof(*licdbs));
+    TAILQ_INIT(licdbs);
+
+    TAILQ_FOREACH(entry, ri->licensedb, items) {
+        index = index_licensedb(ri, entry->data);
+
+        if (index != NULL) {
+            TAILQ_INSERT_TAIL(licdbs, index, items);
+        }
+    }
+
+    return;
+}
+
+static void free_license_tags(void)
+{
+    license_tag_t *lt = NULL;
+    license_tag_t *tmp_lt = NULL;
+
+    HASH_ITER(hh, license_tags, lt, tmp_lt) {
+        HASH_DEL(license_tags, lt);
+        free(lt->license);
+        list_free(lt->unapproved, free);
+        list_free(lt->booleans, free);
+        list_free(lt->keywords, free);
+        free(lt);
+    }
+
+    license_tags = NULL;
     return;
 }
 
 /*
- * Called by is_valid_license() to check each short license token.  It
- * will also try to do a whole match on the license tag string.
+ * Called by validate_license() to check each short license token
+ * against one license database.  It will also try to do a whole match
+ * on the license tag string.  Every approved entry in the database
+ * matching the token is counted as an SPDX or legacy identifier.
  */
-static bool check_license_abbrev(struct rpminspect *ri, parser_plugin *p, parser_context *db, const char *lic)
+static bool check_license_abbrev(license_tag_t *lt, const license_db_t *index, const char *lic)
 {
-    lic_cb_data data = { ri, p, db, lic, false };
+    bool valid = false;
+    bool spdx = false;
+    int n = 0;
+    int s = 0;
+    char *key = NULL;
+    license_index_t *entry = NULL;
+    license_index_t *dentry = NULL;
+
+    assert(lt != NULL);
+    assert(index != NULL);
+    assert(lic != NULL);
+
+    /* SPDX expressions match case insensitively first, see spdx_expression_match() */
+    key = lowercase(lic);
+    HASH_FIND_STR(index->spdx, key, entry);
+    n = index_count(entry, NULL);
+
+    if (n > 0 && spdx_expression_match(lt, lic, entry->key)) {
+        valid = spdx = true;
+        lt->nspdx += n;
+        HASH_FIND_STR(dual_case, key, dentry);
+
+        if (index_count(dentry, NULL) > 0) {
+            /* license token is valid under the legacy system and SPDX */
+            lt->ndual += n;
+        }
+    }
 
-    if (p->keymap(db, NULL, NULL, lic_cb, &data)) {
-        warnx(_("*** problem checking license database"));
-        return false;
+    free(key);
+
+    /* entries already matched by their SPDX expression do not count again */
+    HASH_FIND_STR(index->legacy, lic, entry);
+    n = index_count(entry, &s);
+
+    if (spdx) {
+        n -= s;
     }
 
-    return data.valid;
+    if (n > 0) {
+        valid = true;
+        lt->nlegacy += n;
+        HASH_FIND_STR(dual, lic, dentry);
+
+        if (index_count(dentry, NULL) > 0) {
+            /* license token is valid under the legacy system and SPDX */
+            lt->ndual += n;
+        }
+    }
+
+    return valid;
 }
 
 static void token_add(string_map_t **tags, const char *token)
@@ -436,9 +715,9 @@ static void token_add(string_map_t **tags, const char *token)
 
 /*
  * Split up the license expression in to tokens.  This can be an empty
- * list on return.
+ * list on return.  The boolean keywords are saved in the tag.
  */
-static string_map_t *tokenize_license_tag(const char *license)
+static string_map_t *tokenize_license_tag(license_tag_t *lt, const char *license)
 {
     char *tagtokens = NULL;
     char *tagcopy = NULL;
@@ -446,6 +725,7 @@ static string_map_t *tokenize_license_tag(const char *license)
     char *lic = NULL;
     string_map_t *tags = NULL;
 
+    assert(lt != NULL);
     assert(license != NULL);
 
     tagtokens = tagcopy = strdup(license);
@@ -457,7 +737,7 @@ static string_map_t *tokenize_license_tag(const char *license)
         }
 
         if (!strcasecmp(token, "AND") || !strcasecmp(token, "OR")) {
-            booleans = list_add(booleans, token);
+            lt->booleans = list_add(lt->booleans, token);
 
             if (lic == NULL) {
                 continue;
@@ -582,12 +862,14 @@ static string_list_t *get_paren_expressions(const char *license)
  * 2) Tokenize the license tag.
  * 3) Iterate over each token, skipping the 'and' and 'or' keywords, to
  *    match against the license database.
- * 4) The function returns true if all license tags are approved in the
- *    database.  Any single tag that is unapproved results in false.
+ * 4) Any token not approved in the database is saved in the returned
+ *    license_tag_t for is_valid_license() to report.
+ *
+ * Subpackages nearly always share the License tag, so the result is
+ * cached by the tag string and each distinct tag is validated once.
  */
-static bool is_valid_license(struct rpminspect *ri, struct result_params *params, const char *nevra, const char *license)
+static license_tag_t *validate_license(const char *license)
 {
-    bool r = true;
     int balance = 0;
     size_t i = 0;
     char *tmp = NULL;
@@ -596,25 +878,22 @@ static bool is_valid_license(struct rpminspect *ri, struct result_params *params
     string_map_t *tags = NULL;
     string_map_t *tagtoken = NULL;
     string_map_t *tmp_tagtoken = NULL;
-    string_entry_t *entry = NULL;
     string_list_t *parenexps = NULL;
     string_entry_t *pentry = NULL;
-    parser_plugin *p = NULL;
-    parser_context *db = NULL;
+    license_db_t *index = NULL;
+    license_tag_t *lt = NULL;
 
-    assert(ri != NULL);
-    assert(params != NULL);
-    assert(nevra != NULL);
     assert(license != NULL);
 
-    /* Set up the result parameters */
-    params->severity = RESULT_BAD;
-    params->remedy = REMEDY_UNAPPROVED_LICENSE;
+    lt = xalloc(sizeof(*lt));
+    lt->license = strdup(license);
+    assert(lt->license != NULL);
+    HASH_ADD_KEYPTR(hh, license_tags, lt->license, strlen(lt->license), lt);
 
     /* check for matching parens */
     for (i = 0; i < strlen(license); i++) {
         if (balance < 0) {
-            return false;
+            return lt;
         }
 
         if (license[i] == '(') {
@@ -628,9 +907,10 @@ static bool is_valid_license(struct rpminspect *ri, struct result_params *params
     }
 
     if (balance != 0) {
-        return false;
+        return lt;
     }
 
+    lt->balanced = true;
     wlicense = strdup(license);
     assert(wlicense != NULL);
 
@@ -644,23 +924,12 @@ static bool is_valid_license(struct rpminspect *ri, struct result_params *params
      * first, loop over each db trying to match the entire tag.  this
      * is the common case.
      */
-    TAILQ_FOREACH(entry, ri->licensedb, items) {
-        /* read in this license database */
-        p = read_licensedb(ri, entry->data, &db);
-
-        if (p == NULL) {
-            continue;
-        }
-
-        /* first, try to match the entire string */
-        if (check_license_abbrev(ri, p, db, wlicense)) {
-            p->fini(db);
+    TAILQ_FOREACH(index, licdbs, items) {
+        if (check_license_abbrev(lt, index, wlicense)) {
+            lt->whole = true;
             free(wlicense);
-            return true;
+            return lt;
         }
-
-        /* close this db */
-        p->fini(db);
     }
 
     /*
@@ -670,19 +939,12 @@ static bool is_valid_license(struct rpminspect *ri, struct result_params *params
      * only want the third phase to deal with whatever is leftoveer
      * from this phase.
      */
-    TAILQ_FOREACH(entry, ri->licensedb, items) {
-        /* read in this license database */
-        p = read_licensedb(ri, entry->data, &db);
-
-        if (p == NULL) {
-            continue;
-        }
-
+    TAILQ_FOREACH(index, licdbs, items) {
         parenexps = get_paren_expressions(wlicense);
 
         if (parenexps && !TAILQ_EMPTY(parenexps)) {
             TAILQ_FOREACH(pentry, parenexps, items) {
-                if (check_license_abbrev(ri, p, db, pentry->data)) {
+                if (check_license_abbrev(lt, index, pentry->data)) {
                     xasprintf(&tmp, "(%s)", pentry->data);
                     assert(tmp != NULL);
                     nlicense = strreplace(wlicense, tmp, NULL);
@@ -694,9 +956,6 @@ static bool is_valid_license(struct rpminspect *ri, struct result_params *params
 
             list_free(parenexps, free);
         }
-
-        /* close this db */
-        p->fini(db);
     }
 
     /*
@@ -704,68 +963,107 @@ static bool is_valid_license(struct rpminspect *ri, struct result_params *params
      * step.  this is individual tag checking for whole compound
      * expressions.
      */
-    tags = tokenize_license_tag(wlicense);
+    tags = tokenize_license_tag(lt, wlicense);
 
     if (tags) {
-        TAILQ_FOREACH(pentry, ri->licensedb, items) {
-            /* read in this license database */
-            p = read_licensedb(ri, pentry->data, &db);
-
-            if (p == NULL) {
-                continue;
-            }
-
+        TAILQ_FOREACH(index, licdbs, items) {
             HASH_ITER(hh, tags, tagtoken, tmp_tagtoken) {
                 if (tagtoken->value == tagtoken->key) {
                     /* already validated */
                     continue;
                 }
 
-                if (check_license_abbrev(ri, p, db, tagtoken->key)) {
+                if (check_license_abbrev(lt, index, tagtoken->key)) {
                     /* set the value to non-NULL so we know it passed (DO NOT FREE) */
                     tagtoken->value = tagtoken->key;
                 }
             }
+        }
+
+        /* save unapproved license tag tokens */
+        HASH_ITER(hh, tags, tagtoken, tmp_tagtoken) {
+            if (tagtoken->value == NULL) {
+                lt->unapproved = list_add(lt->unapproved, tagtoken->key);
+            }
+        }
+    }
+
+    free_tags(tags);
+    free(wlicense);
+    return lt;
+}
+
+/*
+ * Report the validation results for a License tag in a package.
+ * Returns true if all license tags are approved in the database.  Any
+ * single tag that is unapproved results in false.
+ */
+static bool is_valid_license(struct rpminspect *ri, struct result_params *params, const char *nevra, const char *license)
+{
+    bool r = true;
+    string_entry_t *entry = NULL;
+    license_tag_t *lt = NULL;
 
-            /* close this db */
-            p->fini(db);
+    assert(ri != NULL);
+    assert(params != NULL);
+    assert(nevra != NULL);
+    assert(license != NULL);
+
+    /* Set up the result parameters */
+    params->severity = RESULT_BAD;
+    params->remedy = REMEDY_UNAPPROVED_LICENSE;
+
+    /* validate the tag unless another package already used it */
+    HASH_FIND_STR(license_tags, license, lt);
+
+    if (lt == NULL) {
+        lt = validate_license(license);
+    }
+
+    if (!lt->balanced) {
+        return false;
+    }
+
+    /* invalid keywords found while matching against the database */
+    if (lt->keywords) {
+        TAILQ_FOREACH(entry, lt->keywords, items) {
+            report_spdx_keyword(ri, entry->data);
         }
     }
 
+    if (lt->whole) {
+        return true;
+    }
+
     /* report unapproved license tag tokens */
-    if (tags) {
-        HASH_ITER(hh, tags, tagtoken, tmp_tagtoken) {
-            if (tagtoken->value == NULL) {
-                r = false;
+    if (lt->unapproved) {
+        TAILQ_FOREACH(entry, lt->unapproved, items) {
+            r = false;
 
-                if (ri->results == NULL) {
-                    ri->results = init_results();
-                }
+            if (ri->results == NULL) {
+                ri->results = init_results();
+            }
 
-                params->severity = RESULT_BAD;
-                params->remedy = REMEDY_UNAPPROVED_LICENSE;
-                xasprintf(&params->msg, _("Unapproved license in %s: %s"), nevra, tagtoken->key);
-                add_result(ri, params);
-                result = get_result(result, params->severity);
-                free(params->msg);
+            params->severity = RESULT_BAD;
+            params->remedy = REMEDY_UNAPPROVED_LICENSE;
+            xasprintf(&params->msg, _("Unapproved license in %s: %s"), nevra, entry->data);
+            add_result(ri, params);
+            result = get_result(result, params->severity);
+            free(params->msg);
 
-                /*
-                 * make sure to set the worst result based on queued
-                 * license inspection failures.
-                 */
-                if (params->severity > ri->worst_result) {
-                    ri->worst_result = params->severity;
-                }
+            /*
+             * make sure to set the worst result based on queued
+             * license inspection failures.
+             */
+            if (params->severity > ri->worst_result) {
+                ri->worst_result = params->severity;
             }
         }
     }
 
-    free_tags(tags);
-    free(wlicense);
-
     /* for SPDX tags found, ensure booleans are all uppercase or all lowercase */
-    if (nlegacy == 0 && ndual == 0 && nspdx > 0 && (booleans && !TAILQ_EMPTY(booleans))) {
-        TAILQ_FOREACH(entry, booleans, items) {
+    if (lt->nlegacy == 0 && lt->ndual == 0 && lt->nspdx > 0 && (lt->booleans && !TAILQ_EMPTY(lt->booleans))) {
+        TAILQ_FOREACH(entry, lt->booleans, items) {
             if ((!strcasecmp(entry->data, "AND") && strcmp(entry->data, "and") && strcmp(entry->data, "AND"))
                 || (!strcasecmp(entry->data, "OR") && strcmp(entry->data, "or") && strcmp(entry->data, "OR"))
                 || (!strcasecmp(entry->data, "WITH") && strcmp(entry->data, "with") && strcmp(entry->data, "WITH"))) {
@@ -785,7 +1083,7 @@ static bool is_valid_license(struct rpminspect *ri, struct result_params *params
     }
 
     /* mixed SPDX and legacy tags are forbidden */
-    if (nlegacy > 0 && nspdx > 0 && ndual == 0) {
+    if (lt->nlegacy > 0 && lt->nspdx > 0 && lt->ndual == 0) {
         params->severity = RESULT_BAD;
         params->remedy = REMEDY_MIXED_LICENSE_TAGS;
         xasprintf(&params->msg, _("Mixed SPDX and legacy license identifiers found in %s."), nevra);
@@ -862,14 +1160,6 @@ static int check_peer_license(struct rpminspect *ri, struct result_params *param
     }
 
     free(nevra);
-    list_free(booleans, free);
-    booleans = NULL;
-
-    /* reset the abbreviation counters for the next package */
-    nlegacy = 0;
-    ndual = 0;
-    nspdx = 0;
-
     return ret;
 }
 
@@ -888,9 +1178,6 @@ bool inspect_license(struct rpminspect *ri)
     int good = 0;
     int seen = 0;
     rpmpeer_entry_t *peer = NULL;
-    parser_plugin *p = NULL;
-    parser_context *db = NULL;
-    string_entry_t *entry = NULL;
     struct result_params params;
 
     assert(ri != NULL);
@@ -927,20 +1214,8 @@ bool inspect_license(struct rpminspect *ri)
         }
     }
 
-    /* Gather all of the dual SPDX/legacy license expressions */
-    TAILQ_FOREACH(entry, ri->licensedb, items) {
-        /* read in this license database */
-        p = read_licensedb(ri, entry->data, &db);
-
-        if (p == NULL) {
-            continue;
-        }
-
-        gather_dual_licenses(ri, p, db);
-
-        /* close this db */
-        p->fini(db);
-    }
+    /* indexes are built on first use and kept, see load_license_index() */
+    load_license_index(ri);
 
     /*
      * The license test just looks at the licenses on the after build
@@ -967,6 +1242,9 @@ bool inspect_license(struct rpminspect *ri)
         result = get_result(result, params.severity);
     }
 
-    list_free(dual, free);
+    /* validated tags depend on the SRPM, the indexes do not */
+    free_license_tags();
+    srpm = NULL;
+
     return result;
 }
@@ -261,27 +261,39 @@ end:
     return error_buffer;
 }
 
-static bool manpage_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+/*
+ * Returns true if the file is a man page this inspection should look
+ * at.  Also used during extraction to only unpack man pages.
+ */
+bool is_manpage_file(struct rpminspect *ri, const rpmfile_entry_t *file)
 {
-    int r = 0;
-    char *uncompressed_man_page = NULL;
-    struct stat sb;
-    char *manpage_errors;
-    bool result = true;
-    const char *pkg = NULL;
-    struct result_params params;
+    assert(ri != NULL);
+    assert(file != NULL);
 
     /* Skip source packages */
     if (headerIsSource(file->rpm_header)) {
-        return true;
+        return false;
     }
 
     /* Is this a man page? */
     if (!file->fullpath || !S_ISREG(file->st_mode)) {
-        return true;
+        return false;
     }
 
-    if (!process_file_path(file, ri->manpage_path_include, ri->manpage_path_exclude)) {
+    return process_file_path(file, ri->manpage_path_include, ri->manpage_path_exclude);
+}
+
+static bool manpage_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+{
+    int r = 0;
+    char *uncompressed_man_page = NULL;
+    struct stat sb;
+    char *manpage_errors;
+    bool result = true;
+    const char *pkg = NULL;
+    struct result_params params;
+
+    if (!is_manpage_file(ri, file)) {
         return true;
     }
 
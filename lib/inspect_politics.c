@@ -7,30 +7,133 @@
 #include <assert.h>
 #include <fnmatch.h>
 #include <err.h>
+#include <string.h>
 #include <openssl/md5.h>
 #include <openssl/sha.h>
 #include "rpminspect.h"
 
+/*
+ * Characters that end the literal part of a pattern.  Backslash escapes
+ * are allowed in the politics file and the extended patterns start with
+ * one of '+', '@', or '!' in addition to the usual wildcards.
+ */
+#define PATTERN_CHARS "*?[\\+@!"
+
+/* a politics entry compiled for matching */
+typedef struct _politics_rule_t {
+    const char *pattern;
+    size_t prefix;
+    const char *digest;         /* NULL for wildcard entries */
+    int type;
+    bool allowed;
+} politics_rule_t;
+
+static politics_rule_t *rules = NULL;
+static size_t num_rules = 0;
+static int fnmatch_flags = FNM_PERIOD;
+
+/*
+ * Return the checksum type of a digest string from its length, or
+ * NULLSUM if the length does not match a supported digest.
+ */
+static int get_digest_type(const char *digest)
+{
+    size_t len = strlen(digest);
+
+    if (len == (MD5_DIGEST_LENGTH * 2)) {
+        return MD5SUM;
+    } else if (len == (SHA_DIGEST_LENGTH * 2)) {
+        return SHA1SUM;
+    } else if (len == (SHA224_DIGEST_LENGTH * 2)) {
+        return SHA224SUM;
+    } else if (len == (SHA256_DIGEST_LENGTH * 2)) {
+        return SHA256SUM;
+    } else if (len == (SHA384_DIGEST_LENGTH * 2)) {
+        return SHA384SUM;
+    } else if (len == (SHA512_DIGEST_LENGTH * 2)) {
+        return SHA512SUM;
+    }
+
+    return NULLSUM;
+}
+
+/*
+ * Compile the politics list once for the whole run.  Malformed entries
+ * and entries with an unknown digest type are reported here once rather
+ * than for every file.
+ */
+static void compile_politics(struct rpminspect *ri)
+{
+    politics_entry_t *pentry = NULL;
+    politics_rule_t *rule = NULL;
+    size_t n = 0;
+    int type = NULLSUM;
+
+    assert(ri != NULL);
+
+#ifdef FNM_EXTMATCH
+    /* glibc provides this extended pattern matching syntax */
+    fnmatch_flags |= FNM_EXTMATCH;
+#endif
+
+    TAILQ_FOREACH(pentry, ri->politics, items) {
+        n++;
+    }
+
+    if (n == 0) {
+        return;
+    }
+
+    rules = xalloc(n * sizeof(*rules));
+    num_rules = 0;
+
+    TAILQ_FOREACH(pentry, ri->politics, items) {
+        /* malformatted lines */
+        if (pentry->pattern == NULL || pentry->digest == NULL) {
+            warnx(_("*** invalid politics entry with pattern=%s and digest=%s"), pentry->pattern, pentry->digest);
+            continue;
+        }
+
+        if (!strcmp(pentry->digest, "*")) {
+            type = NULLSUM;
+        } else {
+            type = get_digest_type(pentry->digest);
+
+            if (type == NULLSUM) {
+                warnx(_("*** unknown digest type for pattern %s: %s"), pentry->pattern, pentry->digest);
+                continue;
+            }
+        }
+
+        rule = &rules[num_rules++];
+        rule->pattern = pentry->pattern;
+        rule->prefix = strcspn(pentry->pattern, PATTERN_CHARS);
+        rule->digest = (type == NULLSUM) ? NULL : pentry->digest;
+        rule->type = type;
+        rule->allowed = pentry->allowed;
+    }
+
+    return;
+}
+
 static bool politics_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
     bool result = true;
-    politics_entry_t *pentry = NULL;
-    int type = 0;
-    char *digest = NULL;
+    politics_rule_t *rule = NULL;
+    size_t i = 0;
+    char *digests[SHA512SUM + 1] = { NULL };
+    bool wildcard_matched = false;
+    bool wildcard_allowed = false;
+    bool digest_matched = false;
+    bool digest_allowed = false;
     bool matched = false;
     bool allowed = false;
-    int flags = FNM_PERIOD;
     const char *name = NULL;
     struct result_params params;
 
     assert(ri != NULL);
     assert(file != NULL);
 
-#ifdef FNM_EXTMATCH
-    /* glibc provides this extended pattern matching syntax */
-    flags |= FNM_EXTMATCH;
-#endif
-
     /* special files and directories can be skipped */
     if (S_ISDIR(file->st_mode) ||
         S_ISCHR(file->st_mode) ||
@@ -40,76 +143,59 @@ static bool politics_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
-    /* first pass handles the wildcard entries and sees if we have a match */
-    TAILQ_FOREACH(pentry, ri->politics, items) {
-        /* malformatted lines */
-        if (pentry->pattern == NULL || pentry->digest == NULL) {
-            warnx(_("*** invalid politics entry with pattern=%s and digest=%s"), pentry->pattern, pentry->digest);
-            continue;
-        }
+    /*
+     * Check every rule in one pass.  The last matching entry in the
+     * file takes effect, but a digest entry match always overrides a
+     * wildcard entry match.  Each digest type is computed at most once
+     * per file and the default one comes from the file's cached
+     * checksum.
+     */
+    for (i = 0; i < num_rules; i++) {
+        rule = &rules[i];
 
-        /* if we are not looking at a wildcard line, skip */
-        if (strcmp(pentry->digest, "*")) {
+        if (strncmp(file->localpath, rule->pattern, rule->prefix)) {
             continue;
         }
 
-        /* the last entry in the file will take effect here */
-        if (!fnmatch(pentry->pattern, file->localpath, flags)) {
-            matched = true;
-            allowed = pentry->allowed;
-        }
-    }
-
-    /* look for entries */
-    TAILQ_FOREACH(pentry, ri->politics, items) {
-        /* malformatted lines */
-        if (pentry->pattern == NULL || pentry->digest == NULL) {
-            warnx(_("*** invalid politics entry with pattern=%s and digest=%s"), pentry->pattern, pentry->digest);
+        if (fnmatch(rule->pattern, file->localpath, fnmatch_flags)) {
             continue;
         }
 
-        /* if we are looking at a wildcard line, skip */
-        if (!strcmp(pentry->digest, "*")) {
+        if (rule->digest == NULL) {
+            wildcard_matched = true;
+            wildcard_allowed = rule->allowed;
             continue;
         }
 
-        /* the last entry in the file will take effect here */
-        if (!fnmatch(pentry->pattern, file->localpath, flags)) {
-            /* get the type of digest string */
-            if (strlen(pentry->digest) == (MD5_DIGEST_LENGTH * 2)) {
-                type = MD5SUM;
-            } else if (strlen(pentry->digest) == (SHA_DIGEST_LENGTH * 2)) {
-                type = SHA1SUM;
-            } else if (strlen(pentry->digest) == (SHA224_DIGEST_LENGTH * 2)) {
-                type = SHA224SUM;
-            } else if (strlen(pentry->digest) == (SHA256_DIGEST_LENGTH * 2)) {
-                type = SHA256SUM;
-            } else if (strlen(pentry->digest) == (SHA384_DIGEST_LENGTH * 2)) {
-                type = SHA384SUM;
-            } else if (strlen(pentry->digest) == (SHA512_DIGEST_LENGTH * 2)) {
-                type = SHA512SUM;
+        if (digests[rule->type] == NULL) {
+            if (rule->type == DEFAULT_MESSAGE_DIGEST) {
+                digests[rule->type] = checksum(file);
             } else {
-                warnx(_("*** unknown digest type for pattern %s: %s"), pentry->pattern, pentry->digest);
-                continue;
+                digests[rule->type] = compute_checksum(file->fullpath, &file->st_mode, rule->type);
             }
+        }
 
-            /* get the digest */
-            if (type == DEFAULT_MESSAGE_DIGEST && !strcmp(pentry->digest, checksum(file))) {
-                matched = true;
-                allowed = pentry->allowed;
-            } else {
-                digest = compute_checksum(file->fullpath, &file->st_mode, type);
-
-                if (!strcmp(pentry->digest, digest)) {
-                    matched = true;
-                    allowed = pentry->allowed;
-                }
+        if (digests[rule->type] && !strcmp(rule->digest, digests[rule->type])) {
+            digest_matched = true;
+            digest_allowed = rule->allowed;
+        }
+    }
 
-                free(digest);
-            }
+    /* the default digest is owned by the file entry */
+    for (i = 0; i <= SHA512SUM; i++) {
+        if (i != DEFAULT_MESSAGE_DIGEST) {
+            free(digests[i]);
         }
     }
 
+    if (digest_matched) {
+        matched = true;
+        allowed = digest_allowed;
+    } else if (wildcard_matched) {
+        matched = true;
+        allowed = wildcard_allowed;
+    }
+
     /* report */
     if (matched) {
         /* use the package name for reporting */
@@ -156,7 +242,11 @@ bool inspect_politics(struct rpminspect *ri)
 
     /* run the politics check on each file */
     if (init_politics(ri)) {
+        compile_politics(ri);
         result = foreach_peer_file(ri, NAME_POLITICS, politics_driver);
+        free(rules);
+        rules = NULL;
+        num_rules = 0;
     }
 
     /* hope the result is always this */
@@ -18,9 +18,11 @@
 
 /*
  * Called by udevrules_driver() to determine if a found file is one
- * we want to look at.  Returns true if it is, false otherwise.
+ * we want to look at.  Returns true if it is, false otherwise.  Also
+ * used during extraction to only unpack the files this inspection
+ * reads.
  */
-static bool is_udev_rules_file(struct rpminspect *ri, const rpmfile_entry_t *file)
+bool is_udev_rules_file(struct rpminspect *ri, const rpmfile_entry_t *file)
 {
     string_entry_t *entry = NULL;
 
@@ -60,7 +62,7 @@ static char *run_udevadm_verify(int *exitcode, const struct rpminspect *ri, cons
     assert(ri != NULL);
     assert(arg != NULL);
 
-    return run_cmd(exitcode, ri->worksubdir, ri->commands.udevadm, "verify", "--no-summary", "--no-style", "--resolve-names=never", arg, NULL);
+    return cached_run_cmd(ri, exitcode, ri->worksubdir, ri->commands.udevadm, "verify", "--no-summary", "--no-style", "--resolve-names=never", arg, NULL);
 }
 
 static bool udevrules_driver(struct rpminspect *ri, rpmfile_entry_t *file)
@@ -149,7 +149,7 @@ bool inspect_upstream(struct rpminspect *ri)
     assert(name != NULL);
 
     /* Set result type based on version difference */
-    if (is_rebase(ri) || (init_rebaseable(ri) && list_contains(ri->rebaseable, name))) {
+    if (is_rebase(ri) || is_rebaseable(ri, name)) {
         /* versions changed */
         params.severity = RESULT_INFO;
         params.waiverauth = NOT_WAIVABLE;
@@ -8,12 +8,14 @@
 #include <assert.h>
 #include <err.h>
 #include <dirent.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <clamav.h>
 #include "rpminspect.h"
 #include "parallel.h"
 
 static struct cl_engine *engine = NULL;
+static struct cl_stat dbstat;   /* databases the engine was loaded from */
 #ifndef CL_SCAN_STDOPT
 struct cl_scan_options clamav_opts;
 #endif
@@ -208,6 +210,131 @@ static bool virus_driver(struct rpminspect *ri __attribute__((unused)), rpmfile_
     return true;
 }
 
+/*
+ * Create the clamav engine and load the databases.  This is the most
+ * expensive part of the inspection, so the engine is only freed by
+ * free_virus_engine() when the program is done with it.
+ */
+static void load_engine(const char *dbpath)
+{
+    int r = 0;
+    unsigned int loaded_signatures; /* unused, exists to make cl_load() happy */
+
+    assert(dbpath != NULL);
+
+    /* initialize clamav engine */
+    engine = cl_engine_new();
+
+    if (engine == NULL) {
+        errx(RI_PROGRAM_ERROR, _("*** cl_engine_new returned NULL, check clamav library"));
+    }
+
+    /* scan large files, but dump error as warning if this doesn't work */
+    r = cl_engine_set_num(engine, CL_ENGINE_MAX_FILESIZE, 0);
+
+    if (r != CL_SUCCESS) {
+        warnx("*** cl_engine_set_num: %s", cl_strerror(r));
+    }
+
+    r = cl_engine_set_num(engine, CL_ENGINE_MAX_SCANSIZE, 0);
+
+    if (r != CL_SUCCESS) {
+        warnx("*** cl_engine_set_num: %s", cl_strerror(r));
+    }
+
+    /* load clamav databases */
+    r = cl_load(dbpath, engine, &loaded_signatures, CL_DB_STDOPT);
+
+    if (r != CL_SUCCESS) {
+        cl_engine_free(engine);
+        errx(RI_PROGRAM_ERROR, "*** cl_load: %s", cl_strerror(r));
+    }
+
+    /* set up callbacks for tracking infected files within archives */
+    cl_engine_set_clcb_file_inspection(engine, file_inspection_callback);
+    cl_engine_set_clcb_virus_found(engine, virus_found_callback);
+
+    /* compile engine */
+    r = cl_engine_compile(engine);
+
+    if (r != CL_SUCCESS) {
+        cl_engine_free(engine);
+        errx(RI_PROGRAM_ERROR, "*** cl_engine_compile: %s", cl_strerror(r));
+    }
+
+    /* remember the databases so refresh_virus_engine() can spot updates */
+    memset(&dbstat, 0, sizeof(dbstat));
+    r = cl_statinidir(dbpath, &dbstat);
+
+    if (r != CL_SUCCESS) {
+        warnx("*** cl_statinidir: %s", cl_strerror(r));
+    }
+
+    return;
+}
+
+/*
+ * Free the clamav engine if it was loaded.
+ */
+void free_virus_engine(void)
+{
+    if (engine != NULL) {
+        cl_engine_free(engine);
+        cl_statfree(&dbstat);
+        engine = NULL;
+    }
+
+    return;
+}
+
+/*
+ * Load the engine again if the databases changed since it was loaded,
+ * for example when freshclam updated them while the --serve mode or
+ * a batch mode run kept the engine loaded.
+ */
+void refresh_virus_engine(void)
+{
+    if (engine == NULL || cl_statchkdir(&dbstat) != 1) {
+        return;
+    }
+
+    free_virus_engine();
+
+    if (access(cl_retdbdir(), R_OK) == 0) {
+        load_engine(cl_retdbdir());
+    }
+
+    return;
+}
+
+/*
+ * Initialize clamav and load the engine ahead of time.  The --serve
+ * mode calls this once so jobs forked from the server skip loading
+ * the databases.
+ */
+void preload_virus_engine(void)
+{
+    int r = 0;
+
+    if (engine != NULL) {
+        return;
+    }
+
+    r = cl_init(CL_INIT_DEFAULT);
+
+    if (r != CL_SUCCESS) {
+        warnx("*** cl_init: %s", cl_strerror(r));
+        return;
+    }
+
+    /* without databases the inspection reports the problem when it runs */
+    if (access(cl_retdbdir(), R_OK) == 0) {
+        load_engine(cl_retdbdir());
+    }
+
+    return;
+}
+
 bool inspect_virus(struct rpminspect *ri)
 {
     char *dbver = NULL;
@@ -218,7 +345,6 @@ bool inspect_virus(struct rpminspect *ri)
     struct cl_cvd *cvd = NULL;
     int r = 0;
     struct result_params params;
-    unsigned int loaded_signatures; /* unused, exists to make cl_load() happy */
 
     /* initialize clamav */
     r = cl_init(CL_INIT_DEFAULT);
@@ -291,44 +417,11 @@ bool inspect_virus(struct rpminspect *ri)
         warn("*** closedir");
     }
 
-    /* initialize clamav engine */
-    engine = cl_engine_new();
+    /* the engine is kept loaded between batch mode comparisons and preloaded by --serve */
+    refresh_virus_engine();
 
     if (engine == NULL) {
-        errx(RI_PROGRAM_ERROR, _("*** cl_engine_new returned NULL, check clamav library"));
-    }
-
-    /* scan large files, but dump error as warning if this doesn't work */
-    r = cl_engine_set_num(engine, CL_ENGINE_MAX_FILESIZE, 0);
-
-    if (r != CL_SUCCESS) {
-        warnx("*** cl_engine_set_num: %s", cl_strerror(r));
-    }
-
-    r = cl_engine_set_num(engine, CL_ENGINE_MAX_SCANSIZE, 0);
-
-    if (r != CL_SUCCESS) {
-        warnx("*** cl_engine_set_num: %s", cl_strerror(r));
-    }
-
-    /* load clamav databases */
-    r = cl_load(dbpath, engine, &loaded_signatures, CL_DB_STDOPT);
-
-    if (r != CL_SUCCESS) {
-        cl_engine_free(engine);
-        errx(RI_PROGRAM_ERROR, "*** cl_load: %s", cl_strerror(r));
-    }
-
-    /* set up callbacks for tracking infected files within archives */
-    cl_engine_set_clcb_file_inspection(engine, file_inspection_callback);
-    cl_engine_set_clcb_virus_found(engine, virus_found_callback);
-
-    /* compile engine */
-    r = cl_engine_compile(engine);
-
-    if (r != CL_SUCCESS) {
-        cl_engine_free(engine);
-        errx(RI_PROGRAM_ERROR, "*** cl_engine_compile: %s", cl_strerror(r));
+        load_engine(dbpath);
     }
 
 #ifndef CL_SCAN_STDOPT
@@ -501,9 +594,5 @@ bool inspect_virus(struct rpminspect *ri)
         add_result(ri, &params);
     }
 
-    /* clean up */
-    cl_engine_free(engine);
-    engine = NULL;
-
     return result;
 }
@@ -172,23 +172,36 @@ static bool is_xml(const char *path)
     return (bytes_read >= min_size) && (memcmp(xml_data, xml_prelude, min_size) == 0);
 }
 
-static bool xml_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+/*
+ * Returns true if the file may be an XML file this inspection should
+ * look at.  The contents are checked later by is_xml(), this is also
+ * used during extraction to only unpack candidate files.
+ */
+bool is_xml_candidate(struct rpminspect *ri, const rpmfile_entry_t *file)
 {
-    bool result = true;
-    const char *pkg = NULL;
-    struct result_params params;
+    assert(ri != NULL);
+    assert(file != NULL);
 
     /* Skip source packages */
     if (headerIsSource(file->rpm_header)) {
-        return true;
+        return false;
     }
 
     /* Is this an XML file? */
     if (!file->fullpath || !S_ISREG(file->st_mode)) {
-        return true;
+        return false;
     }
 
-    if (!process_file_path(file, ri->xml_path_include, ri->xml_path_exclude)) {
+    return process_file_path(file, ri->xml_path_include, ri->xml_path_exclude);
+}
+
+static bool xml_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+{
+    bool result = true;
+    const char *pkg = NULL;
+    struct result_params params;
+
+    if (!is_xml_candidate(ri, file)) {
         return true;
     }
 
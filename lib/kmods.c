@@ -286,24 +286,171 @@ void free_module_aliases(kernel_alias_data_t *data)
     return;
 }
 
-static string_list_t *wildcard_alias_search(const char *alias, kernel_alias_data_t *data)
+/*
+ * Characters that end the literal part of an alias pattern for
+ * fnmatch(3) with no flags.
+ */
+#define ALIAS_PATTERN_CHARS "*?[\\"
+
+/* an after alias hanging off a trie node */
+typedef struct _alias_ref_t {
+    size_t pos;                   /* position in the alias hash table */
+    kernel_alias_data_t *kentry;
+    struct _alias_ref_t *next;
+} alias_ref_t;
+
+/*
+ * Trie of after aliases keyed on the literal prefix before the first
+ * wildcard.  Each alias is stored at the node for its prefix, so the
+ * only aliases that can match a string are the ones stored along the
+ * path the string takes through the trie.
+ */
+typedef struct _alias_trie_t {
+    char c;
+    alias_ref_t *aliases;
+    alias_ref_t *last;
+    struct _alias_trie_t *child;
+    struct _alias_trie_t *sibling;
+} alias_trie_t;
+
+static alias_trie_t *build_alias_trie(kernel_alias_data_t *data)
 {
-    string_list_t *r = NULL;
-    string_entry_t *iter = NULL;
+    alias_trie_t *root = NULL;
+    alias_trie_t *node = NULL;
+    alias_trie_t *next = NULL;
+    alias_ref_t *ref = NULL;
     kernel_alias_data_t *kentry = NULL;
     kernel_alias_data_t *tmp_kentry = NULL;
+    size_t pos = 0;
+    size_t prefix = 0;
+    size_t i = 0;
 
-    assert(alias != NULL);
-    assert(data != NULL);
+    root = xalloc(sizeof(*root));
 
     HASH_ITER(hh, data, kentry, tmp_kentry) {
-        if (fnmatch(kentry->alias, alias, 0) == 0) {
-            TAILQ_FOREACH(iter, kentry->modules, items) {
-                r = list_add(r, iter->data);
+        node = root;
+        prefix = strcspn(kentry->alias, ALIAS_PATTERN_CHARS);
+
+        for (i = 0; i < prefix; i++) {
+            for (next = node->child; next != NULL; next = next->sibling) {
+                if (next->c == kentry->alias[i]) {
+                    break;
+                }
+            }
+
+            if (next == NULL) {
+                next = xalloc(sizeof(*next));
+                next->c = kentry->alias[i];
+                next->sibling = node->child;
+                node->child = next;
+            }
+
+            node = next;
+        }
+
+        ref = xalloc(sizeof(*ref));
+        ref->pos = pos++;
+        ref->kentry = kentry;
+
+        if (node->last == NULL) {
+            node->aliases = ref;
+        } else {
+            node->last->next = ref;
+        }
+
+        node->last = ref;
+    }
+
+    return root;
+}
+
+static void free_alias_trie(alias_trie_t *node)
+{
+    alias_trie_t *sibling = NULL;
+    alias_ref_t *ref = NULL;
+
+    while (node != NULL) {
+        free_alias_trie(node->child);
+
+        while (node->aliases != NULL) {
+            ref = node->aliases;
+            node->aliases = ref->next;
+            free(ref);
+        }
+
+        sibling = node->sibling;
+        free(node);
+        node = sibling;
+    }
+
+    return;
+}
+
+static int alias_ref_cmp(const void *a, const void *b)
+{
+    const alias_ref_t *x = *(alias_ref_t * const *) a;
+    const alias_ref_t *y = *(alias_ref_t * const *) b;
+
+    return (x->pos > y->pos) - (x->pos < y->pos);
+}
+
+/*
+ * Return the modules of every after alias matching the given alias.
+ * The modules are listed in the order of the after alias hash table.
+ */
+static string_list_t *wildcard_alias_search(const char *alias, alias_trie_t *trie)
+{
+    string_list_t *r = NULL;
+    string_entry_t *iter = NULL;
+    alias_trie_t *node = trie;
+    alias_ref_t *ref = NULL;
+    alias_ref_t **matches = NULL;
+    size_t nmatches = 0;
+    size_t size = 0;
+    size_t i = 0;
+    const char *s = alias;
+
+    assert(alias != NULL);
+    assert(trie != NULL);
+
+    while (node != NULL) {
+        for (ref = node->aliases; ref != NULL; ref = ref->next) {
+            if (fnmatch(ref->kentry->alias, alias, 0) != 0) {
+                continue;
+            }
+
+            if (nmatches == size) {
+                size = (size == 0) ? 8 : size * 2;
+                matches = xrealloc(matches, size * sizeof(*matches));
+            }
+
+            matches[nmatches++] = ref;
+        }
+
+        if (*s == '\0') {
+            break;
+        }
+
+        for (node = node->child; node != NULL; node = node->sibling) {
+            if (node->c == *s) {
+                break;
             }
         }
+
+        s++;
     }
 
+    if (nmatches > 1) {
+        qsort(matches, nmatches, sizeof(*matches), alias_ref_cmp);
+    }
+
+    for (i = 0; i < nmatches; i++) {
+        TAILQ_FOREACH(iter, matches[i]->kentry->modules, items) {
+            r = list_add(r, iter->data);
+        }
+    }
+
+    free(matches);
     return r;
 }
 
@@ -320,13 +467,14 @@ static string_list_t *wildcard_alias_search(const char *alias, kernel_alias_data
  * "pci:v00001425d00000020sv*sd*bc*sc*i*". The after string still
  * matches the before string, so this is not a regression.
  *
- * However, since matching up module aliases does involve
- * arbitrary-length wildcards, this function effectively needs to run
- * fnmatch() between every combination of before and after aliases,
- * resulting in a complexity of O(n^2).  To speed things up in the
+ * Matching up module aliases involves arbitrary-length wildcards, so
+ * in the worst case every before alias has to be run through
+ * fnmatch() against every after alias.  To speed things up in the
  * (hopefully) usual case, the wildcard search is only run when an
  * exact string match of an alias (using hash tables) results in an
- * apparent regression.
+ * apparent regression.  The after aliases are then put in a trie
+ * keyed on the literal text before their first wildcard so a search
+ * only tries the aliases whose prefix matches.
  */
 bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *after, module_alias_callback callback, void *user_data)
 {
@@ -337,6 +485,7 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
     string_list_t *after_modules = NULL;
     string_list_t *difference = NULL;
     string_list_t empty;
+    alias_trie_t *trie = NULL;
     bool wildcard_search = false;
     bool result = true;
 
@@ -370,7 +519,11 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
 
         /* No match found, do a wildcard search */
         if (after_entry == NULL) {
-            after_modules = wildcard_alias_search(iter->alias, after);
+            if (trie == NULL) {
+                trie = build_alias_trie(after);
+            }
+
+            after_modules = wildcard_alias_search(iter->alias, trie);
             wildcard_search = true;
         } else {
             after_modules = after_entry->modules;
@@ -378,7 +531,11 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
 
             /* If the lists differ, do a wildcard search */
             if (difference != NULL && !TAILQ_EMPTY(difference)) {
-                after_modules = wildcard_alias_search(iter->alias, after);
+                if (trie == NULL) {
+                    trie = build_alias_trie(after);
+                }
+
+                after_modules = wildcard_alias_search(iter->alias, trie);
                 wildcard_search = true;
             }
 
@@ -401,5 +558,6 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
         list_free(difference, NULL);
     }
 
+    free_alias_trie(trie);
     return result;
 }
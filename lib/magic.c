@@ -10,11 +10,50 @@
 #include <magic.h>
 
 #include "rpminspect.h"
+#include "internal/probes.h"
+
+/* cookie loaded ahead of time by preload_magic() */
+static magic_t warm_cookie = NULL;
+
+/*
+ * Open and load the magic database before any run is set up.  Used by
+ * the --serve mode so every job forked from the server starts with the
+ * database already loaded.
+ */
+void preload_magic(void)
+{
+    if (warm_cookie != NULL) {
+        return;
+    }
+
+    warm_cookie = magic_open(MAGIC_MIME | MAGIC_CHECK);
+
+    if (warm_cookie == NULL) {
+        warnx(_("*** unable to initialize the magic library"));
+        return;
+    }
+
+    if (magic_load(warm_cookie, NULL) != 0) {
+        warnx(_("*** unable to load the magic database: %s"), magic_error(warm_cookie));
+        magic_close(warm_cookie);
+        warm_cookie = NULL;
+    }
+
+    return;
+}
 
 static void init_magic_cookie(struct rpminspect *ri)
 {
     assert(ri != NULL);
 
+    /* a preloaded cookie is handed over to this run */
+    if (warm_cookie != NULL) {
+        ri->magic_cookie = warm_cookie;
+        ri->magic_initialized = true;
+        warm_cookie = NULL;
+        return;
+    }
+
     ri->magic_cookie = magic_open(MAGIC_MIME | MAGIC_CHECK);
 
     if (ri->magic_cookie == NULL) {
@@ -56,7 +95,9 @@ const char *mime_type(struct rpminspect *ri, const char *file)
     }
 
     /* get the type and see if it needs to be saved */
+    RI_PROBE1(mime__start, file);
     tmp = magic_file(ri->magic_cookie, file);
+    RI_PROBE2(mime__done, file, tmp);
 
     if (tmp) {
         type = strdup(tmp);
@@ -4,6 +4,13 @@
  */
 
 #include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <err.h>
+#include <sys/stat.h>
+#include "queue.h"
 #include "rpminspect.h"
 
 /*
@@ -33,3 +40,303 @@ const char *format_desc(unsigned int format)
             return NULL;
     }
 }
+
+/*
+ * Start a results writer for the given format that can write results
+ * as they are added rather than all at once at the end of the run.
+ * Returns NULL if the format is not written this way.  dest is the
+ * output file or NULL for stdout.  Nothing is written, and the output
+ * file is not created, until there are results that are not
+ * suppressed.  The output goes straight to dest, so an existing file
+ * keeps its mode, owner, and ACLs, symlinks such as /dev/stdout are
+ * followed, and a long run can be followed as it writes.
+ */
+output_stream_t *open_output_stream(const int format, const char *dest, const severity_t threshold, const severity_t suppress)
+{
+    output_stream_t *stream = NULL;
+
+    if (format != FORMAT_JSON && format != FORMAT_XUNIT) {
+        return NULL;
+    }
+
+    stream = xalloc(sizeof(*stream));
+    stream->format = format;
+    stream->threshold = threshold;
+    stream->suppress = suppress;
+    stream->start = -1;
+
+    if (dest != NULL) {
+        stream->dest = strdup(dest);
+        assert(stream->dest != NULL);
+    }
+
+    return stream;
+}
+
+/* Open the destination the first time something is written to it */
+static bool open_stream_dest(output_stream_t *stream)
+{
+    struct stat sb;
+
+    assert(stream != NULL);
+
+    if (stream->fp != NULL) {
+        return true;
+    }
+
+    if (stream->failed) {
+        return false;
+    }
+
+    /* default to stdout unless a filename was specified */
+    if (stream->dest == NULL) {
+        stream->fp = stdout;
+    } else {
+        stream->fp = fopen(stream->dest, "w");
+
+        if (stream->fp == NULL) {
+            warn(_("*** error opening %s for writing"), stream->dest);
+            stream->failed = true;
+            return false;
+        }
+    }
+
+    /*
+     * Only a regular file can be written again, and only from where
+     * this document starts in case stdout already has other output.
+     */
+    if (fstat(fileno(stream->fp), &sb) == 0 && S_ISREG(sb.st_mode)) {
+        stream->start = ftello(stream->fp);
+    }
+
+    return true;
+}
+
+/*
+ * True if what was written so far can be discarded and written again.
+ * xUnit test cases are held until the end and a destination that was
+ * not opened has nothing in it, otherwise it must be a regular file.
+ */
+static bool can_rewrite(const output_stream_t *stream)
+{
+    assert(stream != NULL);
+    return (stream->format == FORMAT_XUNIT || stream->fp == NULL || stream->start != -1);
+}
+
+/*
+ * Write every result from first on that has the same header as first.
+ * The results of an inspection are written as one group even if other
+ * results were added in between.
+ */
+static void write_stream_group(output_stream_t *stream, const results_t *results, const results_entry_t *first)
+{
+    const results_entry_t *result = NULL;
+
+    assert(stream != NULL);
+    assert(first != NULL);
+
+    stream->headers = list_add(stream->headers, first->header);
+    stream->tests++;
+
+    for (result = first; result != NULL; result = TAILQ_NEXT(result, items)) {
+        if (result->severity >= stream->threshold && !strcmp(result->header, first->header)) {
+            stream->failures++;
+        }
+    }
+
+    /* suppressed inspections are not written at all */
+    if (suppressed_results(results, first->header, stream->suppress)) {
+        return;
+    }
+
+    if (stream->format == FORMAT_JSON && open_stream_dest(stream)) {
+        json_stream_group(stream, first);
+    } else if (stream->format == FORMAT_XUNIT && !stream->failed) {
+        /* the totals go first in the output, hold the test cases until the end */
+        if (stream->body == NULL) {
+            stream->body = tmpfile();
+
+            if (stream->body == NULL) {
+                warn("*** tmpfile");
+                stream->failed = true;
+                return;
+            }
+        }
+
+        for (result = first; result != NULL; result = TAILQ_NEXT(result, items)) {
+            if (!strcmp(result->header, first->header)) {
+                xunit_stream_result(stream, result);
+            }
+        }
+    }
+
+    stream->groups++;
+    return;
+}
+
+/* The first result with the given header */
+static const results_entry_t *first_result(const results_t *results, const char *header)
+{
+    const results_entry_t *result = NULL;
+
+    TAILQ_FOREACH(result, results, items) {
+        if (!strcmp(result->header, header)) {
+            return result;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Write the groups of the results added since the last call.  The
+ * diagnostics get results at the start and at the end of a run, such
+ * as the timings from -m, so they are held until closing is true.  An
+ * inspection that was written and gets more results makes the writer
+ * write everything again when it is closed, or if the destination
+ * cannot be written again, has the new results written as another
+ * group under the same name.
+ */
+static void write_stream_results(output_stream_t *stream, const results_t *results, const bool closing)
+{
+    int r = 0;
+    string_list_t *written = NULL;
+    const results_entry_t *first = NULL;
+    const results_entry_t *result = NULL;
+
+    assert(stream != NULL);
+
+    if (results == NULL || stream->rewrite) {
+        return;
+    }
+
+    first = (stream->last == NULL) ? TAILQ_FIRST(results) : TAILQ_NEXT(stream->last, items);
+
+    if (first != NULL) {
+        stream->last = TAILQ_LAST(results, results_s);
+    }
+
+    for (result = first; result != NULL && can_rewrite(stream); result = TAILQ_NEXT(result, items)) {
+        if (list_contains(stream->headers, result->header)) {
+            stream->rewrite = true;
+            return;
+        }
+    }
+
+    for (result = first; result != NULL; result = TAILQ_NEXT(result, items)) {
+        if (list_contains(written, result->header)) {
+            continue;
+        }
+
+        written = list_add(written, result->header);
+
+        if (strcmp(result->header, NAME_DIAGNOSTICS)) {
+            write_stream_group(stream, results, result);
+        } else if (closing) {
+            /* the held results come before this call's */
+            write_stream_group(stream, results, first_result(results, NAME_DIAGNOSTICS));
+        }
+    }
+
+    list_free(written, free);
+
+    /* held diagnostics without new results, or with results moved up among them */
+    if (closing && !list_contains(stream->headers, NAME_DIAGNOSTICS) && (result = first_result(results, NAME_DIAGNOSTICS)) != NULL) {
+        write_stream_group(stream, results, result);
+    }
+
+    if (stream->fp != NULL) {
+        r = fflush(stream->fp);
+        assert(r == 0);
+    }
+
+    return;
+}
+
+/*
+ * Write out every result added since the last call.  The results of
+ * each inspection are written together, so only call this when the
+ * inspections that added results since the last call have finished.
+ */
+void write_output_stream(output_stream_t *stream, const results_t *results)
+{
+    assert(stream != NULL);
+
+    write_stream_results(stream, results, false);
+    return;
+}
+
+/* Discard everything written so far so the results can be written again */
+static void restart_output_stream(output_stream_t *stream)
+{
+    assert(stream != NULL);
+    assert(can_rewrite(stream));
+
+    list_free(stream->headers, free);
+    stream->headers = NULL;
+    stream->last = NULL;
+    stream->header = NULL;
+    stream->rewrite = false;
+    stream->groups = 0;
+    stream->count = 0;
+    stream->tests = 0;
+    stream->failures = 0;
+
+    if (stream->body != NULL) {
+        fclose(stream->body);
+        stream->body = NULL;
+    }
+
+    if (stream->fp != NULL && stream->format == FORMAT_JSON && (fflush(stream->fp) != 0 || ftruncate(fileno(stream->fp), stream->start) == -1 || fseeko(stream->fp, stream->start, SEEK_SET) == -1)) {
+        warn("*** unable to rewrite %s", (stream->dest != NULL) ? stream->dest : "output");
+    }
+
+    return;
+}
+
+/*
+ * Write out any remaining results, finish the output, and free the
+ * writer.
+ */
+void close_output_stream(output_stream_t *stream, const results_t *results)
+{
+    int r = 0;
+
+    if (stream == NULL) {
+        return;
+    }
+
+    write_stream_results(stream, results, true);
+
+    if (stream->rewrite) {
+        restart_output_stream(stream);
+        write_stream_results(stream, results, true);
+    }
+
+    if (stream->groups > 0) {
+        if (stream->format == FORMAT_JSON && stream->fp != NULL) {
+            json_stream_finish(stream);
+        } else if (stream->format == FORMAT_XUNIT && stream->body != NULL && open_stream_dest(stream)) {
+            xunit_stream_finish(stream);
+        }
+    }
+
+    if (stream->body != NULL) {
+        fclose(stream->body);
+    }
+
+    if (stream->fp != NULL) {
+        r = fflush(stream->fp);
+        assert(r == 0);
+
+        if (stream->dest != NULL) {
+            r = fclose(stream->fp);
+            assert(r == 0);
+        }
+    }
+
+    list_free(stream->headers, free);
+    free(stream->dest);
+    free(stream);
+    return;
+}
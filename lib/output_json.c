@@ -5,135 +5,152 @@
 
 #include <stdio.h>
 #include <string.h>
-#include <errno.h>
-#include <err.h>
 #include <assert.h>
-#include <json.h>
 
+#include "queue.h"
 #include "rpminspect.h"
 
 /*
- * Output a results_t in JSON format.
+ * The JSON output is written directly rather than built as a json-c
+ * object first so results can be written as each inspection finishes
+ * without holding the whole document in memory.  The layout and string
+ * escaping are the same as json_object_to_json_string_ext() with
+ * JSON_C_TO_STRING_SPACED and JSON_C_TO_STRING_PRETTY, which is what
+ * this writer used before.
  */
-void output_json(const results_t *results, const char *dest, __attribute__((unused)) const severity_t threshold, const severity_t suppress)
-{
-    results_entry_t *result = NULL;
-    int r = 0;
-    int len = 0;
-    FILE *fp = NULL;
-    const char *header = NULL;
-    const char* json_string = NULL;
-    struct json_object *j = NULL;
-    struct json_object *ji = NULL;
-    struct json_object *jr = NULL;
-    int flags = JSON_C_TO_STRING_SPACED | JSON_C_TO_STRING_PRETTY;
-    struct json_object_iter iter;
 
-    assert(results != NULL);
+/* Write s as a JSON string, escaped the way json-c escapes strings */
+static void json_write_string(FILE *fp, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char *c = NULL;
+
+    assert(fp != NULL);
+    assert(s != NULL);
+
+    fputc('"', fp);
+
+    for (c = (const unsigned char *) s; *c != '\0'; c++) {
+        switch (*c) {
+            case '\b':
+                fputs("\\b", fp);
+                break;
+            case '\n':
+                fputs("\\n", fp);
+                break;
+            case '\r':
+                fputs("\\r", fp);
+                break;
+            case '\t':
+                fputs("\\t", fp);
+                break;
+            case '\f':
+                fputs("\\f", fp);
+                break;
+            case '"':
+                fputs("\\\"", fp);
+                break;
+            case '\\':
+                fputs("\\\\", fp);
+                break;
+            case '/':
+                fputs("\\/", fp);
+                break;
+            default:
+                if (*c < ' ') {
+                    fprintf(fp, "\\u00%c%c", hex[*c >> 4], hex[*c & 0xf]);
+                } else {
+                    fputc(*c, fp);
+                }
 
-    /* output the results */
-    TAILQ_FOREACH(result, results, items) {
-        /* Ignore suppressed results */
-        if (suppressed_results(results, result->header, suppress)) {
-            continue;
+                break;
         }
+    }
 
-        /*
-         * The main results object.  Each inspection will be an array
-         * with the results contained as array elements.
-         */
-        if (j == NULL) {
-            j = json_object_new_object();
-        }
+    fputc('"', fp);
+    return;
+}
 
-        /* if we have a new inspection set, create a new object */
-        if (header == NULL || strcmp(header, result->header)) {
-            /* add previous inspection if there is one */
-            if (ji != NULL) {
-                json_object_object_add(j, header, json_object_get(ji));
-            }
+/* Write one "key": "value" member of a result object */
+static void json_write_member(FILE *fp, const char *key, const char *value, const bool first)
+{
+    fputs(first ? "      " : ",\n      ", fp);
+    json_write_string(fp, key);
+    fputs(": ", fp);
+    json_write_string(fp, value);
+    return;
+}
 
-            /* new inspection begins now */
-            header = result->header;
-            ji = json_object_new_array();
+/*
+ * Write the results of one inspection, every result from first on with
+ * the same header, as an array named after the inspection.
+ */
+void json_stream_group(output_stream_t *stream, const results_entry_t *first)
+{
+    const results_entry_t *result = NULL;
+    FILE *fp = NULL;
+    bool written = false;
+
+    assert(stream != NULL);
+    assert(stream->fp != NULL);
+    assert(first != NULL);
+
+    fp = stream->fp;
+
+    /* the main results object, each inspection is an array in it */
+    fputs((stream->groups == 0) ? "{\n  " : ",\n  ", fp);
+    json_write_string(fp, first->header);
+    fputs(": [\n", fp);
+
+    for (result = first; result != NULL; result = TAILQ_NEXT(result, items)) {
+        if (strcmp(result->header, first->header)) {
+            continue;
         }
 
-        /* create the object for this result */
-        jr = json_object_new_object();
-        json_object_object_add(jr, "result", json_object_new_string(strseverity(result->severity)));
+        fputs(written ? ",\n    {\n" : "    {\n", fp);
+        written = true;
+        json_write_member(fp, "result", strseverity(result->severity), true);
 
         if (result->waiverauth > NULL_WAIVERAUTH) {
-            json_object_object_add(jr, "waiver authorization", json_object_new_string(strwaiverauth(result->waiverauth)));
+            json_write_member(fp, "waiver authorization", strwaiverauth(result->waiverauth), false);
         }
 
         if (result->msg != NULL) {
-            json_object_object_add(jr, "message", json_object_new_string(result->msg));
+            json_write_member(fp, "message", result->msg, false);
         }
 
         if (result->details != NULL) {
-            json_object_object_add(jr, "details", json_object_new_string(result->details));
+            json_write_member(fp, "details", result->details, false);
         }
 
         if (result->remedy != REMEDY_NULL) {
-            json_object_object_add(jr, "remedy", json_object_new_string(get_remedy(result->remedy)));
+            json_write_member(fp, "remedy", get_remedy(result->remedy), false);
         }
 
-        /* add this result data to the inspection array */
-        json_object_array_add(ji, jr);
+        fputs("\n    }", fp);
     }
 
-    /* add the final inspection */
-    if (header != NULL && j != NULL) {
-        json_object_object_add(j, header, json_object_get(ji));
-    }
-
-    /* output results */
-    if (j != NULL) {
-        /* default to stdout unless a filename was specified */
-        if (dest == NULL) {
-            fp = stdout;
-        } else {
-            fp = fopen(dest, "w");
-
-            if (fp == NULL) {
-                warn(_("*** error opening %s for writing"), dest);
-                json_object_put(j);
-                return;
-            }
-        }
-
-        /* write out the results */
-        json_string = json_object_to_json_string_ext(j, flags);
-        if (json_string == NULL) {
-            errx(RI_PROGRAM_ERROR, "*** failed to stringify object to json format");
-        }
-        /* write out the results */
-        fprintf(fp, "%s\n", json_string);
-
-        /* tidy up and return */
-        r = fflush(fp);
-        assert(r == 0);
-
-        if (dest != NULL) {
-            r = fclose(fp);
-            assert(r == 0);
-        }
-
-        /* clean up the json library memory allocation */
-        json_object_object_foreachC(j, iter) {
-            if (json_object_get_type(iter.val) == json_type_array) {
-                len = json_object_array_length(iter.val);
+    fputs("\n  ]", fp);
+    return;
+}
 
-                for (r = 0; r < len; r++) {
-                    json_object_array_put_idx(iter.val, r, NULL);
-                }
-            }
+/* Close the main results object */
+void json_stream_finish(output_stream_t *stream)
+{
+    assert(stream != NULL);
+    assert(stream->fp != NULL);
 
-            json_object_put(iter.val);
-        }
+    fputs("\n}\n", stream->fp);
+    return;
+}
 
-        json_object_put(j);
-    }
+/*
+ * Output a results_t in JSON format.
+ */
+void output_json(const results_t *results, const char *dest, const severity_t threshold, const severity_t suppress)
+{
+    assert(results != NULL);
 
+    close_output_stream(open_output_stream(FORMAT_JSON, dest, threshold, suppress), results);
     return;
 }
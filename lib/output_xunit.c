@@ -4,87 +4,65 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <err.h>
 #include <assert.h>
 
+#include "queue.h"
 #include "rpminspect.h"
 
 /*
- * Output a results_t in XUnit format.  This can be consumed by Jenkins or
- * other services that can read in XUnit data (e.g., GitHub).
+ * Write one result as part of the test case for its inspection.  The
+ * test cases are written to stream->body because the totals at the
+ * top of the output are only known once every result has been seen.
  */
-void output_xunit(const results_t *results, const char *dest, const severity_t threshold, const severity_t suppress)
+void xunit_stream_result(output_stream_t *stream, const results_entry_t *result)
 {
-    results_entry_t *result = NULL;
-    int r = 0;
-    int count = 0;
-    int total = 0;
-    int failures = 0;
     FILE *fp = NULL;
-    const char *header = NULL;
     char *msg = NULL;
     char *rawcdata = NULL;
     char *cdata = NULL;
 
-    /* count up total test cases and total failures */
-    TAILQ_FOREACH(result, results, items) {
-        if (header == NULL || strcmp(header, result->header)) {
-            total++;
-        }
+    assert(stream != NULL);
+    assert(stream->body != NULL);
+    assert(result != NULL);
 
-        header = result->header;
+    fp = stream->body;
 
-        if (result->severity >= threshold) {
-            failures++;
+    if (stream->header == NULL || strcmp(stream->header, result->header)) {
+        if (stream->header != NULL) {
+            fprintf(fp, "    </testcase>\n");
         }
+
+        fprintf(fp, "    <testcase name=\"/%s\" classname=\"rpminspect\">\n", result->header);
+        stream->header = result->header;
+        stream->count = 1;
     }
 
-    /* output the results */
-    TAILQ_FOREACH(result, results, items) {
-        /* Ignore suppressed results */
-        if (suppressed_results(results, result->header, suppress)) {
-            continue;
+    /* prepare the system out message */
+    if (result->msg != NULL) {
+        if (result->severity >= stream->threshold) {
+            fprintf(fp, "        <failure message=\"%s\">%s</failure>\n", result->msg, inspection_header_to_desc(result->header));
         }
 
-        /* default to stdout unless a filename was specified */
-        if (fp == NULL) {
-            if (dest == NULL) {
-                fp = stdout;
-            } else {
-                fp = fopen(dest, "w");
-            }
-
-            if (fp == NULL) {
-                warn(_("*** opening %s for writing"), dest);
-                return;
-            }
-
-            header = NULL;
-            fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
-            fprintf(fp, "<testsuite tests=\"%d\" failures=\"%d\" errors=\"0\" skipped=\"0\">\n", total, failures);
-        }
+        xasprintf(&msg, "%d) %s\n\n", stream->count++, result->msg);
+        assert(msg != NULL);
+    }
 
-        if (header == NULL || strcmp(header, result->header)) {
-            if (header != NULL) {
-                fprintf(fp, "    </testcase>\n");
-            }
+    xasprintf(&rawcdata, _("Result: %s\n"), strseverity(result->severity));
+    assert(rawcdata != NULL);
 
-            fprintf(fp, "    <testcase name=\"/%s\" classname=\"rpminspect\">\n", result->header);
-            header = result->header;
-            count = 1;
-        }
+    if (msg) {
+        msg = strappend(msg, rawcdata, NULL);
+    } else {
+        msg = strdup(rawcdata);
+    }
 
-        /* prepare the system out message */
-        if (result->msg != NULL) {
-            if (result->severity >= threshold) {
-                fprintf(fp, "        <failure message=\"%s\">%s</failure>\n", result->msg, inspection_header_to_desc(result->header));
-            }
+    assert(msg != NULL);
+    free(rawcdata);
 
-            xasprintf(&msg, "%d) %s\n\n", count++, result->msg);
-            assert(msg != NULL);
-        }
-
-        xasprintf(&rawcdata, _("Result: %s\n"), strseverity(result->severity));
+    if (result->waiverauth > NULL_WAIVERAUTH) {
+        xasprintf(&rawcdata, _("Waiver Authorization: %s\n\n"), strwaiverauth(result->waiverauth));
         assert(rawcdata != NULL);
 
         if (msg) {
@@ -95,62 +73,73 @@ void output_xunit(const results_t *results, const char *dest, const severity_t t
 
         assert(msg != NULL);
         free(rawcdata);
+    }
 
-        if (result->waiverauth > NULL_WAIVERAUTH) {
-            xasprintf(&rawcdata, _("Waiver Authorization: %s\n\n"), strwaiverauth(result->waiverauth));
-            assert(rawcdata != NULL);
+    if (result->details != NULL) {
+        xasprintf(&rawcdata, _("Details:\n%s\n\n"), result->details);
+        assert(rawcdata != NULL);
+        msg = strappend(msg, rawcdata, NULL);
+        assert(msg != NULL);
+        free(rawcdata);
+    }
 
-            if (msg) {
-                msg = strappend(msg, rawcdata, NULL);
-            } else {
-                msg = strdup(rawcdata);
-            }
+    if (result->remedy != REMEDY_NULL) {
+        xasprintf(&rawcdata, _("Suggested Remedy:\n%s"), get_remedy(result->remedy));
+        assert(rawcdata != NULL);
+        msg = strappend(msg, rawcdata, NULL);
+        assert(msg != NULL);
+        free(rawcdata);
+    }
 
-            assert(msg != NULL);
-            free(rawcdata);
-        }
+    /* escape the string for XML CDATA use */
+    cdata = strxmlescape(msg);
+    assert(cdata != NULL);
+    fprintf(fp, "        <system-out><![CDATA[%s]]></system-out>\n", cdata);
+    free(cdata);
+    free(msg);
 
-        if (result->details != NULL) {
-            xasprintf(&rawcdata, _("Details:\n%s\n\n"), result->details);
-            assert(rawcdata != NULL);
-            msg = strappend(msg, rawcdata, NULL);
-            assert(msg != NULL);
-            free(rawcdata);
-        }
+    return;
+}
 
-        if (result->remedy != REMEDY_NULL) {
-            xasprintf(&rawcdata, _("Suggested Remedy:\n%s"), get_remedy(result->remedy));
-            assert(rawcdata != NULL);
-            msg = strappend(msg, rawcdata, NULL);
-            assert(msg != NULL);
-            free(rawcdata);
-        }
+/*
+ * Write the totals, the test cases held in stream->body, and the end
+ * of the test suite to the destination.
+ */
+void xunit_stream_finish(output_stream_t *stream)
+{
+    char buf[BUFSIZ];
+    size_t n = 0;
 
-        /* escape the string for XML CDATA use */
-        cdata = strxmlescape(msg);
-        assert(cdata != NULL);
-        fprintf(fp, "        <system-out><![CDATA[%s]]></system-out>\n", cdata);
-        free(cdata);
-        free(msg);
-        cdata = NULL;
-        msg = NULL;
-    }
+    assert(stream != NULL);
+    assert(stream->fp != NULL);
+    assert(stream->body != NULL);
 
-    /* tidy up and return */
-    if (fp != NULL) {
-        if (header != NULL) {
-            fprintf(fp, "    </testcase>\n");
-        }
+    fprintf(stream->fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(stream->fp, "<testsuite tests=\"%d\" failures=\"%d\" errors=\"0\" skipped=\"0\">\n", stream->tests, stream->failures);
 
-        fprintf(fp, "</testsuite>\n");
-        r = fflush(fp);
-        assert(r == 0);
+    rewind(stream->body);
 
-        if (dest != NULL) {
-            r = fclose(fp);
-            assert(r == 0);
+    while ((n = fread(buf, 1, sizeof(buf), stream->body)) > 0) {
+        if (fwrite(buf, 1, n, stream->fp) != n) {
+            warn("*** fwrite");
+            return;
         }
     }
 
+    if (stream->header != NULL) {
+        fprintf(stream->fp, "    </testcase>\n");
+    }
+
+    fprintf(stream->fp, "</testsuite>\n");
+    return;
+}
+
+/*
+ * Output a results_t in XUnit format.  This can be consumed by Jenkins or
+ * other services that can read in XUnit data (e.g., GitHub).
+ */
+void output_xunit(const results_t *results, const char *dest, const severity_t threshold, const severity_t suppress)
+{
+    close_output_stream(open_output_stream(FORMAT_XUNIT, dest, threshold, suppress), results);
     return;
 }
@@ -12,12 +12,16 @@
 #include <sys/wait.h>
 #include <stdio.h>
 #include <string.h>
+#include <assert.h>
 #include "rpminspect.h"
 #include "parallel.h"
 
 unsigned default_parallel_processes = 0;
 
-static unsigned available_cpus(void)
+/* Sentinel for "no limit" from the cgroup readers below */
+#define NO_LIMIT ((unsigned long long) -1)
+
+static unsigned affinity_cpus(void)
 {
 #if 0
     /* This reads /sys/devices/system/cpu/online, which isn't affected by CPU mask */
@@ -57,12 +61,297 @@ static unsigned available_cpus(void)
 #endif
 }
 
+/*
+ * Read up to two numbers from a cgroup control file.  "max" reads as
+ * NO_LIMIT.  Returns the number of values read.
+ */
+static int read_cgroup_values(const char *path, unsigned long long *a, unsigned long long *b)
+{
+    FILE *fp = NULL;
+    char first[32];
+    int n = 0;
+
+    fp = fopen(path, "r");
+
+    if (fp == NULL) {
+        return 0;
+    }
+
+    n = fscanf(fp, "%31s %llu", first, b);
+    fclose(fp);
+
+    if (n < 1) {
+        return 0;
+    }
+
+    if (!strcmp(first, "max")) {
+        *a = NO_LIMIT;
+    } else {
+        *a = strtoull(first, NULL, 10);
+    }
+
+    return n;
+}
+
+/*
+ * Find the directory of this process's cgroup for the given cgroup v1
+ * controller, or the cgroup v2 directory if controller is NULL.
+ * Returns NULL if there is none.  Caller must free the result.
+ */
+static char *cgroup_dir(const char *controller)
+{
+    FILE *fp = NULL;
+    char *line = NULL;
+    size_t len = 0;
+    char *controllers = NULL;
+    char *path = NULL;
+    char *tok = NULL;
+    char *save = NULL;
+    char *ret = NULL;
+    bool match = false;
+
+    fp = fopen("/proc/self/cgroup", "r");
+
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    /* each line is hierarchy-ID:controller-list:cgroup-path */
+    while (ret == NULL && getline(&line, &len, fp) != -1) {
+        line[strcspn(line, "\n")] = '\0';
+        controllers = strchr(line, ':');
+
+        if (controllers == NULL || (path = strchr(++controllers, ':')) == NULL) {
+            continue;
+        }
+
+        *path++ = '\0';
+
+        if (controller == NULL) {
+            /* the cgroup v2 unified hierarchy has no controllers listed */
+            if (*controllers == '\0') {
+                xasprintf(&ret, "/sys/fs/cgroup%s", path);
+            }
+
+            continue;
+        }
+
+        match = false;
+
+        for (tok = strtok_r(controllers, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+            if (!strcmp(tok, controller)) {
+                match = true;
+            }
+        }
+
+        if (match) {
+            xasprintf(&ret, "/sys/fs/cgroup/%s%s", controller, path);
+        }
+    }
+
+    free(line);
+    fclose(fp);
+    return ret;
+}
+
+/*
+ * Walk from the cgroup directory up to the root and call fn on each
+ * level so limits set on a parent cgroup are honored too.  Inside a
+ * container with its own cgroup namespace the path is "/" and the
+ * container's limits are at the top of the mount.  Returns the
+ * smallest value fn returned.
+ */
+static unsigned long long cgroup_min(const char *controller, unsigned long long (*fn)(const char *, bool))
+{
+    char *dir = NULL;
+    char *slash = NULL;
+    char *top = NULL;
+    unsigned long long v = 0;
+    unsigned long long ret = NO_LIMIT;
+
+    dir = cgroup_dir(controller);
+
+    if (dir == NULL) {
+        return NO_LIMIT;
+    }
+
+    if (controller) {
+        xasprintf(&top, "/sys/fs/cgroup/%s", controller);
+    } else {
+        top = strdup("/sys/fs/cgroup");
+        assert(top != NULL);
+    }
+
+    while (strlen(dir) >= strlen(top)) {
+        v = fn(dir, controller == NULL);
+
+        if (v < ret) {
+            ret = v;
+        }
+
+        slash = strrchr(dir, '/');
+
+        if (slash == NULL || slash == dir) {
+            break;
+        }
+
+        *slash = '\0';
+    }
+
+    free(dir);
+    free(top);
+    return ret;
+}
+
+/* CPUs allowed by the CFS quota of one cgroup, rounded up */
+static unsigned long long cgroup_cpu_limit(const char *dir, bool v2)
+{
+    char *path = NULL;
+    unsigned long long quota = NO_LIMIT;
+    unsigned long long period = 0;
+
+    if (v2) {
+        /* cpu.max holds "$MAX $PERIOD" with $MAX possibly "max" */
+        xasprintf(&path, "%s/cpu.max", dir);
+
+        if (read_cgroup_values(path, &quota, &period) != 2) {
+            quota = NO_LIMIT;
+        }
+    } else {
+        /* cgroup v1 uses two files and -1 for no quota */
+        xasprintf(&path, "%s/cpu.cfs_quota_us", dir);
+
+        if (read_cgroup_values(path, &quota, &period) != 1 || (long long) quota <= 0) {
+            quota = NO_LIMIT;
+        }
+
+        free(path);
+        xasprintf(&path, "%s/cpu.cfs_period_us", dir);
+
+        if (read_cgroup_values(path, &period, &period) != 1) {
+            quota = NO_LIMIT;
+        }
+    }
+
+    free(path);
+
+    if (quota == NO_LIMIT || period == 0) {
+        return NO_LIMIT;
+    }
+
+    return (quota + period - 1) / period;
+}
+
+/* Memory still available under the limit of one cgroup */
+static unsigned long long cgroup_memory_left(const char *dir, bool v2)
+{
+    char *path = NULL;
+    unsigned long long limit = NO_LIMIT;
+    unsigned long long used = 0;
+    unsigned long long unused = 0;
+
+    xasprintf(&path, v2 ? "%s/memory.max" : "%s/memory.limit_in_bytes", dir);
+
+    if (read_cgroup_values(path, &limit, &unused) < 1) {
+        limit = NO_LIMIT;
+    }
+
+    free(path);
+
+    /* cgroup v1 reports no limit as a huge page aligned number */
+    if (limit == NO_LIMIT || limit >= (NO_LIMIT >> 2)) {
+        return NO_LIMIT;
+    }
+
+    xasprintf(&path, v2 ? "%s/memory.current" : "%s/memory.usage_in_bytes", dir);
+
+    if (read_cgroup_values(path, &used, &unused) < 1) {
+        used = 0;
+    }
+
+    free(path);
+    return (used < limit) ? (limit - used) : 0;
+}
+
+/*
+ * Number of CPUs this process may use: the affinity mask, further
+ * limited by any cgroup v1 or v2 CPU quota.
+ */
+static unsigned available_cpus(void)
+{
+    unsigned r = affinity_cpus();
+    unsigned long long quota = 0;
+
+    quota = cgroup_min(NULL, cgroup_cpu_limit);
+
+    if (quota == NO_LIMIT) {
+        quota = cgroup_min("cpu", cgroup_cpu_limit);
+    }
+
+    if (quota > 0 && quota < r) {
+        DEBUG_PRINT("cgroup CPU quota limits workers to %llu of %u CPUs\n", quota, r);
+        r = quota;
+    }
+
+    return r;
+}
+
+/*
+ * Bytes of memory left under the cgroup v1 or v2 memory limit, or 0
+ * if there is no limit.
+ */
+static unsigned long long available_memory(void)
+{
+    unsigned long long left = cgroup_min(NULL, cgroup_memory_left);
+
+    if (left == NO_LIMIT) {
+        left = cgroup_min("memory", cgroup_memory_left);
+    }
+
+    return (left == NO_LIMIT) ? 0 : left;
+}
+
+/*
+ * Return how many worker processes to run.  default_parallel_processes
+ * is used if set (-j or the 'workers' setting).  Otherwise this is one
+ * per usable CPU, honoring the affinity mask and cgroup CPU quotas,
+ * and scaled down so that workers needing footprint bytes each fit in
+ * what is left of the cgroup memory limit.  Pass 0 for footprint to
+ * ignore memory.  Always at least 1.
+ */
+unsigned parallel_workers(unsigned long footprint)
+{
+    unsigned r = default_parallel_processes;
+    unsigned long long mem = 0;
+
+    if (r > 0) {
+        return r;
+    }
+
+    r = available_cpus();
+
+    if (footprint > 0 && (mem = available_memory()) > 0 && mem / footprint < r) {
+        DEBUG_PRINT("cgroup memory limit allows %llu workers of %lu bytes\n", mem / footprint, footprint);
+        r = mem / footprint;
+    }
+
+    if ((int)r <= 0) { /* paranoia */
+        r = 1;
+    }
+
+    if (r > 1024) { /* paranoia */
+        r = 1024;
+    }
+
+    return r;
+}
+
 /* If MAX > 0: prepare for up to MAX processes.
  *
- * If MAX is 0, default_parallel_processes is used
- * (which, in turn, is set to sysconf(_SC_NPROCESSORS_ONLN)).
+ * If MAX is 0, parallel_workers(PARALLEL_WORKER_FOOTPRINT) is used
+ * (which, in turn, is default_parallel_processes if that is set).
  *
- * If MAX < 0, use default_parallel_processes * (-MAX).
+ * If MAX < 0, use that many workers * (-MAX).
  * For example, if we anticipate that children are simple,
  * fast-finishing processes, it makes sense to spawn 3 * NUM_CPU of them,
  * for system to have something more to do when some of them finish -
@@ -81,21 +370,7 @@ parallel_t *new_parallel(int max)
     }
 
     if (max <= 0) {
-        max = default_parallel_processes;
-
-        if (max <= 0) {
-            max = available_cpus();
-
-            if ((int)max <= 0) { /* paranoia */
-                max = 1;
-            }
-
-            if (max > 1024) { /* paranoia */
-                max = 1024;
-            }
-
-            default_parallel_processes = max;
-        }
+        max = parallel_workers(PARALLEL_WORKER_FOOTPRINT);
     }
 
     max_pids *= max;
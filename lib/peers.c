@@ -51,6 +51,60 @@ void free_peers(rpmpeer_t *peers)
     return;
 }
 
+/*
+ * Forget the after build in the peer list.  Peers that only exist in
+ * the after build are removed.  The before build packages keep their
+ * extracted trees and file lists, only the links to the after build
+ * files are cleared so find_file_peers() can run again.  Used by
+ * batch mode to compare one before build with many after builds.
+ */
+void release_after_peers(rpmpeer_t *peers)
+{
+    rpmpeer_entry_t *entry = NULL;
+    rpmpeer_entry_t *next = NULL;
+    rpmfile_entry_t *file = NULL;
+
+    if (peers == NULL) {
+        return;
+    }
+
+    for (entry = TAILQ_FIRST(peers); entry != NULL; entry = next) {
+        next = TAILQ_NEXT(entry, items);
+
+        free(entry->after_rpm);
+        free(entry->after_root);
+        free_files(entry->after_files);
+        free_deprules(entry->after_deprules);
+        entry->after_hdr = NULL;
+        entry->after_rpm = NULL;
+        entry->after_root = NULL;
+        entry->after_files = NULL;
+        entry->after_deprules = NULL;
+        entry->after_unpacked_size = 0;
+
+        if (entry->before_rpm == NULL) {
+            TAILQ_REMOVE(peers, entry, items);
+            free(entry->before_root);
+            free_files(entry->before_files);
+            free_deprules(entry->before_deprules);
+            free(entry);
+            continue;
+        }
+
+        if (entry->before_files == NULL) {
+            continue;
+        }
+
+        TAILQ_FOREACH(file, entry->before_files, items) {
+            file->peer_file = NULL;
+            file->moved_path = false;
+            file->moved_subpackage = false;
+        }
+    }
+
+    return;
+}
+
 /*
  * Add the specified package as a peer in the list of packages.
  */
@@ -146,12 +200,33 @@ void add_peer(rpmpeer_t **peers, deprule_ignore_map_t *ignores, int whichbuild,
     return;
 }
 
+/*
+ * Extract one side of a peer unless that has already been done.  This
+ * is used by extract_peers() and by the pipelined download mode which
+ * extracts downloaded packages while waiting for the next one.
+ */
+void extract_peer(struct rpminspect *ri, rpmpeer_entry_t *peer, int whichbuild)
+{
+    assert(ri != NULL);
+    assert(peer != NULL);
+
+    if (whichbuild == BEFORE_BUILD && peer->before_hdr && peer->before_rpm && peer->before_root == NULL) {
+        peer->before_files = extract_rpm(ri, peer->before_rpm, peer->before_hdr, BEFORE_SUBDIR, &peer->before_root);
+    } else if (whichbuild == AFTER_BUILD && peer->after_hdr && peer->after_rpm && peer->after_root == NULL) {
+        peer->after_files = extract_rpm(ri, peer->after_rpm, peer->after_hdr, AFTER_SUBDIR, &peer->after_root);
+    }
+
+    return;
+}
+
 int extract_peers(struct rpminspect *ri, bool fetchonly)
 {
     unsigned long int avail = 0;
+    unsigned long int need = 0;
     char *availh = NULL;
     char *needh = NULL;
     rpmpeer_entry_t *peer = NULL;
+    struct timing_mark mark;
 
     if (fetchonly) {
         return RI_SUCCESS;
@@ -161,17 +236,41 @@ int extract_peers(struct rpminspect *ri, bool fetchonly)
     assert(ri->peers != NULL);
     assert(ri->workdir != NULL);
 
-    /* compute total unpacked size required and see if there's space */
+    /*
+     * inspections with cached results do not need the payloads, in
+     * pipelined mode the caller has already looked them up
+     */
+    if (!ri->pipeline) {
+        find_cached_results(ri);
+    }
+
+    /* payloads are only unpacked if a selected inspection reads them */
+    if (!(ri->needs & NEEDS_FILES)) {
+        return RI_SUCCESS;
+    }
+
+    /*
+     * compute total unpacked size required and see if there's space
+     * for the packages not already extracted while downloading
+     */
     TAILQ_FOREACH(peer, ri->peers, items) {
         ri->unpacked_size += peer->before_unpacked_size;
         ri->unpacked_size += peer->after_unpacked_size;
+
+        if (peer->before_root == NULL) {
+            need += peer->before_unpacked_size;
+        }
+
+        if (peer->after_root == NULL) {
+            need += peer->after_unpacked_size;
+        }
     }
 
     avail = get_available_space(ri->workdir);
 
-    if (avail < ri->unpacked_size) {
+    if (avail < need) {
         availh = human_size(avail);
-        needh = human_size(ri->unpacked_size);
+        needh = human_size(need);
 
         fprintf(stderr, _("There is not enough available space to unpack all of the RPMs.\n"));
         fprintf(stderr, _("    Need %s in %s, have %s.\n"), needh, ri->workdir, availh);
@@ -184,19 +283,17 @@ int extract_peers(struct rpminspect *ri, bool fetchonly)
 
     /* unpack all RPMs */
     TAILQ_FOREACH(peer, ri->peers, items) {
-        /* extract the before peer */
-        if (peer->before_hdr && peer->before_rpm) {
-            peer->before_files = extract_rpm(ri, peer->before_rpm, peer->before_hdr, BEFORE_SUBDIR, &peer->before_root);
-        }
-
-        /* extract the after peer */
-        if (peer->after_hdr && peer->after_rpm) {
-            peer->after_files = extract_rpm(ri, peer->after_rpm, peer->after_hdr, AFTER_SUBDIR, &peer->after_root);
-        }
+        /* extract the before and after peers */
+        start_timing(ri, "phase", "extract", &mark);
+        extract_peer(ri, peer, BEFORE_BUILD);
+        extract_peer(ri, peer, AFTER_BUILD);
+        stop_timing(ri, "phase", "extract", &mark);
 
         /* match up file peers between builds */
-        if (peer->before_files && peer->after_files) {
+        if ((ri->needs & NEEDS_PEERS) && peer->before_files && peer->after_files) {
+            start_timing(ri, "phase", "peers", &mark);
             find_file_peers(ri, peer->before_files, peer->after_files);
+            stop_timing(ri, "phase", "peers", &mark);
         }
     }
 
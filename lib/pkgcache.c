@@ -0,0 +1,265 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/**
+ * @file pkgcache.c
+ * @brief Shared cache of packages downloaded from Koji.
+ * @copyright LGPL-3.0-or-later
+ *
+ * When the package_cache setting names a directory, every package
+ * downloaded from Koji is kept there under the SHA-256 digest of its
+ * URL.  Koji never changes a file once it is published, so the URL
+ * identifies the contents.  Later runs on the same host hard link the
+ * cached package in to their working directory rather than
+ * downloading it again.  The link count is the reference count: the
+ * cache can drop a package while a job still has it linked and the
+ * job keeps its copy.  The cache is kept under package_cache_size by
+ * removing the least recently used packages.
+ */
+
+/*
+ * XXX: temporary until we have support for the OpenSSL 3.0 API
+ */
+#define OPENSSL_API_COMPAT 0x101010bfL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+#include <err.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <openssl/sha.h>
+
+#include "rpminspect.h"
+
+/* one cached package, used when trimming the cache */
+struct cached_package {
+    char *path;
+    off_t size;
+    time_t used;
+};
+
+/*
+ * Path of the cache entry for the given URL.  Caller must free the
+ * returned string.
+ */
+static char *cache_path(const struct rpminspect *ri, const char *src)
+{
+    int i = 0;
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    char hex[(SHA256_DIGEST_LENGTH * 2) + 1];
+    char *ret = NULL;
+
+    SHA256((const unsigned char *) src, strlen(src), digest);
+
+    for (i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+        sprintf(&hex[i * 2], "%02x", (unsigned int) digest[i]);
+    }
+
+    xasprintf(&ret, "%s/%s.rpm", ri->package_cache, hex);
+    assert(ret != NULL);
+    return ret;
+}
+
+/*
+ * Make dst refer to src, by hard link when both are on the same file
+ * system and by copy otherwise.  Returns false on failure.
+ */
+static bool link_or_copy(const char *src, const char *dst)
+{
+    if (link(src, dst) == 0) {
+        return true;
+    }
+
+    if (errno != EXDEV && errno != EPERM && errno != EMLINK) {
+        return false;
+    }
+
+    return (copyfile(src, dst, true, false) == 0);
+}
+
+/*
+ * Returns true if the file starts with the RPM lead magic, so error
+ * pages and partial downloads are not cached.
+ */
+static bool is_rpm_file(const char *path)
+{
+    int fd = -1;
+    unsigned char magic[4];
+    ssize_t n = 0;
+
+    fd = open(path, O_RDONLY);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    n = read(fd, magic, sizeof(magic));
+    close(fd);
+
+    return (n == sizeof(magic) && magic[0] == 0xed && magic[1] == 0xab && magic[2] == 0xee && magic[3] == 0xdb);
+}
+
+/*
+ * Download src to dst through the shared package cache.  Without a
+ * package cache this is curl_get_file().
+ */
+void cached_get_file(struct rpminspect *ri, const char *src, const char *dst)
+{
+    int fd = -1;
+    char *path = NULL;
+    char *tmp = NULL;
+    mode_t mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
+
+    assert(ri != NULL);
+    assert(src != NULL);
+    assert(dst != NULL);
+
+    if (ri->package_cache == NULL) {
+        curl_get_file(ri->verbose, src, dst);
+        return;
+    }
+
+    path = cache_path(ri, src);
+
+    /* already have it, mark it used and link it in */
+    if (link_or_copy(path, dst)) {
+        DEBUG_PRINT("cached %s at %s\n", src, path);
+
+        if (utimensat(AT_FDCWD, path, NULL, 0) == -1) {
+            warn("*** utimensat %s", path);
+        }
+
+        free(path);
+        return;
+    }
+
+    curl_get_file(ri->verbose, src, dst);
+
+    if (!is_rpm_file(dst) || mkdirp(ri->package_cache, mode)) {
+        free(path);
+        return;
+    }
+
+    /* add it under a temporary name so other jobs never see a partial file */
+    xasprintf(&tmp, "%s.XXXXXX", path);
+    assert(tmp != NULL);
+    fd = mkstemp(tmp);
+
+    if (fd == -1) {
+        warn("*** mkstemp %s", tmp);
+    } else {
+        close(fd);
+
+        if (unlink(tmp) == -1 || !link_or_copy(dst, tmp)) {
+            warn("*** unable to add %s to %s", dst, ri->package_cache);
+            unlink(tmp);
+        } else if (rename(tmp, path) == -1) {
+            warn("*** rename %s", tmp);
+            unlink(tmp);
+        }
+    }
+
+    free(tmp);
+    free(path);
+    return;
+}
+
+/* Sort cached packages from least to most recently used */
+static int oldest_first(const void *a, const void *b)
+{
+    const struct cached_package *x = a;
+    const struct cached_package *y = b;
+
+    if (x->used < y->used) {
+        return -1;
+    } else if (x->used > y->used) {
+        return 1;
+    }
+
+    return strcmp(x->path, y->path);
+}
+
+/*
+ * Remove the least recently used packages from the package cache
+ * until it fits in package_cache_size.  Packages still linked in to a
+ * job's working directory stay on disk until that job removes them.
+ */
+void trim_package_cache(struct rpminspect *ri)
+{
+    int i = 0;
+    int n = 0;
+    int count = 0;
+    uint64_t total = 0;
+    uint64_t limit = 0;
+    struct dirent **names = NULL;
+    struct cached_package *pkgs = NULL;
+    struct stat sb;
+    char *path = NULL;
+
+    assert(ri != NULL);
+
+    if (ri->package_cache == NULL || ri->package_cache_size == 0) {
+        return;
+    }
+
+    /* the size is given in MiB, a limit too large for bytes is no limit */
+    if (ri->package_cache_size > UINT64_MAX / 1048576) {
+        limit = UINT64_MAX;
+    } else {
+        limit = (uint64_t) ri->package_cache_size * 1048576;
+    }
+
+    n = scandir(ri->package_cache, &names, NULL, NULL);
+
+    if (n == -1) {
+        return;
+    }
+
+    pkgs = xcalloc(n + 1, sizeof(*pkgs));
+
+    for (i = 0; i < n; i++) {
+        if (strsuffix(names[i]->d_name, ".rpm")) {
+            xasprintf(&path, "%s/%s", ri->package_cache, names[i]->d_name);
+            assert(path != NULL);
+
+            if (lstat(path, &sb) == 0 && S_ISREG(sb.st_mode)) {
+                pkgs[count].path = path;
+                pkgs[count].size = sb.st_size;
+                pkgs[count].used = sb.st_mtime;
+                total += sb.st_size;
+                count++;
+            } else {
+                free(path);
+            }
+        }
+
+        free(names[i]);
+    }
+
+    free(names);
+    qsort(pkgs, count, sizeof(*pkgs), oldest_first);
+
+    for (i = 0; i < count; i++) {
+        if (total > limit) {
+            DEBUG_PRINT("removing %s from the package cache\n", pkgs[i].path);
+
+            if (unlink(pkgs[i].path) == 0) {
+                total -= pkgs[i].size;
+            }
+        }
+
+        free(pkgs[i].path);
+    }
+
+    free(pkgs);
+    return;
+}
@@ -74,7 +74,7 @@ bool is_rebase(struct rpminspect *ri)
     }
 
     /* if the package name is on the rebaseable list, it's valid */
-    if (ri->rebase_build == -1 && init_rebaseable(ri) && list_contains(ri->rebaseable, an) && ((bn && !strcmp(bn, an)) || bn == NULL)) {
+    if (ri->rebase_build == -1 && is_rebaseable(ri, an) && ((bn && !strcmp(bn, an)) || bn == NULL)) {
         return true;
     }
 
@@ -88,3 +88,32 @@ bool is_rebase(struct rpminspect *ri)
         err(RI_PROGRAM_ERROR, "*** is_rebase");
     }
 }
+
+/**
+ * @brief Determine if the package is on the rebaseable list for the
+ * product release.  The list is loaded and indexed the first time.
+ *
+ * @param ri The struct rpminspect structure for the program.
+ * @param pkg The package name.
+ * @return True if the package is on the rebaseable list.
+ */
+bool is_rebaseable(struct rpminspect *ri, const char *pkg)
+{
+    string_entry_t *entry = NULL;
+
+    assert(ri != NULL);
+
+    if (pkg == NULL || !init_rebaseable(ri)) {
+        return false;
+    }
+
+    if (ri->rebaseable_index == NULL) {
+        ri->rebaseable_index = new_vendor_index(false);
+
+        TAILQ_FOREACH(entry, ri->rebaseable, items) {
+            vendor_index_add(ri->rebaseable_index, entry->data, entry);
+        }
+    }
+
+    return (vendor_index_find(ri->rebaseable_index, pkg) != NULL);
+}
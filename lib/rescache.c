@@ -0,0 +1,1172 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/**
+ * @file rescache.c
+ * @brief On disk cache of inspection results.
+ * @copyright LGPL-3.0-or-later
+ *
+ * When a result cache directory is given with -R, the results each
+ * inspection adds are written to a file in that directory named by a
+ * SHA-256 digest of everything the results depend on: the header
+ * digests of every before and after package, the configuration
+ * files, profiles, and vendor data, any product release given on the
+ * command line, the other command line options that change what the
+ * inspections report, the rpminspect version, and the inspection
+ * name.  A later run with the same inputs replays those results
+ * rather than running the inspection.  Paths in to the working
+ * directory are stored as placeholders because every run unpacks to
+ * a new one.  Inspections with cached results are left out when
+ * working out which parts of the packages to unpack.
+ *
+ * The same directory also holds the exit code and output of external
+ * commands run through cached_run_cmd(), keyed by the command and the
+ * contents of the files it was given.  Files that did not change
+ * between builds, such as everything on the before side, are only
+ * checked once.
+ *
+ * The same file format carries the results of the inspections that
+ * only read package headers from the child process that runs them
+ * while the payloads are unpacked in pipelined mode (-P).
+ */
+
+/*
+ * XXX: temporary until we have support for the OpenSSL 3.0 API
+ */
+#define OPENSSL_API_COMPAT 0x101010bfL
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <err.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <openssl/sha.h>
+#include <rpm/rpmlib.h>
+
+#include "rpminspect.h"
+
+/* Feed a string and its terminating NUL to the digest */
+static void hash_string(SHA256_CTX *ctx, const char *s)
+{
+    assert(ctx != NULL);
+
+    if (s == NULL) {
+        s = "";
+    }
+
+    SHA256_Update(ctx, s, strlen(s) + 1);
+    return;
+}
+
+/* Turn a finished digest in to a hex string, caller must free */
+static char *hex_digest(SHA256_CTX *ctx)
+{
+    int i = 0;
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    char *ret = NULL;
+
+    SHA256_Final(digest, ctx);
+    ret = xalloc((SHA256_DIGEST_LENGTH * 2) + 1);
+
+    for (i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+        sprintf(&ret[i * 2], "%02x", (unsigned int) digest[i]);
+    }
+
+    return ret;
+}
+
+/*
+ * Feed the digest of a package header to the digest.  The header
+ * digest covers the payload digest, so it identifies the whole
+ * package.  Packages without one are checksummed.
+ */
+static void hash_package(SHA256_CTX *ctx, Header hdr, const char *pkg)
+{
+    const char *digest = NULL;
+    char *sum = NULL;
+
+    if (hdr == NULL) {
+        hash_string(ctx, NULL);
+        return;
+    }
+
+    digest = headerGetString(hdr, RPMTAG_SHA256HEADER);
+
+    if (digest == NULL) {
+        digest = headerGetString(hdr, RPMTAG_SHA1HEADER);
+    }
+
+    if (digest == NULL) {
+        sum = compute_checksum(pkg, NULL, SHA256SUM);
+        hash_string(ctx, sum);
+        free(sum);
+    } else {
+        hash_string(ctx, digest);
+    }
+
+    return;
+}
+
+/*
+ * Feed the contents of path to the digest.  For a directory that is
+ * the names and contents of everything below it, visited in sorted
+ * order so the digest does not depend on the order the file system
+ * returns entries in.
+ */
+static void hash_path(SHA256_CTX *ctx, const char *path)
+{
+    int i = 0;
+    int n = 0;
+    off_t len = 0;
+    void *data = NULL;
+    char *entry = NULL;
+    struct dirent **names = NULL;
+    struct stat sb;
+
+    if (path == NULL || stat(path, &sb) == -1) {
+        return;
+    }
+
+    if (S_ISREG(sb.st_mode)) {
+        data = read_file_bytes(path, &len);
+
+        if (data != NULL) {
+            SHA256_Update(ctx, data, len);
+            free(data);
+        }
+
+        return;
+    } else if (!S_ISDIR(sb.st_mode)) {
+        return;
+    }
+
+    n = scandir(path, &names, NULL, alphasort);
+
+    if (n == -1) {
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        if (strcmp(names[i]->d_name, ".") && strcmp(names[i]->d_name, "..")) {
+            xasprintf(&entry, "%s/%s", path, names[i]->d_name);
+            assert(entry != NULL);
+            hash_string(ctx, names[i]->d_name);
+            hash_path(ctx, entry);
+            free(entry);
+        }
+
+        free(names[i]);
+    }
+
+    free(names);
+    return;
+}
+
+/*
+ * Compute the digest of the inputs shared by every inspection in
+ * this comparison.  Caller must free the returned string.
+ */
+static char *comparison_key(const struct rpminspect *ri)
+{
+    SHA256_CTX ctx;
+    char *options = NULL;
+    string_entry_t *entry = NULL;
+    rpmpeer_entry_t *peer = NULL;
+
+    assert(ri != NULL);
+
+    SHA256_Init(&ctx);
+    hash_string(&ctx, RESULT_CACHE_FORMAT);
+    hash_string(&ctx, PACKAGE_VERSION);
+
+    /* the packages being compared */
+    TAILQ_FOREACH(peer, ri->peers, items) {
+        hash_package(&ctx, peer->before_hdr, peer->before_rpm);
+        hash_package(&ctx, peer->after_hdr, peer->after_rpm);
+    }
+
+    /* configuration files, profiles, and vendor data */
+    if (ri->cfgfiles) {
+        TAILQ_FOREACH(entry, ri->cfgfiles, items) {
+            hash_string(&ctx, entry->data);
+            hash_path(&ctx, entry->data);
+        }
+    }
+
+    if (ri->locallines) {
+        TAILQ_FOREACH(entry, ri->locallines, items) {
+            hash_string(&ctx, entry->data);
+        }
+    }
+
+    hash_string(&ctx, ri->profiledir);
+    hash_path(&ctx, ri->profiledir);
+    hash_string(&ctx, ri->vendor_data_dir);
+    hash_path(&ctx, ri->vendor_data_dir);
+
+    /*
+     * given with -r, or in pipelined mode already worked out from the
+     * headers hashed above
+     */
+    hash_string(&ctx, ri->product_release);
+
+    /*
+     * -T and -E, because some inspections report differently when
+     * others are selected, then -n, -b, and -t
+     */
+    xasprintf(&options, "%ju %d %d %d", (uintmax_t) ri->tests, ri->rebase_detection ? 1 : 0, ri->buildtype, ri->threshold);
+    assert(options != NULL);
+    hash_string(&ctx, options);
+    free(options);
+
+    /* -a */
+    if (ri->arches) {
+        TAILQ_FOREACH(entry, ri->arches, items) {
+            hash_string(&ctx, entry->data);
+        }
+    }
+
+    return hex_digest(&ctx);
+}
+
+/*
+ * Replace the working directory paths in s with placeholders, or
+ * when expand is true, the placeholders with this run's paths.  The
+ * subdirectory for the builds is inside the working directory, so it
+ * goes first.  Caller must free the returned string.
+ */
+static char *swap_workdir(const struct rpminspect *ri, const char *s, const bool expand)
+{
+    int i = 0;
+    char *ret = NULL;
+    char *swap = NULL;
+    const char *paths[2];
+    const char *tokens[2] = { "${WORKSUBDIR}", "${WORKDIR}" };
+
+    if (s == NULL) {
+        return NULL;
+    }
+
+    ret = strdup(s);
+    assert(ret != NULL);
+    paths[0] = ri->worksubdir;
+    paths[1] = ri->workdir;
+
+    for (i = 0; i < 2; i++) {
+        if (paths[i] == NULL || *paths[i] == '\0') {
+            continue;
+        }
+
+        swap = expand ? strreplace(ret, tokens[i], paths[i]) : strreplace(ret, paths[i], tokens[i]);
+        free(ret);
+        ret = swap;
+    }
+
+    return ret;
+}
+
+/*
+ * Path of the cache file for the named inspection.  Caller must free
+ * the returned string.
+ */
+static char *cache_file(const struct rpminspect *ri, const char *inspection)
+{
+    SHA256_CTX ctx;
+    char *key = NULL;
+    char *ret = NULL;
+
+    assert(ri != NULL);
+    assert(ri->result_cache != NULL);
+    assert(ri->result_cache_key != NULL);
+    assert(inspection != NULL);
+
+    SHA256_Init(&ctx);
+    hash_string(&ctx, ri->result_cache_key);
+    hash_string(&ctx, inspection);
+    key = hex_digest(&ctx);
+
+    xasprintf(&ret, "%s/%s", ri->result_cache, key);
+    assert(ret != NULL);
+    free(key);
+
+    return ret;
+}
+
+/*
+ * Results carry a const header pointer, so map the stored name back
+ * to the matching string in the inspections table.
+ */
+static const char *result_header(const char *name)
+{
+    int i = 0;
+
+    if (!strcmp(name, NAME_DIAGNOSTICS)) {
+        return NAME_DIAGNOSTICS;
+    }
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if (!strcmp(name, inspections[i].name)) {
+            return inspections[i].name;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Read one length prefixed string from a cache file.  A length of -1
+ * is a NULL string.  Returns false if the data is malformed.
+ */
+static bool parse_string(const char **pos, const char *end, char **s)
+{
+    long len = 0;
+    char *tail = NULL;
+
+    errno = 0;
+    len = strtol(*pos, &tail, 10);
+
+    if (errno != 0 || tail == *pos || tail >= end || *tail != '\n' || len < -1) {
+        return false;
+    }
+
+    tail++;
+
+    if (len == -1) {
+        *s = NULL;
+        *pos = tail;
+        return true;
+    }
+
+    if ((end - tail) < (len + 1) || tail[len] != '\n') {
+        return false;
+    }
+
+    *s = strndup(tail, len);
+    assert(*s != NULL);
+    *pos = tail + len + 1;
+
+    return true;
+}
+
+/*
+ * Parse the cached results in data.  If ri is not NULL the results
+ * are added to it, otherwise the data is only checked.  Returns
+ * false if the data is malformed.
+ */
+static bool parse_results(struct rpminspect *ri, const char *data, const off_t len, bool *ires)
+{
+    bool ret = true;
+    int i = 0;
+    int n = 0;
+    int count = 0;
+    int severity = 0;
+    int waiverauth = 0;
+    int verb = 0;
+    int pass = 0;
+    unsigned int remedy = 0;
+    const char *pos = data;
+    const char *end = data + len;
+    char *header = NULL;
+    char *swap = NULL;
+    char *strings[5];
+    struct result_params params;
+
+    assert(data != NULL);
+
+    if (!strprefix(pos, RESULT_CACHE_FORMAT "\n")) {
+        return false;
+    }
+
+    pos += strlen(RESULT_CACHE_FORMAT) + 1;
+
+    if (sscanf(pos, "%d %d\n%n", &pass, &count, &n) != 2 || count < 0) {
+        return false;
+    }
+
+    pos += n;
+
+    if (ires) {
+        *ires = pass;
+    }
+
+    while (ret && count-- > 0) {
+        memset(strings, 0, sizeof(strings));
+        header = NULL;
+
+        if (pos >= end || sscanf(pos, "%d %d %u %d\n%n", &severity, &waiverauth, &remedy, &verb, &n) != 4) {
+            return false;
+        }
+
+        pos += n;
+        ret = parse_string(&pos, end, &header) && header != NULL && result_header(header) != NULL;
+
+        for (i = 0; ret && i < 5; i++) {
+            ret = parse_string(&pos, end, &strings[i]);
+        }
+
+        if (ret && ri != NULL) {
+            for (i = 0; i < 5; i++) {
+                swap = swap_workdir(ri, strings[i], true);
+                free(strings[i]);
+                strings[i] = swap;
+            }
+
+            init_result_params(&params);
+            params.severity = severity;
+            params.waiverauth = waiverauth;
+            params.header = result_header(header);
+            params.msg = strings[0];
+            params.details = strings[1];
+            params.remedy = remedy;
+            params.verb = verb;
+            params.noun = strings[2];
+            params.arch = strings[3];
+            params.file = strings[4];
+            add_result(ri, &params);
+        }
+
+        free(header);
+
+        for (i = 0; i < 5; i++) {
+            free(strings[i]);
+        }
+    }
+
+    return ret;
+}
+
+/* Write one length prefixed string to a cache file */
+static void write_string(FILE *fp, const char *s)
+{
+    if (s == NULL) {
+        fprintf(fp, "-1\n");
+    } else {
+        fprintf(fp, "%zu\n%s\n", strlen(s), s);
+    }
+
+    return;
+}
+
+/*
+ * Work out the cache key for the comparison in ri and load any cached
+ * results for the selected inspections.  The data needed by the
+ * inspections left to run is recomputed so extract_peers() only
+ * unpacks what they read.  Called once the packages are downloaded.
+ */
+void find_cached_results(struct rpminspect *ri)
+{
+    int i = 0;
+    off_t len = 0;
+    uint64_t tests = 0;
+    char *path = NULL;
+    char *data = NULL;
+    string_map_t *entry = NULL;
+
+    assert(ri != NULL);
+
+    /*
+     * batch mode comes through here for every after build, and the
+     * header inspections of pipelined mode add to the same map, so
+     * drop what the last comparison found even without a cache
+     */
+    free(ri->result_cache_key);
+    ri->result_cache_key = NULL;
+    free_string_map(ri->cached_results);
+    ri->cached_results = NULL;
+
+    if (ri->result_cache == NULL || ri->peers == NULL) {
+        return;
+    }
+
+    ri->result_cache_key = comparison_key(ri);
+    tests = ri->tests;
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if (!(ri->tests & inspections[i].flag) || (ri->before == NULL && !inspections[i].single_build)) {
+            continue;
+        }
+
+        path = cache_file(ri, inspections[i].name);
+        data = read_file_bytes(path, &len);
+
+        if (data != NULL && parse_results(NULL, data, len, NULL)) {
+            DEBUG_PRINT("cached results for %s in %s\n", inspections[i].name, path);
+            entry = xalloc(sizeof(*entry));
+            entry->key = strdup(inspections[i].name);
+            assert(entry->key != NULL);
+            entry->value = data;
+            HASH_ADD_KEYPTR(hh, ri->cached_results, entry->key, strlen(entry->key), entry);
+            tests &= ~inspections[i].flag;
+        } else {
+            free(data);
+        }
+
+        free(path);
+    }
+
+    ri->needs = inspection_needs(tests, ri->before == NULL);
+    return;
+}
+
+/*
+ * Add the cached results for the inspection to ri if there are any.
+ * Returns true if the results were replayed and the inspection does
+ * not need to run, with ires set to what the inspection returned.
+ */
+bool replay_cached_results(struct rpminspect *ri, const struct inspect *inspection, bool *ires)
+{
+    string_map_t *entry = NULL;
+
+    assert(ri != NULL);
+    assert(inspection != NULL);
+    assert(ires != NULL);
+
+    if (ri->cached_results == NULL) {
+        return false;
+    }
+
+    HASH_FIND_STR(ri->cached_results, inspection->name, entry);
+
+    if (entry == NULL) {
+        return false;
+    }
+
+    /* checked when loaded, so this always succeeds */
+    return parse_results(ri, entry->value, strlen(entry->value), ires);
+}
+
+/* Write one string with the working directory paths replaced */
+static void write_path_string(const struct rpminspect *ri, FILE *fp, const char *s)
+{
+    char *tmp = NULL;
+
+    tmp = swap_workdir(ri, s, false);
+    write_string(fp, tmp);
+    free(tmp);
+    return;
+}
+
+/*
+ * Write the results from first to the end of the list in the cache
+ * file format.
+ */
+static void write_results(const struct rpminspect *ri, FILE *fp, const results_entry_t *first, const bool ires)
+{
+    int count = 0;
+    const results_entry_t *result = NULL;
+
+    for (result = first; result != NULL; result = TAILQ_NEXT(result, items)) {
+        count++;
+    }
+
+    fprintf(fp, "%s\n%d %d\n", RESULT_CACHE_FORMAT, ires ? 1 : 0, count);
+
+    for (result = first; result != NULL; result = TAILQ_NEXT(result, items)) {
+        fprintf(fp, "%d %d %u %d\n", result->severity, result->waiverauth, result->remedy, result->verb);
+        write_string(fp, result->header);
+        write_path_string(ri, fp, result->msg);
+        write_path_string(ri, fp, result->details);
+        write_path_string(ri, fp, result->noun);
+        write_path_string(ri, fp, result->arch);
+        write_path_string(ri, fp, result->file);
+    }
+
+    return;
+}
+
+/*
+ * Store data as the cached results of the named inspection.  The file
+ * is written under a temporary name and renamed so concurrent runs
+ * never read a partial file.
+ */
+static void store_results(const struct rpminspect *ri, const char *inspection, const char *data)
+{
+    int fd = -1;
+    char *path = NULL;
+    char *tmp = NULL;
+    FILE *fp = NULL;
+
+    path = cache_file(ri, inspection);
+    xasprintf(&tmp, "%s.XXXXXX", path);
+    assert(tmp != NULL);
+    fd = mkstemp(tmp);
+
+    if (fd == -1) {
+        warn("*** mkstemp %s", tmp);
+        goto done;
+    }
+
+    fp = fdopen(fd, "w");
+
+    if (fp == NULL) {
+        warn("*** fdopen %s", tmp);
+        close(fd);
+        unlink(tmp);
+        goto done;
+    }
+
+    fputs(data, fp);
+
+    if (fclose(fp) != 0) {
+        warn("*** fclose %s", tmp);
+        unlink(tmp);
+        goto done;
+    }
+
+    if (rename(tmp, path) == -1) {
+        warn("*** rename %s", tmp);
+        unlink(tmp);
+    }
+
+done:
+    free(tmp);
+    free(path);
+    return;
+}
+
+/*
+ * Save the results the inspection added to ri after last, which is
+ * the final result before the inspection ran or NULL if there were
+ * none.
+ */
+void save_cached_results(struct rpminspect *ri, const struct inspect *inspection, const results_entry_t *last, const bool ires)
+{
+    char *data = NULL;
+    size_t len = 0;
+    FILE *fp = NULL;
+    const results_entry_t *first = NULL;
+
+    assert(ri != NULL);
+    assert(inspection != NULL);
+
+    if (ri->result_cache == NULL || ri->result_cache_key == NULL) {
+        return;
+    }
+
+    if (last != NULL) {
+        first = TAILQ_NEXT(last, items);
+    } else if (ri->results != NULL) {
+        first = TAILQ_FIRST(ri->results);
+    }
+
+    fp = open_memstream(&data, &len);
+
+    if (fp == NULL) {
+        warn("*** open_memstream");
+        return;
+    }
+
+    write_results(ri, fp, first, ires);
+
+    if (fclose(fp) != 0) {
+        warn("*** fclose");
+    } else {
+        store_results(ri, inspection->name, data);
+    }
+
+    free(data);
+    return;
+}
+
+/*
+ * Returns true if the inspection is selected, only reads package
+ * headers, and has no cached results, so it can run in the child
+ * process started by start_header_inspections().
+ */
+static bool runs_early(const struct rpminspect *ri, const struct inspect *inspection)
+{
+    string_map_t *entry = NULL;
+
+    if (!(ri->tests & inspection->flag) || (inspection->needs & ~NEEDS_HEADERS) != 0 || (ri->before == NULL && !inspection->single_build)) {
+        return false;
+    }
+
+    HASH_FIND_STR(ri->cached_results, inspection->name, entry);
+    return (entry == NULL);
+}
+
+/* Flush stdio and leave the child process */
+static void exit_child(const int status)
+{
+    fflush(stdout);
+    fflush(stderr);
+    _exit(status);
+}
+
+/*
+ * Run the selected inspections that only read package headers in a
+ * child process so they do not wait for the payloads to be unpacked.
+ * The child writes each inspection's name, results, and with -m the
+ * time and resources it used to a temporary file which is returned
+ * in fp.  Collect them with
+ * finish_header_inspections().  Call find_cached_results() first so
+ * inspections with cached results are left out.  Returns the child's
+ * process ID, or 0 if nothing was started.
+ */
+pid_t start_header_inspections(struct rpminspect *ri, FILE **fp)
+{
+    int i = 0;
+    bool ires = false;
+    char *data = NULL;
+    char *timing = NULL;
+    size_t len = 0;
+    FILE *mfp = NULL;
+    pid_t proc = 0;
+    results_entry_t *last = NULL;
+    results_entry_t *first = NULL;
+    struct timing_mark mark;
+    timing_entry_t used;
+
+    assert(ri != NULL);
+    assert(fp != NULL);
+
+    *fp = NULL;
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if (runs_early(ri, &inspections[i])) {
+            break;
+        }
+    }
+
+    if (inspections[i].name == NULL) {
+        return 0;
+    }
+
+    *fp = tmpfile();
+
+    if (*fp == NULL) {
+        warn("*** tmpfile");
+        return 0;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    proc = fork();
+
+    if (proc == -1) {
+        warn("*** fork");
+        fclose(*fp);
+        *fp = NULL;
+        return 0;
+    } else if (proc > 0) {
+        return proc;
+    }
+
+    /* the parent reports these results when it replays them */
+    ri->events = NULL;
+
+    for (; inspections[i].name != NULL; i++) {
+        if (!runs_early(ri, &inspections[i])) {
+            continue;
+        }
+
+        last = (ri->results == NULL) ? NULL : TAILQ_LAST(ri->results, results_s);
+        start_timing(ri, "inspection", inspections[i].name, &mark);
+        ires = inspections[i].driver(ri);
+
+        if (ri->timings != NULL) {
+            measure_timing(&mark, &used);
+            xasprintf(&timing, "%f %f %ld %lu %lu", used.wall, used.cpu, used.rss, used.files, used.commands);
+        }
+
+        mfp = open_memstream(&data, &len);
+
+        if (mfp == NULL) {
+            exit_child(EXIT_FAILURE);
+        }
+
+        first = NULL;
+
+        if (last != NULL) {
+            first = TAILQ_NEXT(last, items);
+        } else if (ri->results != NULL) {
+            first = TAILQ_FIRST(ri->results);
+        }
+
+        write_results(ri, mfp, first, ires);
+
+        if (fclose(mfp) != 0) {
+            exit_child(EXIT_FAILURE);
+        }
+
+        write_string(*fp, inspections[i].name);
+        write_string(*fp, data);
+        write_string(*fp, timing);
+        free(data);
+        free(timing);
+        data = NULL;
+        timing = NULL;
+    }
+
+    exit_child((fflush(*fp) == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+    return 0;
+}
+
+/*
+ * Wait for the child started by start_header_inspections() and add
+ * its results to ri->cached_results so they are replayed in order
+ * with the other inspections.  Results already in the result cache
+ * are kept, new ones are saved to it.  The time each inspection took
+ * in the child is added to ri->timings.  If the child failed, its
+ * inspections run as usual.
+ */
+void finish_header_inspections(struct rpminspect *ri, const pid_t proc, FILE *fp)
+{
+    int status = 0;
+    long len = 0;
+    char *data = NULL;
+    const char *pos = NULL;
+    const char *end = NULL;
+    char *name = NULL;
+    char *results = NULL;
+    char *timing = NULL;
+    string_map_t *entry = NULL;
+    timing_entry_t used;
+
+    assert(ri != NULL);
+
+    if (proc <= 0 || fp == NULL) {
+        return;
+    }
+
+    if (waitpid(proc, &status, 0) == -1) {
+        warn("*** waitpid");
+        fclose(fp);
+        return;
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        warnx(_("*** header inspection process failed, running those inspections in order"));
+        fclose(fp);
+        return;
+    }
+
+    if (fseek(fp, 0, SEEK_END) == -1 || (len = ftell(fp)) == -1 || fseek(fp, 0, SEEK_SET) == -1) {
+        warn("*** fseek");
+        fclose(fp);
+        return;
+    }
+
+    data = xalloc(len + 1);
+
+    if (fread(data, 1, len, fp) != (size_t) len) {
+        warn("*** fread");
+        len = 0;
+    }
+
+    fclose(fp);
+    pos = data;
+    end = data + len;
+
+    while (pos < end && parse_string(&pos, end, &name)) {
+        if (!parse_string(&pos, end, &results)) {
+            free(name);
+            break;
+        }
+
+        if (!parse_string(&pos, end, &timing)) {
+            free(name);
+            free(results);
+            break;
+        }
+
+        entry = NULL;
+
+        if (name != NULL) {
+            HASH_FIND_STR(ri->cached_results, name, entry);
+        }
+
+        if (name == NULL || results == NULL || entry != NULL || result_header(name) == NULL || !parse_results(NULL, results, strlen(results), NULL)) {
+            free(name);
+            free(results);
+            free(timing);
+            continue;
+        }
+
+        memset(&used, 0, sizeof(used));
+
+        if (timing != NULL && sscanf(timing, "%lf %lf %ld %lu %lu", &used.wall, &used.cpu, &used.rss, &used.files, &used.commands) == 5) {
+            add_timing(ri, "inspection", name, &used);
+        }
+
+        free(timing);
+
+        if (ri->result_cache != NULL && ri->result_cache_key != NULL) {
+            store_results(ri, name, results);
+        }
+
+        entry = xalloc(sizeof(*entry));
+        entry->key = name;
+        entry->value = results;
+        HASH_ADD_KEYPTR(hh, ri->cached_results, entry->key, strlen(entry->key), entry);
+    }
+
+    free(data);
+    return;
+}
+
+/*
+ * Digest of a command and its inputs.  The command is identified by
+ * its resolved path and the device, inode, size, and modification
+ * time of the executable, so updating the tool misses the cache.
+ * Arguments naming a regular file contribute the file's SHA-256
+ * digest rather than the path, because the same file is unpacked to
+ * a different working directory in every run.  Those arguments are
+ * flagged in files.  Returns NULL if the command cannot be found.
+ */
+static char *command_key(char **argv, const char *workdir, bool *files)
+{
+    int i = 0;
+    char *cmd = NULL;
+    char *path = NULL;
+    char *sum = NULL;
+    char *identity = NULL;
+    SHA256_CTX ctx;
+    struct stat sb;
+
+    assert(argv != NULL);
+    assert(files != NULL);
+
+    cmd = find_cmd(argv[0]);
+
+    if (cmd == NULL || stat(cmd, &sb) == -1) {
+        free(cmd);
+        return NULL;
+    }
+
+    SHA256_Init(&ctx);
+    hash_string(&ctx, RESULT_CACHE_FORMAT);
+    hash_string(&ctx, cmd);
+    xasprintf(&identity, "%ju:%ju:%jd:%jd", (uintmax_t) sb.st_dev, (uintmax_t) sb.st_ino, (intmax_t) sb.st_size, (intmax_t) sb.st_mtime);
+    hash_string(&ctx, identity);
+    free(identity);
+    free(cmd);
+
+    for (i = 1; argv[i] != NULL; i++) {
+        if (*argv[i] != '/' && workdir != NULL) {
+            xasprintf(&path, "%s/%s", workdir, argv[i]);
+        } else {
+            path = strdup(argv[i]);
+        }
+
+        assert(path != NULL);
+        files[i] = false;
+
+        if (stat(path, &sb) == 0 && S_ISREG(sb.st_mode)) {
+            sum = compute_checksum(path, &sb.st_mode, SHA256SUM);
+
+            if (sum != NULL) {
+                hash_string(&ctx, "file");
+                hash_string(&ctx, sum);
+                files[i] = true;
+                free(sum);
+            }
+        }
+
+        if (!files[i]) {
+            hash_string(&ctx, "arg");
+            hash_string(&ctx, argv[i]);
+        }
+
+        free(path);
+    }
+
+    return hex_digest(&ctx);
+}
+
+/*
+ * Like run_cmd_vp() but consults the command cache in the result
+ * cache directory first.  File arguments in the saved output are
+ * replaced with ${ARGn} placeholders so the output replayed in a
+ * later run names that run's files.
+ */
+static char *cached_run_cmd_vp(const struct rpminspect *ri, int *exitcode, const char *workdir, char **argv)
+{
+    int i = 0;
+    int fd = -1;
+    int code = 0;
+    int n = 0;
+    off_t len = 0;
+    bool *files = NULL;
+    char *key = NULL;
+    char *dir = NULL;
+    char *path = NULL;
+    char *tmp = NULL;
+    char *data = NULL;
+    char *output = NULL;
+    char *token = NULL;
+    char *swap = NULL;
+    const char *pos = NULL;
+    FILE *fp = NULL;
+    mode_t mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
+
+    assert(ri != NULL);
+    assert(argv != NULL);
+    assert(argv[0] != NULL);
+
+    if (ri->result_cache == NULL) {
+        return run_cmd_vp(exitcode, workdir, argv);
+    }
+
+    for (i = 0; argv[i] != NULL; i++);
+    files = xcalloc(i, sizeof(*files));
+    key = command_key(argv, workdir, files);
+
+    if (key == NULL) {
+        free(files);
+        return run_cmd_vp(exitcode, workdir, argv);
+    }
+
+    xasprintf(&dir, "%s/%s", ri->result_cache, COMMAND_CACHE_DIR);
+    assert(dir != NULL);
+    xasprintf(&path, "%s/%s", dir, key);
+    assert(path != NULL);
+    free(key);
+
+    /* look for a saved run */
+    data = read_file_bytes(path, &len);
+
+    if (data != NULL) {
+        pos = data;
+
+        if (strprefix(pos, RESULT_CACHE_FORMAT "\n")) {
+            pos += strlen(RESULT_CACHE_FORMAT) + 1;
+
+            if (sscanf(pos, "%d\n%n", &code, &n) == 1) {
+                pos += n;
+
+                if (parse_string(&pos, data + len, &output)) {
+                    DEBUG_PRINT("cached output for %s in %s\n", argv[0], path);
+
+                    for (i = 1; argv[i] != NULL; i++) {
+                        if (files[i] && output != NULL) {
+                            xasprintf(&token, "${ARG%d}", i);
+                            swap = strreplace(output, token, argv[i]);
+                            free(output);
+                            free(token);
+                            output = swap;
+                        }
+                    }
+
+                    if (exitcode) {
+                        *exitcode = code;
+                    }
+
+                    free(data);
+                    goto done;
+                }
+            }
+        }
+
+        free(data);
+    }
+
+    /* run it and save the result */
+    output = run_cmd_vp(&code, workdir, argv);
+
+    if (exitcode) {
+        *exitcode = code;
+    }
+
+    if (mkdirp(dir, mode)) {
+        goto done;
+    }
+
+    xasprintf(&tmp, "%s.XXXXXX", path);
+    assert(tmp != NULL);
+    fd = mkstemp(tmp);
+
+    if (fd == -1) {
+        warn("*** mkstemp %s", tmp);
+        goto done;
+    }
+
+    fp = fdopen(fd, "w");
+
+    if (fp == NULL) {
+        warn("*** fdopen %s", tmp);
+        close(fd);
+        unlink(tmp);
+        goto done;
+    }
+
+    data = (output == NULL) ? NULL : strdup(output);
+
+    for (i = 1; argv[i] != NULL; i++) {
+        if (files[i] && data != NULL) {
+            xasprintf(&token, "${ARG%d}", i);
+            swap = strreplace(data, argv[i], token);
+            free(data);
+            free(token);
+            data = swap;
+        }
+    }
+
+    fprintf(fp, "%s\n%d\n", RESULT_CACHE_FORMAT, code);
+    write_string(fp, data);
+    free(data);
+
+    if (fclose(fp) != 0) {
+        warn("*** fclose %s", tmp);
+        unlink(tmp);
+    } else if (rename(tmp, path) == -1) {
+        warn("*** rename %s", tmp);
+        unlink(tmp);
+    }
+
+done:
+    free(tmp);
+    free(path);
+    free(dir);
+    free(files);
+    return output;
+}
+
+/*
+ * Wrapper for cached_run_cmd_vp() taking varargs like run_cmd().  Use
+ * it for commands whose output depends only on the command and the
+ * files named on its command line.  Without a result cache directory
+ * this is the same as run_cmd().
+ */
+char *cached_run_cmd(const struct rpminspect *ri, int *exitcode, const char *workdir, const char *cmd, ...)
+{
+    va_list ap;
+    char *output = NULL;
+    char *element = NULL;
+    char **argv = NULL;
+    int i = 0;
+
+    assert(cmd != NULL);
+
+    argv = xcalloc(2, sizeof(*argv));
+    argv[i] = strdup(cmd);
+    assert(argv[i] != NULL);
+    i++;
+
+    va_start(ap, cmd);
+
+    while ((element = va_arg(ap, char *)) != NULL) {
+        i++;
+        argv = xrealloc(argv, sizeof(*argv) * (i + 1));
+        argv[i - 1] = strdup(element);
+        assert(argv[i - 1] != NULL);
+        argv[i] = NULL;
+    }
+
+    va_end(ap);
+
+    output = cached_run_cmd_vp(ri, exitcode, workdir, argv);
+    free_argv(argv);
+
+    return output;
+}
@@ -5,6 +5,7 @@
 
 #include <assert.h>
 #include "queue.h"
+#include "uthash.h"
 #include "rpminspect.h"
 
 /*
@@ -37,35 +38,23 @@ results_t *init_results(void)
 
     results = xalloc(sizeof(*results));
     TAILQ_INIT(results);
+    results->arena = new_arena(RESULTS_ARENA_BLOCK);
     return results;
 }
 
 /*
- * Free memory associated with an results_t list.
+ * Free memory associated with an results_t list.  The entries, their
+ * strings, and the per-header totals all live in the results arena
+ * and are released together.
  */
 void free_results(results_t *results)
 {
-    results_entry_t *entry = NULL;
-
     if (results == NULL) {
         return;
     }
 
-    while (!TAILQ_EMPTY(results)) {
-        entry = TAILQ_FIRST(results);
-        TAILQ_REMOVE(results, entry, items);
-        free(entry->msg);
-        free(entry->details);
-        free(entry->noun);
-        free(entry->arch);
-        free(entry->file);
-
-        /* these are all consts */
-        entry->header = NULL;
-
-        free(entry);
-    }
-
+    HASH_CLEAR(hh, results->headers);
+    free_arena(results->arena);
     free(results);
 
     return;
@@ -98,15 +87,18 @@ void debug_print_result(const results_entry_t *result)
  * members of the results_entry_t struct.  severity, waiverauth, header, and
  * msg are required.
  *
- * Strings passed in become results_entry_t members and will be freed when
- * the results_t is freed later.  Keep that in mind when building and
- * passing strings to this function.
+ * Strings passed in are copied in to the results arena and released when
+ * the results_t is freed, so the caller still owns and frees its own
+ * strings.  The header, noun, and arch strings come from a small set
+ * and are interned so each distinct string is stored once.  Nearly
+ * every file is different, so file is copied like msg.
  *
  * Pass NULL for any optional strings that you have no data for.
  */
 void add_result_entry(results_t **results, struct result_params *params)
 {
     results_entry_t *entry = NULL;
+    results_header_t *hentry = NULL;
 
     assert(params != NULL);
     assert(params->severity >= 0);
@@ -116,36 +108,37 @@ void add_result_entry(results_t **results, struct result_params *params)
         *results = init_results();
     }
 
-    entry = xalloc(sizeof(*entry));
+    entry = arena_alloc((*results)->arena, sizeof(*entry));
 
     entry->severity = params->severity;
     entry->waiverauth = params->waiverauth;
-    entry->header = params->header;
-
-    if (params->msg != NULL) {
-        entry->msg = strdup(params->msg);
-    }
-
-    if (params->details != NULL) {
-        entry->details = strdup(params->details);
-    }
-
+    entry->header = arena_intern((*results)->arena, params->header);
+    entry->msg = arena_strdup((*results)->arena, params->msg);
+    entry->details = arena_strdup((*results)->arena, params->details);
     entry->remedy = params->remedy;
     entry->verb = params->verb;
+    entry->noun = arena_intern((*results)->arena, params->noun);
+    entry->arch = arena_intern((*results)->arena, params->arch);
+    entry->file = arena_strdup((*results)->arena, params->file);
 
-    if (params->noun != NULL) {
-        entry->noun = strdup(params->noun);
-    }
+    TAILQ_INSERT_TAIL(*results, entry, items);
 
-    if (params->arch != NULL) {
-        entry->arch = strdup(params->arch);
-    }
+    /* update the totals for this header */
+    HASH_FIND_STR((*results)->headers, entry->header, hentry);
 
-    if (params->file != NULL) {
-        entry->file = strdup(params->file);
+    if (hentry == NULL) {
+        hentry = arena_alloc((*results)->arena, sizeof(*hentry));
+        hentry->header = entry->header;
+        hentry->worst = entry->severity;
+        HASH_ADD_KEYPTR(hh, (*results)->headers, hentry->header, strlen(hentry->header), hentry);
+    } else if (entry->severity > hentry->worst) {
+        hentry->worst = entry->severity;
     }
 
-    TAILQ_INSERT_TAIL(*results, entry, items);
+    hentry->count++;
+
+    /* stream it if the run was asked to (-e) */
+    emit_result_event(params);
     return;
 }
 
@@ -166,13 +159,31 @@ void add_result(struct rpminspect *ri, struct result_params *params)
     return;
 }
 
+/*
+ * Returns the totals for the results of the named inspection, or NULL
+ * if there are no results for it.
+ */
+results_header_t *get_results_header(const results_t *results, const char *header)
+{
+    results_header_t *hentry = NULL;
+
+    assert(header != NULL);
+
+    if (results == NULL) {
+        return NULL;
+    }
+
+    HASH_FIND_STR(results->headers, header, hentry);
+    return hentry;
+}
+
 /*
  * Returns true if all the results for the named inspection are
  * suppressed.
  */
 bool suppressed_results(const results_t *results, const char *header, const severity_t suppress)
 {
-    results_entry_t *result = NULL;
+    const results_header_t *hentry = NULL;
 
     assert(results != NULL);
     assert(header != NULL);
@@ -182,11 +193,6 @@ bool suppressed_results(const results_t *results, const char *header, const seve
         return false;
     }
 
-    TAILQ_FOREACH(result, results, items) {
-        if (!strcmp(header, result->header) && result->severity >= suppress) {
-            return false;
-        }
-    }
-
-    return true;
+    hentry = get_results_header(results, header);
+    return (hentry == NULL || hentry->worst < suppress);
 }
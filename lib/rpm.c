@@ -4,10 +4,13 @@
  */
 
 #include <libgen.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <stdbool.h>
 #include <assert.h>
 #include <err.h>
 #include <rpm/rpmlib.h>
+#include <rpm/rpmio.h>
 #include <rpm/rpmts.h>
 #include <rpm/header.h>
 #include <rpm/rpmmacro.h>
@@ -35,12 +38,78 @@ int init_librpm(struct rpminspect *ri)
     return result;
 }
 
+/*
+ * Read the RPM header from an already opened package and add it to
+ * the header cache.  On success the file offset of fd is left at the
+ * start of the payload and that offset is recorded in the cache entry
+ * so the payload can be read later without parsing the lead,
+ * signature, and header again.  Returns the new cache entry or NULL
+ * on failure.
+ */
+static header_cache_t *read_rpm_header(struct rpminspect *ri, FD_t fd, const char *pkg, const char *bpkg)
+{
+    rpmts ts;
+    rpmRC result;
+    header_cache_t *hentry = NULL;
+
+    assert(ri != NULL);
+    assert(fd != NULL);
+    assert(pkg != NULL);
+    assert(bpkg != NULL);
+
+    hentry = xalloc(sizeof(*hentry));
+    hentry->pkg = strdup(bpkg);
+    assert(hentry->pkg != NULL);
+
+    ts = rpmtsCreate();
+    rpmtsSetVSFlags(ts, _RPMVSF_NODIGESTS | _RPMVSF_NOSIGNATURES);
+    result = rpmReadPackageFile(ts, fd, pkg, &hentry->hdr);
+    rpmtsFree(ts);
+
+    if (result != RPMRC_OK) {
+        free(hentry->pkg);
+        free(hentry);
+        return NULL;
+    }
+
+    /* librpm reads no further than the end of the header */
+    hentry->path = strdup(pkg);
+    assert(hentry->path != NULL);
+    hentry->payload = lseek(Fileno(fd), 0, SEEK_CUR);
+
+    HASH_ADD_KEYPTR(hh, ri->header_cache, hentry->pkg, strlen(hentry->pkg), hentry);
+    return hentry;
+}
+
+/*
+ * Open the named package with librpm.  The caller must Fclose() the
+ * returned FD_t.  Returns NULL on failure.
+ */
+static FD_t open_rpm(const char *pkg)
+{
+    FD_t fd;
+
+    assert(pkg != NULL);
+
+    fd = Fopen(pkg, "r.ufdio");
+
+    if (fd == NULL || Ferror(fd)) {
+        warnx(_("*** Fopen failed for %s: %s"), pkg, Fstrerror(fd));
+
+        if (fd) {
+            Fclose(fd);
+        }
+
+        return NULL;
+    }
+
+    return fd;
+}
+
 /* Return an RPM header struct for the given package filename. */
 Header get_rpm_header(struct rpminspect *ri, const char *pkg)
 {
-    rpmts ts;
     FD_t fd;
-    rpmRC result;
     char *head = NULL;
     char *headptr = NULL;
     char *bpkg = NULL;
@@ -65,41 +134,133 @@ Header get_rpm_header(struct rpminspect *ri, const char *pkg)
     }
 
     /* No?  Then read the header in, cache it, and return it. */
-    fd = Fopen(pkg, "r.ufdio");
-
-    if (fd == NULL || Ferror(fd)) {
-        warnx(_("*** Fopen failed for %s: %s"), pkg, Fstrerror(fd));
-
-        if (fd) {
-            Fclose(fd);
-        }
+    fd = open_rpm(pkg);
 
+    if (fd == NULL) {
         free(headptr);
         return NULL;
     }
 
-    hentry = xalloc(sizeof(*hentry));
-    hentry->pkg = strdup(bpkg);
-    assert(hentry->pkg != NULL);
-
-    ts = rpmtsCreate();
-    rpmtsSetVSFlags(ts, _RPMVSF_NODIGESTS | _RPMVSF_NOSIGNATURES);
-    result = rpmReadPackageFile(ts, fd, pkg, &hentry->hdr);
-    rpmtsFree(ts);
+    hentry = read_rpm_header(ri, fd, pkg, bpkg);
     Fclose(fd);
+    free(headptr);
 
-    if (result != RPMRC_OK) {
-        free(hentry->pkg);
-        free(hentry);
-        free(headptr);
+    if (hentry == NULL) {
         return NULL;
     }
 
-    free(headptr);
-    HASH_ADD_KEYPTR(hh, ri->header_cache, hentry->pkg, strlen(hentry->pkg), hentry);
     return hentry->hdr;
 }
 
+/*
+ * Open the named package and return a file descriptor positioned at
+ * the start of the compressed payload.  The lead, signature, and
+ * header are not read again if the header was already read by
+ * get_rpm_header(); the cached payload offset is used instead.  If
+ * the header is not cached yet, it is read and cached here from the
+ * same descriptor that is then handed back for the payload.  Either
+ * way the package is read exactly once from start to finish.
+ *
+ * The caller must close() the returned descriptor.  Returns -1 on
+ * failure.
+ */
+int open_rpm_payload(struct rpminspect *ri, const char *pkg)
+{
+    int r = -1;
+    FD_t fd;
+    char *head = NULL;
+    char *bpkg = NULL;
+    header_cache_t *hentry = NULL;
+
+    assert(ri != NULL);
+    assert(pkg != NULL);
+
+    head = strdup(pkg);
+    assert(head != NULL);
+    bpkg = basename(head);
+
+    if (ri->header_cache != NULL) {
+        HASH_FIND_STR(ri->header_cache, bpkg, hentry);
+    }
+
+    /*
+     * The cache is keyed on the basename, so a cached entry read from
+     * a different path (e.g., the same NVR in the before and after
+     * build) cannot be trusted for the payload offset.  Fall back to
+     * letting the caller read the package some other way.
+     */
+    if (hentry != NULL && hentry->payload > 0 && !strcmp(hentry->path, pkg)) {
+        /* skip straight to the payload */
+        r = open(pkg, O_RDONLY | O_CLOEXEC);
+
+        if (r == -1) {
+            warn("*** open %s", pkg);
+        } else if (lseek(r, hentry->payload, SEEK_SET) == -1) {
+            warn("*** lseek %s", pkg);
+            close(r);
+            r = -1;
+        }
+    } else if (hentry == NULL) {
+        /* read the header and continue from the same descriptor */
+        fd = open_rpm(pkg);
+
+        if (fd != NULL) {
+            hentry = read_rpm_header(ri, fd, pkg, bpkg);
+
+            if (hentry != NULL && hentry->payload > 0) {
+                /* the duplicate shares the file offset */
+                r = fcntl(Fileno(fd), F_DUPFD_CLOEXEC, 0);
+
+                if (r == -1) {
+                    warn("*** fcntl");
+                }
+            }
+
+            Fclose(fd);
+        }
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (r != -1 && posix_fadvise(r, 0, 0, POSIX_FADV_SEQUENTIAL) != 0) {
+        DEBUG_PRINT("posix_fadvise failed for %s\n", pkg);
+    }
+#endif
+
+    free(head);
+    return r;
+}
+
+/*
+ * Drop the cached header that was read from the named package.  A
+ * header cached for a package of the same name read from somewhere
+ * else is kept.  Used by batch mode to forget the after build while
+ * keeping the before build headers, wherever the after build lives.
+ */
+void uncache_rpm_header(struct rpminspect *ri, const char *pkg)
+{
+    char *head = NULL;
+    header_cache_t *hentry = NULL;
+
+    assert(ri != NULL);
+    assert(pkg != NULL);
+
+    head = strdup(pkg);
+    assert(head != NULL);
+    HASH_FIND_STR(ri->header_cache, basename(head), hentry);
+    free(head);
+
+    if (hentry == NULL || hentry->path == NULL || strcmp(hentry->path, pkg)) {
+        return;
+    }
+
+    HASH_DEL(ri->header_cache, hentry);
+    free(hentry->pkg);
+    free(hentry->path);
+    headerFree(hentry->hdr);
+    free(hentry);
+    return;
+}
+
 /*
  * Get and return the named RPM header tag as a string.
  */
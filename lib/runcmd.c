@@ -18,6 +18,7 @@
 #include <limits.h>
 
 #include "rpminspect.h"
+#include "internal/probes.h"
 
 #define RD STDIN_FILENO
 #define WR STDOUT_FILENO
@@ -189,6 +190,7 @@ char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
     }
 
     /* run the command */
+    RI_PROBE1(command__start, cmd);
     proc = fork();
 
     if (proc == 0) {
@@ -220,6 +222,7 @@ char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
     } else if (proc == -1) {
         /* failure */
         warn("*** fork");
+        RI_PROBE2(command__done, cmd, -1);
 
         if (close(pfd[RD]) == -1) {
             warn("*** close");
@@ -229,6 +232,8 @@ char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
             warn("*** close");
         }
     } else {
+        count_timed_command();
+
         /* close the pipe */
         if (close(pfd[WR]) == -1) {
             warn("*** close");
@@ -279,6 +284,8 @@ char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
             warn("*** waitpid");
         }
 
+        RI_PROBE2(command__done, cmd, status);
+
         if (WIFEXITED(status)) {
             if (exitcode) {
                 *exitcode = WEXITSTATUS(status);
@@ -6,13 +6,53 @@
 #include <assert.h>
 #include <err.h>
 #include <fnmatch.h>
+#include "uthash.h"
 #include "rpminspect.h"
 
+/*
+ * Return the security list entries whose package, version, and
+ * release patterns match the given package, indexed by path.  Those
+ * three patterns are the same for every file in a package, so they
+ * are matched once per package rather than once per file.
+ */
+static vendor_index_t *get_package_secrules(struct rpminspect *ri, const char *name, const char *version, const char *release)
+{
+    char *nvr = NULL;
+    int flags = FNM_NOESCAPE;
+    secrule_pkg_t *pkg = NULL;
+    security_entry_t *sentry = NULL;
+
+    xasprintf(&nvr, "%s\n%s\n%s", name, version, release);
+    assert(nvr != NULL);
+    HASH_FIND_STR(ri->secrule_pkgs, nvr, pkg);
+
+    if (pkg != NULL) {
+        free(nvr);
+        return pkg->paths;
+    }
+
+    pkg = xalloc(sizeof(*pkg));
+    pkg->nvr = nvr;
+    pkg->paths = new_vendor_index(true);
+
+    TAILQ_FOREACH(sentry, ri->security, items) {
+        if (!fnmatch(sentry->pkg, name, flags) && !fnmatch(sentry->ver, version, flags) && !fnmatch(sentry->rel, release, flags)) {
+            vendor_index_add(pkg->paths, sentry->path, sentry);
+        }
+    }
+
+    HASH_ADD_KEYPTR(hh, ri->secrule_pkgs, pkg->nvr, strlen(pkg->nvr), pkg);
+    return pkg->paths;
+}
+
 /*
  * Returns NULL if the path is not matched, which means the result
  * should be reported per default rules.  If it is found, the
  * security_entry_t for the match is returned and the caller can take
- * appropriate reporting action.
+ * appropriate reporting action.  The first entry in the security list
+ * matching the path, package, version, and release wins.  The answer
+ * is saved on the file since several inspections ask for the same
+ * file.
  */
 security_entry_t *get_secrule_by_path(struct rpminspect *ri, const rpmfile_entry_t *file)
 {
@@ -20,17 +60,18 @@ security_entry_t *get_secrule_by_path(struct rpminspect *ri, const rpmfile_entry
     const char *version = NULL;
     const char *release = NULL;
     security_entry_t *sentry = NULL;
-    int flags = FNM_NOESCAPE;
-    int w = -1;
-    int x = -1;
-    int y = -1;
-    int z = -1;
+    rpmfile_entry_t *memo = (rpmfile_entry_t *) file;
 
     assert(ri != NULL);
     assert(file != NULL);
     assert(file->rpm_header != NULL);
     assert(file->localpath != NULL);
 
+    /* looked up before */
+    if (file->has_secrule != 0) {
+        return file->secrule;
+    }
+
     /* initialize the security table */
     if (!ri->security_initialized) {
         if (!init_security(ri)) {
@@ -43,31 +84,34 @@ security_entry_t *get_secrule_by_path(struct rpminspect *ri, const rpmfile_entry
     version = headerGetString(file->rpm_header, RPMTAG_VERSION);
     release = headerGetString(file->rpm_header, RPMTAG_RELEASE);
 
-    /* try to find a secrule */
-    TAILQ_FOREACH(sentry, ri->security, items) {
-        w = x = y = z = -1;
-        w = fnmatch(sentry->path, file->localpath, flags);
-
-        if (name) {
-            x = fnmatch(sentry->pkg, name, flags);
-        }
+    /* try to find a secrule, every field has to match */
+    if (name && version && release) {
+        sentry = vendor_index_find(get_package_secrules(ri, name, version, release), file->localpath);
+    }
 
-        if (version) {
-            y = fnmatch(sentry->ver, version, flags);
-        }
+    /* the cached answer does not change what the caller sees of the file */
+    memo->secrule = sentry;
+    memo->has_secrule = (sentry == NULL) ? -1 : 1;
 
-        if (release) {
-            z = fnmatch(sentry->rel, release, flags);
-        }
+    return sentry;
+}
 
-        if (w == 0 && x == 0 && y == 0 && z == 0) {
-            /* match found */
-            return sentry;
-        }
+/*
+ * Free the per-package security rule indexes.
+ */
+void free_secrule_pkgs(secrule_pkg_t *pkgs)
+{
+    secrule_pkg_t *pkg = NULL;
+    secrule_pkg_t *tmp_pkg = NULL;
+
+    HASH_ITER(hh, pkgs, pkg, tmp_pkg) {
+        HASH_DEL(pkgs, pkg);
+        free(pkg->nvr);
+        free_vendor_index(pkg->paths);
+        free(pkg);
     }
 
-    /* no match found */
-    return NULL;
+    return;
 }
 
 /*
@@ -79,7 +123,6 @@ severity_t get_secrule_result_severity(struct rpminspect *ri, const rpmfile_entr
 {
     security_entry_t *sentry = NULL;
     secrule_t *srule = NULL;
-    secrule_t *tmp_srule = NULL;
 
     assert(ri != NULL);
     assert(file != NULL);
@@ -93,10 +136,10 @@ severity_t get_secrule_result_severity(struct rpminspect *ri, const rpmfile_entr
     }
 
     /* find the rule for this type */
-    HASH_ITER(hh, sentry->rules, srule, tmp_srule) {
-        if (srule->type == type) {
-            return srule->severity;
-        }
+    HASH_FIND_INT(sentry->rules, &type, srule);
+
+    if (srule != NULL) {
+        return srule->severity;
     }
 
     /* nothing found for this type, default result */
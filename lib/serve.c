@@ -0,0 +1,478 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/**
+ * @file serve.c
+ * @brief Service mode over a local Unix domain socket.
+ * @copyright LGPL-3.0-or-later
+ *
+ * The server loads the expensive parts of the program once and then
+ * forks for every request it receives.  A request is the command line
+ * and working directory of a client along with its stdout and stderr
+ * descriptors.  The job writes directly to the client's descriptors
+ * and the server sends back the exit code when the job finishes.
+ *
+ * On the socket a request is a uint32_t length in network byte order
+ * sent with the two descriptors attached, followed by that many bytes
+ * holding the working directory and each argument as NUL terminated
+ * strings.  The reply is the exit code as a uint32_t in network byte
+ * order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+#include <err.h>
+#include <limits.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+
+#include "rpminspect.h"
+
+/*
+ * Fill in a sockaddr_un for the given path.  Returns false if the path
+ * is too long for a socket address.
+ */
+static bool socket_address(const char *path, struct sockaddr_un *addr)
+{
+    assert(path != NULL);
+    assert(addr != NULL);
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        warnx(_("*** socket path too long: %s"), path);
+        return false;
+    }
+
+    strcpy(addr->sun_path, path);
+    return true;
+}
+
+/*
+ * Read exactly len bytes.  Returns false on error or end of file.
+ */
+static bool read_all(int fd, void *buf, size_t len)
+{
+    ssize_t n = 0;
+    char *pos = buf;
+
+    while (len > 0) {
+        n = read(fd, pos, len);
+
+        if (n == -1 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+
+        pos += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+/*
+ * Write exactly len bytes.  Returns false on error.
+ */
+static bool write_all(int fd, const void *buf, size_t len)
+{
+    ssize_t n = 0;
+    const char *pos = buf;
+
+    while (len > 0) {
+        n = write(fd, pos, len);
+
+        if (n == -1 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+
+        pos += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+/*
+ * Receive the request header and the client's stdout and stderr
+ * descriptors.  Returns the payload length or 0 on failure.
+ */
+static uint32_t receive_header(int sock, int *fds)
+{
+    uint32_t len = 0;
+    ssize_t n = 0;
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg = NULL;
+    union {
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    assert(fds != NULL);
+
+    memset(&msg, 0, sizeof(msg));
+    memset(&control, 0, sizeof(control));
+    iov.iov_base = &len;
+    iov.iov_len = sizeof(len);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    do {
+        n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC | MSG_WAITALL);
+    } while (n == -1 && errno == EINTR);
+
+    if (n != sizeof(len)) {
+        warnx(_("*** short request header"));
+        return 0;
+    }
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+
+    if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+        warnx(_("*** request is missing the output descriptors"));
+        return 0;
+    }
+
+    memcpy(fds, CMSG_DATA(cmsg), 2 * sizeof(int));
+    len = ntohl(len);
+
+    if (len == 0 || len > SERVE_MAX_REQUEST) {
+        warnx(_("*** invalid request length %u"), len);
+        close(fds[0]);
+        close(fds[1]);
+        return 0;
+    }
+
+    return len;
+}
+
+/*
+ * Handle one connection.  The job runs in its own process so the exit
+ * code can be reported even if the job exits through err() or errx().
+ */
+static void handle_request(int sock, int (*job)(int, char **))
+{
+    int fds[2];
+    uint32_t len = 0;
+    uint32_t code = RI_PROGRAM_ERROR;
+    char *payload = NULL;
+    char *pos = NULL;
+    char **argv = NULL;
+    int argc = 0;
+    int status = 0;
+    pid_t proc = 0;
+
+    len = receive_header(sock, fds);
+
+    if (len == 0) {
+        return;
+    }
+
+    /* the request must end with a NUL so every string is terminated */
+    payload = xalloc(len);
+
+    if (!read_all(sock, payload, len) || payload[len - 1] != '\0') {
+        warnx(_("*** truncated request"));
+        goto done;
+    }
+
+    /* first string is the working directory, the rest are the arguments */
+    argv = xcalloc(len + 1, sizeof(*argv));
+    pos = payload + strlen(payload) + 1;
+
+    while (pos < payload + len) {
+        argv[argc++] = pos;
+        pos += strlen(pos) + 1;
+    }
+
+    if (argc == 0) {
+        warnx(_("*** request has no arguments"));
+        goto done;
+    }
+
+    proc = fork();
+
+    if (proc == 0) {
+        /* job writes straight to the client's stdout and stderr */
+        if (dup2(fds[0], STDOUT_FILENO) == -1 || dup2(fds[1], STDERR_FILENO) == -1) {
+            _exit(RI_PROGRAM_ERROR);
+        }
+
+        close(fds[0]);
+        close(fds[1]);
+        close(sock);
+
+        if (chdir(payload) == -1) {
+            err(RI_PROGRAM_ERROR, "*** chdir %s", payload);
+        }
+
+        exit(job(argc, argv));
+    } else if (proc == -1) {
+        warn("*** fork");
+        goto done;
+    }
+
+    while (waitpid(proc, &status, 0) == -1) {
+        if (errno != EINTR) {
+            warn("*** waitpid");
+            goto done;
+        }
+    }
+
+    if (WIFEXITED(status)) {
+        code = WEXITSTATUS(status);
+    }
+
+done:
+    close(fds[0]);
+    close(fds[1]);
+    code = htonl(code);
+
+    if (!write_all(sock, &code, sizeof(code))) {
+        warn("*** write");
+    }
+
+    free(argv);
+    free(payload);
+    return;
+}
+
+/*
+ * Listen on the Unix domain socket at path and run job for every
+ * request received.  Each connection is handled in a child process
+ * forked from the already warmed up server.  If refresh is not NULL
+ * it is called in the server whenever no request arrived for
+ * SERVE_IDLE_REFRESH seconds so it can reload preloaded state without
+ * holding up a request.  Jobs must cope with state that went stale
+ * since.  Only returns on error.
+ */
+int serve(const char *path, int (*job)(int, char **), void (*refresh)(void))
+{
+    int sock = -1;
+    int conn = -1;
+    int r = 0;
+    pid_t proc = 0;
+    mode_t mask = 0;
+    struct sockaddr_un addr;
+    struct pollfd pfd;
+    struct stat sb;
+
+    assert(path != NULL);
+    assert(job != NULL);
+
+    if (!socket_address(path, &addr)) {
+        return RI_PROGRAM_ERROR;
+    }
+
+    /* remove a stale socket from an earlier server */
+    if (lstat(path, &sb) == 0 && S_ISSOCK(sb.st_mode) && unlink(path) == -1) {
+        warn("*** unlink %s", path);
+        return RI_PROGRAM_ERROR;
+    }
+
+    sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (sock == -1) {
+        warn("*** socket");
+        return RI_PROGRAM_ERROR;
+    }
+
+    /* only the user running the server may submit jobs */
+    mask = umask(S_IRWXG | S_IRWXO | S_IXUSR);
+    r = bind(sock, (struct sockaddr *) &addr, sizeof(addr));
+    umask(mask);
+
+    if (r == -1) {
+        warn("*** bind %s", path);
+        close(sock);
+        return RI_PROGRAM_ERROR;
+    }
+
+    if (listen(sock, SOMAXCONN) == -1) {
+        warn("*** listen %s", path);
+        close(sock);
+        return RI_PROGRAM_ERROR;
+    }
+
+    /* connection handlers are reaped automatically */
+    signal(SIGCHLD, SIG_IGN);
+
+    while (1) {
+        pfd.fd = sock;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        r = poll(&pfd, 1, (refresh == NULL) ? -1 : (SERVE_IDLE_REFRESH * 1000));
+
+        if (r == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            warn("*** poll");
+            break;
+        } else if (r == 0) {
+            refresh();
+            continue;
+        }
+
+        conn = accept(sock, NULL, NULL);
+
+        if (conn == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            warn("*** accept");
+            break;
+        }
+
+        fflush(NULL);
+        proc = fork();
+
+        if (proc == 0) {
+            close(sock);
+            signal(SIGCHLD, SIG_DFL);
+            handle_request(conn, job);
+            close(conn);
+            _exit(RI_SUCCESS);
+        } else if (proc == -1) {
+            warn("*** fork");
+        }
+
+        close(conn);
+    }
+
+    close(sock);
+    return RI_PROGRAM_ERROR;
+}
+
+/*
+ * Send the command line to the server listening at path and wait for
+ * it to finish.  The server writes the job output to this process's
+ * stdout and stderr.  Returns the exit code of the job.
+ */
+int serve_request(const char *path, int argc, char **argv)
+{
+    int i = 0;
+    int sock = -1;
+    int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+    uint32_t len = 0;
+    uint32_t code = 0;
+    size_t size = 0;
+    char *payload = NULL;
+    char *pos = NULL;
+    char cwd[PATH_MAX + 1];
+    struct sockaddr_un addr;
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg = NULL;
+    union {
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    assert(path != NULL);
+    assert(argv != NULL);
+
+    if (!socket_address(path, &addr)) {
+        return RI_PROGRAM_ERROR;
+    }
+
+    memset(cwd, '\0', sizeof(cwd));
+
+    if (getcwd(cwd, PATH_MAX) == NULL) {
+        err(RI_PROGRAM_ERROR, "*** getcwd");
+    }
+
+    /* working directory followed by the arguments */
+    size = strlen(cwd) + 1;
+
+    for (i = 0; i < argc; i++) {
+        size += strlen(argv[i]) + 1;
+    }
+
+    if (size > SERVE_MAX_REQUEST) {
+        warnx(_("*** command line too long to send to %s"), path);
+        return RI_PROGRAM_ERROR;
+    }
+
+    payload = xalloc(size);
+    pos = stpcpy(payload, cwd) + 1;
+
+    for (i = 0; i < argc; i++) {
+        pos = stpcpy(pos, argv[i]) + 1;
+    }
+
+    sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (sock == -1) {
+        warn("*** socket");
+        free(payload);
+        return RI_PROGRAM_ERROR;
+    }
+
+    if (connect(sock, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+        warn("*** connect %s", path);
+        close(sock);
+        free(payload);
+        return RI_PROGRAM_ERROR;
+    }
+
+    /* output written so far must not end up after the job output */
+    fflush(NULL);
+
+    /* send the length with our stdout and stderr attached */
+    len = htonl(size);
+    memset(&msg, 0, sizeof(msg));
+    memset(&control, 0, sizeof(control));
+    iov.iov_base = &len;
+    iov.iov_len = sizeof(len);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if (sendmsg(sock, &msg, 0) != sizeof(len) || !write_all(sock, payload, size)) {
+        warn("*** unable to send request to %s", path);
+        close(sock);
+        free(payload);
+        return RI_PROGRAM_ERROR;
+    }
+
+    free(payload);
+
+    /* wait for the exit code */
+    if (!read_all(sock, &code, sizeof(code))) {
+        warnx(_("*** no reply from %s"), path);
+        close(sock);
+        return RI_PROGRAM_ERROR;
+    }
+
+    close(sock);
+    return ntohl(code);
+}
@@ -0,0 +1,1286 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/**
+ * @file snapshot.c
+ * @brief Compiled configuration snapshots (-K).
+ * @copyright LGPL-3.0-or-later
+ *
+ * A snapshot holds the configuration as it stands after the main
+ * configuration file and the profiles are read, along with the
+ * fileinfo, capabilities, rebaseable, politics, security, and icons
+ * vendor data for one product release.  Passing a snapshot with -c
+ * loads all of that without reading any YAML, JSON, DSON, or TOML
+ * file and without tokenizing the vendor data files.
+ *
+ * The file is a fixed size header followed by sections.  The header
+ * holds the offset of each section so the vendor data sections can be
+ * decoded on demand from the mapped file, the same way init_fileinfo()
+ * and friends read their files only when an inspection asks.  Values
+ * are written in host byte order:
+ *
+ *     number     uint32_t or uint64_t
+ *     string     uint32_t length, the bytes, and a NUL (SNAPSHOT_NULL
+ *                as the length means NULL)
+ *     list       uint32_t count (SNAPSHOT_NULL means NULL) and strings
+ *     map        uint32_t count and key/value strings
+ *
+ * A snapshot records the files it was built from.  If any of them
+ * changed, or the snapshot was written by a different version of
+ * rpminspect or for a different profile, it is not used and the
+ * original configuration file is read instead.  A local configuration
+ * file in the current directory is never part of a snapshot, it is
+ * read on top of it at run time as usual.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+#include <err.h>
+#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rpminspect.h"
+#include "uthash.h"
+#include "parallel.h"
+
+/* build options that change struct rpminspect */
+#define SNAPSHOT_FEATURE_MODULARITYLABEL (1 << 0)
+#define SNAPSHOT_FEATURE_LIBCAP          (1 << 1)
+#define SNAPSHOT_FEATURE_ANNOCHECK       (1 << 2)
+
+/* written to detect a snapshot from a host with another byte order */
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+
+/* magic, format, features, byte order, section count, section offsets */
+#define SNAPSHOT_HEADER_SIZE (SNAPSHOT_MAGIC_LEN + (4 * sizeof(uint32_t)) + (SNAPSHOT_SECTIONS * sizeof(uint64_t)))
+
+/* length or count written for NULL */
+#define SNAPSHOT_NULL UINT32_MAX
+
+/* A snapshot in use, the file stays mapped for the vendor data */
+struct snapshot {
+    char *path;
+    void *data;
+    size_t size;
+    char *release;                          /* product release of the vendor data */
+    uint64_t sections[SNAPSHOT_SECTIONS];   /* offset of each section, 0 if absent */
+};
+
+/* Position in a mapped snapshot */
+struct cursor {
+    const char *data;
+    size_t size;
+    size_t pos;
+    bool bad;
+};
+
+static uint32_t features(void)
+{
+    uint32_t r = 0;
+
+#ifdef _HAVE_MODULARITYLABEL
+    r |= SNAPSHOT_FEATURE_MODULARITYLABEL;
+#endif
+#ifdef _WITH_LIBCAP
+    r |= SNAPSHOT_FEATURE_LIBCAP;
+#endif
+#ifdef _WITH_ANNOCHECK
+    r |= SNAPSHOT_FEATURE_ANNOCHECK;
+#endif
+
+    return r;
+}
+
+/*
+ * Writing
+ */
+
+static void put_u32(FILE *fp, uint32_t v)
+{
+    fwrite(&v, sizeof(v), 1, fp);
+    return;
+}
+
+static void put_u64(FILE *fp, uint64_t v)
+{
+    fwrite(&v, sizeof(v), 1, fp);
+    return;
+}
+
+static void put_str(FILE *fp, const char *s)
+{
+    size_t len = 0;
+
+    if (s == NULL) {
+        put_u32(fp, SNAPSHOT_NULL);
+        return;
+    }
+
+    len = strlen(s);
+    put_u32(fp, len);
+    fwrite(s, 1, len + 1, fp);
+    return;
+}
+
+static void put_list(FILE *fp, const string_list_t *list)
+{
+    string_entry_t *entry = NULL;
+
+    if (list == NULL) {
+        put_u32(fp, SNAPSHOT_NULL);
+        return;
+    }
+
+    put_u32(fp, list_len(list));
+
+    TAILQ_FOREACH(entry, list, items) {
+        put_str(fp, entry->data);
+    }
+
+    return;
+}
+
+static void put_map(FILE *fp, string_map_t *map)
+{
+    string_map_t *entry = NULL;
+    string_map_t *tmp_entry = NULL;
+
+    put_u32(fp, HASH_COUNT(map));
+
+    HASH_ITER(hh, map, entry, tmp_entry) {
+        put_str(fp, entry->key);
+        put_str(fp, entry->value);
+    }
+
+    return;
+}
+
+static void put_list_map(FILE *fp, string_list_map_t *map)
+{
+    string_list_map_t *entry = NULL;
+    string_list_map_t *tmp_entry = NULL;
+
+    put_u32(fp, HASH_COUNT(map));
+
+    HASH_ITER(hh, map, entry, tmp_entry) {
+        put_str(fp, entry->key);
+        put_list(fp, entry->value);
+    }
+
+    return;
+}
+
+/* Record a file the snapshot depends on */
+static void put_source(FILE *fp, const char *path)
+{
+    struct stat sb;
+
+    memset(&sb, 0, sizeof(sb));
+
+    if (stat(path, &sb) == -1) {
+        sb.st_size = -1;
+    }
+
+    put_str(fp, path);
+    put_u64(fp, sb.st_size);
+    put_u64(fp, sb.st_mtim.tv_sec);
+    put_u64(fp, sb.st_mtim.tv_nsec);
+    return;
+}
+
+static void put_config(FILE *fp, const struct rpminspect *ri)
+{
+    unsigned int i = 0;
+    unsigned int n = 0;
+    desktop_skips_t *ds = NULL;
+    desktop_skips_t *tmp_ds = NULL;
+    deprule_ignore_map_t *drentry = NULL;
+    deprule_ignore_map_t *tmp_drentry = NULL;
+
+    /* common */
+    put_str(fp, ri->workdir);
+    put_str(fp, ri->profiledir);
+    put_str(fp, ri->remedyfile);
+    put_str(fp, ri->package_cache);
+    put_u64(fp, ri->package_cache_size);
+    put_u32(fp, default_parallel_processes);
+
+    /* koji */
+    put_str(fp, ri->kojihub);
+    put_str(fp, ri->kojiursine);
+    put_str(fp, ri->kojimbs);
+
+    /* commands */
+    put_str(fp, ri->commands.msgunfmt);
+    put_str(fp, ri->commands.desktop_file_validate);
+    put_str(fp, ri->commands.abidiff);
+    put_str(fp, ri->commands.kmidiff);
+#ifdef _WITH_ANNOCHECK
+    put_str(fp, ri->commands.annocheck);
+#endif
+    put_str(fp, ri->commands.udevadm);
+    put_str(fp, ri->commands.xz);
+    put_str(fp, ri->commands.zstd);
+
+    /* vendor and environment */
+    put_str(fp, ri->vendor_data_dir);
+    put_list(fp, ri->licensedb);
+    put_u32(fp, ri->favor_release);
+    put_u32(fp, ri->have_environment);
+    put_str(fp, ri->product_release);
+    put_u64(fp, ri->tests);
+
+    /* inspection settings */
+    put_map(fp, ri->products);
+    put_list(fp, ri->macrofiles);
+    put_list(fp, ri->ignores);
+    put_list(fp, ri->security_path_prefix);
+    put_list(fp, ri->badwords);
+    put_str(fp, ri->vendor);
+    put_list(fp, ri->buildhost_subdomain);
+#ifdef _HAVE_MODULARITYLABEL
+    put_u32(fp, ri->modularity_static_context);
+    put_map(fp, ri->modularity_release);
+#endif
+    put_str(fp, ri->elf_path_include_pattern);
+    put_str(fp, ri->elf_path_exclude_pattern);
+    put_str(fp, ri->manpage_path_include_pattern);
+    put_str(fp, ri->manpage_path_exclude_pattern);
+    put_str(fp, ri->xml_path_include_pattern);
+    put_str(fp, ri->xml_path_exclude_pattern);
+    put_list(fp, ri->expected_empty_rpms);
+    put_str(fp, ri->desktop_entry_files_dir);
+    put_u32(fp, HASH_COUNT(ri->desktop_skips));
+
+    HASH_ITER(hh, ri->desktop_skips, ds, tmp_ds) {
+        put_str(fp, ds->path);
+        put_u32(fp, ds->flags);
+    }
+
+    put_list(fp, ri->header_file_extensions);
+    put_list(fp, ri->forbidden_path_prefixes);
+    put_list(fp, ri->forbidden_path_suffixes);
+    put_list(fp, ri->forbidden_directories);
+    put_list(fp, ri->bin_paths);
+    put_str(fp, ri->bin_owner);
+    put_str(fp, ri->bin_group);
+    put_list(fp, ri->forbidden_owners);
+    put_list(fp, ri->forbidden_groups);
+    put_list(fp, ri->shells);
+    put_u64(fp, ri->size_threshold);
+    put_list(fp, ri->lto_symbol_name_prefixes);
+    put_u32(fp, ri->specmatch);
+    put_u32(fp, ri->specprimary);
+    put_u32(fp, ri->annocheck_failure_severity);
+    put_str(fp, ri->annocheck_profile);
+    put_map(fp, ri->annocheck);
+    put_map(fp, ri->jvm);
+    put_map(fp, ri->pathmigration);
+    put_list(fp, ri->pathmigration_excluded_paths);
+    put_list(fp, ri->forbidden_paths);
+    put_str(fp, ri->abidiff_suppression_file);
+    put_str(fp, ri->abidiff_debuginfo_path);
+    put_str(fp, ri->abidiff_extra_args);
+    put_u64(fp, ri->abi_security_threshold);
+    put_str(fp, ri->kmidiff_suppression_file);
+    put_str(fp, ri->kmidiff_debuginfo_path);
+    put_str(fp, ri->kmidiff_extra_args);
+    put_list(fp, ri->kernel_filenames);
+    put_str(fp, ri->kabi_dir);
+    put_str(fp, ri->kabi_filename);
+    put_list(fp, ri->automacros);
+    put_list(fp, ri->patch_ignore_list);
+    put_list(fp, ri->bad_functions);
+    put_list_map(fp, ri->bad_functions_allowed);
+    put_list(fp, ri->runpath_allowed_paths);
+    put_list(fp, ri->runpath_allowed_origin_paths);
+    put_list(fp, ri->runpath_origin_prefix_trim);
+    put_str(fp, ri->unicode_exclude_pattern);
+    put_list(fp, ri->unicode_excluded_mime_types);
+    put_list(fp, ri->unicode_forbidden_codepoints);
+    put_u32(fp, HASH_COUNT(ri->deprules_ignore));
+
+    HASH_ITER(hh, ri->deprules_ignore, drentry, tmp_drentry) {
+        put_u32(fp, drentry->type);
+        put_str(fp, drentry->pattern);
+    }
+
+    put_str(fp, ri->debuginfo_sections);
+    put_list(fp, ri->udev_rules_dirs);
+    put_list(fp, ri->changelog_forbidden);
+    put_list_map(fp, ri->inspection_ignores);
+
+    /* remedy strings replaced by the remedy file */
+    put_list(fp, ri->remedy_overrides);
+
+    for (i = 0; remedies[i].name != NULL; i++) {
+        if (list_contains(ri->remedy_overrides, remedies[i].remedy)) {
+            n++;
+        }
+    }
+
+    put_u32(fp, n);
+
+    for (i = 0; remedies[i].name != NULL; i++) {
+        if (list_contains(ri->remedy_overrides, remedies[i].remedy)) {
+            put_str(fp, remedies[i].name);
+            put_str(fp, remedies[i].remedy);
+        }
+    }
+
+    return;
+}
+
+static void put_fileinfo(FILE *fp, const fileinfo_t *fileinfo)
+{
+    fileinfo_entry_t *entry = NULL;
+    uint32_t n = 0;
+
+    TAILQ_FOREACH(entry, fileinfo, items) {
+        n++;
+    }
+
+    put_u32(fp, n);
+
+    TAILQ_FOREACH(entry, fileinfo, items) {
+        put_u32(fp, entry->mode);
+        put_str(fp, entry->owner);
+        put_str(fp, entry->group);
+        put_str(fp, entry->filename);
+    }
+
+    return;
+}
+
+static void put_caps(FILE *fp, const caps_t *caps)
+{
+    caps_entry_t *entry = NULL;
+    caps_filelist_entry_t *fentry = NULL;
+    uint32_t n = 0;
+
+    TAILQ_FOREACH(entry, caps, items) {
+        n++;
+    }
+
+    put_u32(fp, n);
+
+    TAILQ_FOREACH(entry, caps, items) {
+        put_str(fp, entry->pkg);
+        n = 0;
+
+        TAILQ_FOREACH(fentry, entry->files, items) {
+            n++;
+        }
+
+        put_u32(fp, n);
+
+        TAILQ_FOREACH(fentry, entry->files, items) {
+            put_str(fp, fentry->path);
+            put_str(fp, fentry->caps);
+        }
+    }
+
+    return;
+}
+
+static void put_politics(FILE *fp, const politics_list_t *politics)
+{
+    politics_entry_t *entry = NULL;
+    uint32_t n = 0;
+
+    TAILQ_FOREACH(entry, politics, items) {
+        n++;
+    }
+
+    put_u32(fp, n);
+
+    TAILQ_FOREACH(entry, politics, items) {
+        put_str(fp, entry->pattern);
+        put_str(fp, entry->digest);
+        put_u32(fp, entry->allowed);
+    }
+
+    return;
+}
+
+static void put_security(FILE *fp, const security_list_t *security)
+{
+    security_entry_t *entry = NULL;
+    secrule_t *rule = NULL;
+    secrule_t *tmp_rule = NULL;
+    uint32_t n = 0;
+
+    TAILQ_FOREACH(entry, security, items) {
+        n++;
+    }
+
+    put_u32(fp, n);
+
+    TAILQ_FOREACH(entry, security, items) {
+        put_str(fp, entry->path);
+        put_str(fp, entry->pkg);
+        put_str(fp, entry->ver);
+        put_str(fp, entry->rel);
+        put_u32(fp, HASH_COUNT(entry->rules));
+
+        HASH_ITER(hh, entry->rules, rule, tmp_rule) {
+            put_u32(fp, rule->type);
+            put_u32(fp, rule->severity);
+        }
+    }
+
+    return;
+}
+
+/*
+ * Write a snapshot of the configuration in ri to path.  profile is the
+ * -p profile that was read, if any.  release is the product release to
+ * include vendor data for; without one only the configuration is
+ * written.  Call this after init_rpminspect() with ri->compile_config
+ * set so the local configuration file is left out.  Returns 0 on
+ * success, -1 on failure with a warning given.
+ */
+int write_snapshot(struct rpminspect *ri, const char *path, const char *profile, const char *release)
+{
+    int fd = -1;
+    int i = 0;
+    mode_t mask = 0;
+    FILE *fp = NULL;
+    char *tmp = NULL;
+    char *saved_release = NULL;
+    uint32_t n = 0;
+    uint64_t sections[SNAPSHOT_SECTIONS];
+    bool have[SNAPSHOT_SECTIONS];
+    string_entry_t *entry = NULL;
+    string_list_t *sources = NULL;
+
+    assert(ri != NULL);
+    assert(path != NULL);
+
+    if (ri->snapshot != NULL) {
+        warnx(_("*** a configuration snapshot cannot be compiled from another snapshot"));
+        return -1;
+    }
+
+    memset(sections, 0, sizeof(sections));
+    memset(have, 0, sizeof(have));
+
+    /* load the vendor data for the release */
+    if (release != NULL) {
+        saved_release = ri->product_release;
+        ri->product_release = strdup(release);
+        assert(ri->product_release != NULL);
+
+        have[SNAPSHOT_FILEINFO] = init_fileinfo(ri);
+#ifdef _WITH_LIBCAP
+        have[SNAPSHOT_CAPS] = init_caps(ri);
+#endif
+        have[SNAPSHOT_REBASEABLE] = init_rebaseable(ri);
+        have[SNAPSHOT_POLITICS] = init_politics(ri);
+        have[SNAPSHOT_SECURITY] = init_security(ri);
+        have[SNAPSHOT_ICONS] = init_icons(ri);
+
+        free(ri->product_release);
+        ri->product_release = saved_release;
+    }
+
+    /* everything the snapshot was built from */
+    if (ri->cfgfiles) {
+        TAILQ_FOREACH(entry, ri->cfgfiles, items) {
+            sources = list_add(sources, entry->data);
+        }
+    }
+
+    if (ri->remedyfile) {
+        sources = list_add(sources, ri->remedyfile);
+    }
+
+    if (have[SNAPSHOT_FILEINFO]) {
+        sources = list_add(sources, ri->fileinfo_filename);
+    }
+
+    if (have[SNAPSHOT_CAPS]) {
+        sources = list_add(sources, ri->caps_filename);
+    }
+
+    if (have[SNAPSHOT_REBASEABLE]) {
+        sources = list_add(sources, ri->rebaseable_filename);
+    }
+
+    if (have[SNAPSHOT_POLITICS]) {
+        sources = list_add(sources, ri->politics_filename);
+    }
+
+    if (have[SNAPSHOT_SECURITY]) {
+        sources = list_add(sources, ri->security_filename);
+    }
+
+    if (have[SNAPSHOT_ICONS]) {
+        sources = list_add(sources, ri->icons_filename);
+    }
+
+    /* write to a temporary file and move it in place when complete */
+    xasprintf(&tmp, "%s.XXXXXX", path);
+    assert(tmp != NULL);
+    fd = mkstemp(tmp);
+
+    if (fd == -1) {
+        warn("*** mkstemp");
+        free(tmp);
+        list_free(sources, free);
+        return -1;
+    }
+
+    /* mkstemp() creates it 0600, give it the mode a new file would get */
+    mask = umask(0);
+    umask(mask);
+
+    if (fchmod(fd, 0644 & ~mask) == -1) {
+        warn("*** fchmod %s", tmp);
+    }
+
+    fp = fdopen(fd, "w");
+
+    if (fp == NULL) {
+        warn("*** fdopen");
+        close(fd);
+        unlink(tmp);
+        free(tmp);
+        list_free(sources, free);
+        return -1;
+    }
+
+    /* header, rewritten with the section offsets at the end */
+    for (i = 0; i < (int) SNAPSHOT_HEADER_SIZE; i++) {
+        fputc('\0', fp);
+    }
+
+    /* what this snapshot was built from */
+    sections[SNAPSHOT_CONFIG] = ftell(fp);
+    put_str(fp, PACKAGE_VERSION);
+    put_str(fp, (ri->cfgfiles && !TAILQ_EMPTY(ri->cfgfiles)) ? TAILQ_FIRST(ri->cfgfiles)->data : NULL);
+    put_str(fp, profile);
+    put_str(fp, release);
+    put_u32(fp, list_len(sources));
+
+    if (sources) {
+        TAILQ_FOREACH(entry, sources, items) {
+            put_source(fp, entry->data);
+        }
+    }
+
+    put_config(fp, ri);
+
+    /* vendor data */
+    if (have[SNAPSHOT_FILEINFO]) {
+        sections[SNAPSHOT_FILEINFO] = ftell(fp);
+        put_str(fp, ri->fileinfo_filename);
+        put_fileinfo(fp, ri->fileinfo);
+    }
+
+    if (have[SNAPSHOT_CAPS]) {
+        sections[SNAPSHOT_CAPS] = ftell(fp);
+        put_str(fp, ri->caps_filename);
+        put_caps(fp, ri->caps);
+    }
+
+    if (have[SNAPSHOT_REBASEABLE]) {
+        sections[SNAPSHOT_REBASEABLE] = ftell(fp);
+        put_str(fp, ri->rebaseable_filename);
+        put_list(fp, ri->rebaseable);
+    }
+
+    if (have[SNAPSHOT_POLITICS]) {
+        sections[SNAPSHOT_POLITICS] = ftell(fp);
+        put_str(fp, ri->politics_filename);
+        put_politics(fp, ri->politics);
+    }
+
+    if (have[SNAPSHOT_SECURITY]) {
+        sections[SNAPSHOT_SECURITY] = ftell(fp);
+        put_str(fp, ri->security_filename);
+        put_security(fp, ri->security);
+    }
+
+    if (have[SNAPSHOT_ICONS]) {
+        sections[SNAPSHOT_ICONS] = ftell(fp);
+        put_str(fp, ri->icons_filename);
+        put_list(fp, ri->icons);
+    }
+
+    /* now the real header */
+    rewind(fp);
+    fwrite(SNAPSHOT_MAGIC, 1, SNAPSHOT_MAGIC_LEN, fp);
+    put_u32(fp, SNAPSHOT_FORMAT);
+    put_u32(fp, features());
+    put_u32(fp, SNAPSHOT_BYTE_ORDER);
+    n = SNAPSHOT_SECTIONS;
+    put_u32(fp, n);
+
+    for (i = 0; i < SNAPSHOT_SECTIONS; i++) {
+        put_u64(fp, sections[i]);
+    }
+
+    list_free(sources, free);
+
+    if (ferror(fp) || fflush(fp) != 0 || fsync(fileno(fp)) != 0) {
+        warn("*** unable to write %s", tmp);
+        fclose(fp);
+        unlink(tmp);
+        free(tmp);
+        return -1;
+    }
+
+    fclose(fp);
+
+    if (rename(tmp, path) == -1) {
+        warn("*** rename %s", path);
+        unlink(tmp);
+        free(tmp);
+        return -1;
+    }
+
+    free(tmp);
+    return 0;
+}
+
+/*
+ * Reading
+ */
+
+static uint32_t get_u32(struct cursor *c)
+{
+    uint32_t v = 0;
+
+    if (c->bad || c->size - c->pos < sizeof(v)) {
+        c->bad = true;
+        return 0;
+    }
+
+    memcpy(&v, c->data + c->pos, sizeof(v));
+    c->pos += sizeof(v);
+    return v;
+}
+
+static uint64_t get_u64(struct cursor *c)
+{
+    uint64_t v = 0;
+
+    if (c->bad || c->size - c->pos < sizeof(v)) {
+        c->bad = true;
+        return 0;
+    }
+
+    memcpy(&v, c->data + c->pos, sizeof(v));
+    c->pos += sizeof(v);
+    return v;
+}
+
+/* Return a string in the mapped file without copying it */
+static const char *peek_str(struct cursor *c)
+{
+    const char *s = NULL;
+    uint32_t len = get_u32(c);
+
+    if (c->bad || len == SNAPSHOT_NULL) {
+        return NULL;
+    }
+
+    if (c->size - c->pos <= len || c->data[c->pos + len] != '\0') {
+        c->bad = true;
+        return NULL;
+    }
+
+    s = c->data + c->pos;
+    c->pos += len + 1;
+    return s;
+}
+
+static char *get_str(struct cursor *c)
+{
+    const char *s = peek_str(c);
+    char *r = NULL;
+
+    if (s == NULL) {
+        return NULL;
+    }
+
+    r = strdup(s);
+    assert(r != NULL);
+    return r;
+}
+
+/* Replace a string setting */
+static void set_str(struct cursor *c, char **dest)
+{
+    free(*dest);
+    *dest = get_str(c);
+    return;
+}
+
+static string_list_t *get_list(struct cursor *c)
+{
+    uint32_t i = 0;
+    uint32_t n = get_u32(c);
+    string_list_t *list = NULL;
+    string_entry_t *entry = NULL;
+
+    if (c->bad || n == SNAPSHOT_NULL) {
+        return NULL;
+    }
+
+    list = xalloc(sizeof(*list));
+    TAILQ_INIT(list);
+
+    for (i = 0; i < n && !c->bad; i++) {
+        entry = xalloc(sizeof(*entry));
+        entry->data = get_str(c);
+        TAILQ_INSERT_TAIL(list, entry, items);
+    }
+
+    return list;
+}
+
+/* Replace a list setting */
+static void set_list(struct cursor *c, string_list_t **dest)
+{
+    list_free(*dest, free);
+    *dest = get_list(c);
+    return;
+}
+
+static void set_map(struct cursor *c, string_map_t **dest)
+{
+    uint32_t i = 0;
+    uint32_t n = get_u32(c);
+    string_map_t *entry = NULL;
+
+    free_string_map(*dest);
+    *dest = NULL;
+
+    for (i = 0; i < n && !c->bad; i++) {
+        entry = xalloc(sizeof(*entry));
+        entry->key = get_str(c);
+        entry->value = get_str(c);
+
+        if (entry->key == NULL) {
+            free(entry->value);
+            free(entry);
+            c->bad = true;
+            break;
+        }
+
+        HASH_ADD_KEYPTR(hh, *dest, entry->key, strlen(entry->key), entry);
+    }
+
+    return;
+}
+
+static void set_list_map(struct cursor *c, string_list_map_t **dest)
+{
+    uint32_t i = 0;
+    uint32_t n = get_u32(c);
+    string_list_map_t *entry = NULL;
+
+    free_string_list_map(*dest);
+    *dest = NULL;
+
+    for (i = 0; i < n && !c->bad; i++) {
+        entry = xalloc(sizeof(*entry));
+        entry->key = get_str(c);
+        entry->value = get_list(c);
+
+        if (entry->key == NULL) {
+            list_free(entry->value, free);
+            free(entry);
+            c->bad = true;
+            break;
+        }
+
+        HASH_ADD_KEYPTR(hh, *dest, entry->key, strlen(entry->key), entry);
+    }
+
+    return;
+}
+
+/* Compile a saved pattern, keeping the pattern for debug output */
+static void set_regex(struct cursor *c, regex_t **regex, char **pattern)
+{
+    set_str(c, pattern);
+
+    if (*pattern != NULL && add_regex(*pattern, regex) != 0) {
+        warnx(_("*** error compiling snapshot pattern %s"), *pattern);
+    }
+
+    return;
+}
+
+/* Check that a file the snapshot was built from is unchanged */
+static bool source_current(struct cursor *c)
+{
+    struct stat sb;
+    const char *path = peek_str(c);
+    int64_t size = get_u64(c);
+    int64_t sec = get_u64(c);
+    int64_t nsec = get_u64(c);
+
+    if (c->bad || path == NULL) {
+        return false;
+    }
+
+    if (stat(path, &sb) == -1) {
+        return (size == -1);
+    }
+
+    return (size == sb.st_size && sec == sb.st_mtim.tv_sec && nsec == sb.st_mtim.tv_nsec);
+}
+
+static void get_config(struct cursor *c, struct rpminspect *ri)
+{
+    uint32_t i = 0;
+    uint32_t n = 0;
+    char *name = NULL;
+    char *remedy = NULL;
+    desktop_skips_t *ds = NULL;
+    deprule_ignore_map_t *drentry = NULL;
+
+    /* common */
+    set_str(c, &ri->workdir);
+    set_str(c, &ri->profiledir);
+    set_str(c, &ri->remedyfile);
+    set_str(c, &ri->package_cache);
+    ri->package_cache_size = get_u64(c);
+    default_parallel_processes = get_u32(c);
+
+    /* koji */
+    set_str(c, &ri->kojihub);
+    set_str(c, &ri->kojiursine);
+    set_str(c, &ri->kojimbs);
+
+    /* commands */
+    set_str(c, &ri->commands.msgunfmt);
+    set_str(c, &ri->commands.desktop_file_validate);
+    set_str(c, &ri->commands.abidiff);
+    set_str(c, &ri->commands.kmidiff);
+#ifdef _WITH_ANNOCHECK
+    set_str(c, &ri->commands.annocheck);
+#endif
+    set_str(c, &ri->commands.udevadm);
+    set_str(c, &ri->commands.xz);
+    set_str(c, &ri->commands.zstd);
+
+    /* vendor and environment */
+    set_str(c, &ri->vendor_data_dir);
+    set_list(c, &ri->licensedb);
+    ri->favor_release = get_u32(c);
+    ri->have_environment = get_u32(c);
+    set_str(c, &ri->product_release);
+    ri->tests = get_u64(c);
+
+    /* inspection settings */
+    set_map(c, &ri->products);
+    set_list(c, &ri->macrofiles);
+    set_list(c, &ri->ignores);
+    set_list(c, &ri->security_path_prefix);
+    set_list(c, &ri->badwords);
+    set_str(c, &ri->vendor);
+    set_list(c, &ri->buildhost_subdomain);
+#ifdef _HAVE_MODULARITYLABEL
+    ri->modularity_static_context = get_u32(c);
+    set_map(c, &ri->modularity_release);
+#endif
+    set_regex(c, &ri->elf_path_include, &ri->elf_path_include_pattern);
+    set_regex(c, &ri->elf_path_exclude, &ri->elf_path_exclude_pattern);
+    set_regex(c, &ri->manpage_path_include, &ri->manpage_path_include_pattern);
+    set_regex(c, &ri->manpage_path_exclude, &ri->manpage_path_exclude_pattern);
+    set_regex(c, &ri->xml_path_include, &ri->xml_path_include_pattern);
+    set_regex(c, &ri->xml_path_exclude, &ri->xml_path_exclude_pattern);
+    set_list(c, &ri->expected_empty_rpms);
+    set_str(c, &ri->desktop_entry_files_dir);
+    n = get_u32(c);
+
+    for (i = 0; i < n && !c->bad; i++) {
+        ds = xalloc(sizeof(*ds));
+        ds->path = get_str(c);
+        ds->flags = get_u32(c);
+
+        if (ds->path == NULL) {
+            free(ds);
+            c->bad = true;
+            break;
+        }
+
+        HASH_ADD_KEYPTR(hh, ri->desktop_skips, ds->path, strlen(ds->path), ds);
+    }
+
+    set_list(c, &ri->header_file_extensions);
+    set_list(c, &ri->forbidden_path_prefixes);
+    set_list(c, &ri->forbidden_path_suffixes);
+    set_list(c, &ri->forbidden_directories);
+    set_list(c, &ri->bin_paths);
+    set_str(c, &ri->bin_owner);
+    set_str(c, &ri->bin_group);
+    set_list(c, &ri->forbidden_owners);
+    set_list(c, &ri->forbidden_groups);
+    set_list(c, &ri->shells);
+    ri->size_threshold = get_u64(c);
+    set_list(c, &ri->lto_symbol_name_prefixes);
+    ri->specmatch = get_u32(c);
+    ri->specprimary = get_u32(c);
+    ri->annocheck_failure_severity = get_u32(c);
+    set_str(c, &ri->annocheck_profile);
+    set_map(c, &ri->annocheck);
+    set_map(c, &ri->jvm);
+    set_map(c, &ri->pathmigration);
+    set_list(c, &ri->pathmigration_excluded_paths);
+    set_list(c, &ri->forbidden_paths);
+    set_str(c, &ri->abidiff_suppression_file);
+    set_str(c, &ri->abidiff_debuginfo_path);
+    set_str(c, &ri->abidiff_extra_args);
+    ri->abi_security_threshold = get_u64(c);
+    set_str(c, &ri->kmidiff_suppression_file);
+    set_str(c, &ri->kmidiff_debuginfo_path);
+    set_str(c, &ri->kmidiff_extra_args);
+    set_list(c, &ri->kernel_filenames);
+    set_str(c, &ri->kabi_dir);
+    set_str(c, &ri->kabi_filename);
+    set_list(c, &ri->automacros);
+    set_list(c, &ri->patch_ignore_list);
+    set_list(c, &ri->bad_functions);
+    set_list_map(c, &ri->bad_functions_allowed);
+    set_list(c, &ri->runpath_allowed_paths);
+    set_list(c, &ri->runpath_allowed_origin_paths);
+    set_list(c, &ri->runpath_origin_prefix_trim);
+    set_regex(c, &ri->unicode_exclude, &ri->unicode_exclude_pattern);
+    set_list(c, &ri->unicode_excluded_mime_types);
+    set_list(c, &ri->unicode_forbidden_codepoints);
+    n = get_u32(c);
+
+    for (i = 0; i < n && !c->bad; i++) {
+        drentry = xalloc(sizeof(*drentry));
+        drentry->type = get_u32(c);
+        drentry->pattern = get_str(c);
+
+        if (drentry->pattern == NULL) {
+            free(drentry);
+            c->bad = true;
+            break;
+        }
+
+        if (add_regex(drentry->pattern, &drentry->ignore) != 0) {
+            warnx(_("*** error reading %s ignore pattern"), get_deprule_desc(drentry->type));
+        }
+
+        HASH_ADD_INT(ri->deprules_ignore, type, drentry);
+    }
+
+    set_str(c, &ri->debuginfo_sections);
+    set_list(c, &ri->udev_rules_dirs);
+    set_list(c, &ri->changelog_forbidden);
+    set_list_map(c, &ri->inspection_ignores);
+
+    /* remedy strings replaced by the remedy file */
+    set_list(c, &ri->remedy_overrides);
+    n = get_u32(c);
+
+    for (i = 0; i < n && !c->bad; i++) {
+        name = get_str(c);
+        remedy = get_str(c);
+
+        if (name && remedy && !set_remedy(name, remedy)) {
+            warnx(_("*** '%s' is not a valid remedy identifier"), name);
+        }
+
+        free(name);
+        free(remedy);
+    }
+
+    return;
+}
+
+/*
+ * Returns true if the file at path is a configuration snapshot.
+ */
+bool is_snapshot(const char *path)
+{
+    int fd = -1;
+    ssize_t r = 0;
+    char magic[SNAPSHOT_MAGIC_LEN];
+
+    assert(path != NULL);
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    r = read(fd, magic, sizeof(magic));
+    close(fd);
+
+    return (r == (ssize_t) sizeof(magic) && !memcmp(magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN));
+}
+
+void free_snapshot(struct snapshot *snapshot)
+{
+    if (snapshot == NULL) {
+        return;
+    }
+
+    if (snapshot->data != NULL) {
+        munmap(snapshot->data, snapshot->size);
+    }
+
+    free(snapshot->path);
+    free(snapshot->release);
+    free(snapshot);
+    return;
+}
+
+/*
+ * Load the configuration from the snapshot at path in to ri.  The
+ * snapshot stays mapped so the vendor data can be loaded later by
+ * read_snapshot_section().  Returns true if the snapshot was used.
+ * Returns false if it is out of date, was written by another version,
+ * or for a different profile than the one given; *source is then set
+ * to the configuration file the snapshot was built from so the caller
+ * can read that instead.  A snapshot that cannot be read at all is a
+ * fatal error.
+ */
+bool read_snapshot(struct rpminspect *ri, const char *path, const char *profile, char **source)
+{
+    int fd = -1;
+    uint32_t i = 0;
+    uint32_t n = 0;
+    bool usable = true;
+    struct stat sb;
+    struct cursor c;
+    const char *s = NULL;
+    struct snapshot *snapshot = NULL;
+
+    assert(ri != NULL);
+    assert(path != NULL);
+    assert(source != NULL);
+
+    *source = NULL;
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1 || fstat(fd, &sb) == -1) {
+        err(RI_PROGRAM_ERROR, "*** %s", path);
+    }
+
+    snapshot = xalloc(sizeof(*snapshot));
+    snapshot->path = strdup(path);
+    assert(snapshot->path != NULL);
+    snapshot->size = sb.st_size;
+    snapshot->data = mmap(NULL, snapshot->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (snapshot->data == MAP_FAILED) {
+        err(RI_PROGRAM_ERROR, "*** mmap %s", path);
+    }
+
+    /* the header */
+    memset(&c, 0, sizeof(c));
+    c.data = snapshot->data;
+    c.size = snapshot->size;
+    c.pos = SNAPSHOT_MAGIC_LEN;
+
+    if (c.size < SNAPSHOT_HEADER_SIZE || get_u32(&c) != SNAPSHOT_FORMAT
+        || get_u32(&c) != features() || get_u32(&c) != SNAPSHOT_BYTE_ORDER
+        || get_u32(&c) != SNAPSHOT_SECTIONS) {
+        errx(RI_PROGRAM_ERROR, _("*** %s is not a configuration snapshot for this build of %s, recompile it with --compile-config"), path, COMMAND_NAME);
+    }
+
+    for (i = 0; i < SNAPSHOT_SECTIONS; i++) {
+        snapshot->sections[i] = get_u64(&c);
+
+        if (snapshot->sections[i] >= c.size) {
+            c.bad = true;
+        }
+    }
+
+    /* what it was built from */
+    c.pos = snapshot->sections[SNAPSHOT_CONFIG];
+    s = peek_str(&c);
+
+    if (c.bad || s == NULL || strcmp(s, PACKAGE_VERSION)) {
+        usable = false;
+    }
+
+    *source = get_str(&c);
+    s = peek_str(&c);
+
+    if ((s == NULL && profile != NULL) || (s != NULL && (profile == NULL || strcmp(s, profile)))) {
+        usable = false;
+    }
+
+    snapshot->release = get_str(&c);
+    n = get_u32(&c);
+
+    for (i = 0; i < n && !c.bad; i++) {
+        if (!source_current(&c)) {
+            usable = false;
+        }
+    }
+
+    if (c.bad || *source == NULL) {
+        errx(RI_PROGRAM_ERROR, _("*** configuration snapshot %s is damaged"), path);
+    }
+
+    if (!usable) {
+        free_snapshot(snapshot);
+        return false;
+    }
+
+    get_config(&c, ri);
+
+    if (c.bad) {
+        errx(RI_PROGRAM_ERROR, _("*** configuration snapshot %s is damaged"), path);
+    }
+
+    free(*source);
+    *source = NULL;
+    free_snapshot(ri->snapshot);
+    ri->snapshot = snapshot;
+    return true;
+}
+
+/*
+ * Load one vendor data section from the snapshot in use.  Called by
+ * init_fileinfo() and the other vendor data functions before they
+ * read their file.  Returns true if the data was loaded, false if
+ * there is no snapshot or it does not have the data for the current
+ * product release.
+ */
+bool read_snapshot_section(struct rpminspect *ri, const snapshot_section_t section)
+{
+    uint32_t i = 0;
+    uint32_t j = 0;
+    uint32_t n = 0;
+    uint32_t nfiles = 0;
+    int type = 0;
+    severity_t severity = RESULT_NULL;
+    struct cursor c;
+    struct snapshot *snapshot = NULL;
+    fileinfo_entry_t *fientry = NULL;
+    caps_entry_t *centry = NULL;
+    caps_filelist_entry_t *cfentry = NULL;
+    politics_entry_t *pentry = NULL;
+    security_entry_t *sentry = NULL;
+    secrule_t *rule = NULL;
+
+    assert(ri != NULL);
+    assert(section > SNAPSHOT_CONFIG && section < SNAPSHOT_SECTIONS);
+
+    snapshot = ri->snapshot;
+
+    if (snapshot == NULL || snapshot->sections[section] == 0 || snapshot->release == NULL
+        || ri->product_release == NULL || strcmp(snapshot->release, ri->product_release)) {
+        return false;
+    }
+
+    memset(&c, 0, sizeof(c));
+    c.data = snapshot->data;
+    c.size = snapshot->size;
+    c.pos = snapshot->sections[section];
+
+    if (section == SNAPSHOT_FILEINFO) {
+        set_str(&c, &ri->fileinfo_filename);
+        n = get_u32(&c);
+        ri->fileinfo = xalloc(sizeof(*ri->fileinfo));
+        TAILQ_INIT(ri->fileinfo);
+
+        for (i = 0; i < n && !c.bad; i++) {
+            fientry = xalloc(sizeof(*fientry));
+            fientry->mode = get_u32(&c);
+            fientry->owner = get_str(&c);
+            fientry->group = get_str(&c);
+            fientry->filename = get_str(&c);
+            TAILQ_INSERT_TAIL(ri->fileinfo, fientry, items);
+        }
+    } else if (section == SNAPSHOT_CAPS) {
+        set_str(&c, &ri->caps_filename);
+        n = get_u32(&c);
+        ri->caps = xalloc(sizeof(*ri->caps));
+        TAILQ_INIT(ri->caps);
+
+        for (i = 0; i < n && !c.bad; i++) {
+            centry = xalloc(sizeof(*centry));
+            centry->pkg = get_str(&c);
+            centry->files = xalloc(sizeof(*centry->files));
+            TAILQ_INIT(centry->files);
+            TAILQ_INSERT_TAIL(ri->caps, centry, items);
+            nfiles = get_u32(&c);
+
+            for (j = 0; j < nfiles && !c.bad; j++) {
+                cfentry = xalloc(sizeof(*cfentry));
+                cfentry->path = get_str(&c);
+                cfentry->caps = get_str(&c);
+                TAILQ_INSERT_TAIL(centry->files, cfentry, items);
+            }
+        }
+    } else if (section == SNAPSHOT_REBASEABLE) {
+        set_str(&c, &ri->rebaseable_filename);
+        set_list(&c, &ri->rebaseable);
+    } else if (section == SNAPSHOT_POLITICS) {
+        set_str(&c, &ri->politics_filename);
+        n = get_u32(&c);
+        ri->politics = xalloc(sizeof(*ri->politics));
+        TAILQ_INIT(ri->politics);
+
+        for (i = 0; i < n && !c.bad; i++) {
+            pentry = xalloc(sizeof(*pentry));
+            pentry->pattern = get_str(&c);
+            pentry->digest = get_str(&c);
+            pentry->allowed = get_u32(&c);
+            TAILQ_INSERT_TAIL(ri->politics, pentry, items);
+        }
+    } else if (section == SNAPSHOT_SECURITY) {
+        set_str(&c, &ri->security_filename);
+        n = get_u32(&c);
+
+        for (i = 0; i < n && !c.bad; i++) {
+            sentry = xalloc(sizeof(*sentry));
+            sentry->path = get_str(&c);
+            sentry->pkg = get_str(&c);
+            sentry->ver = get_str(&c);
+            sentry->rel = get_str(&c);
+            nfiles = get_u32(&c);
+
+            for (j = 0; j < nfiles && !c.bad; j++) {
+                type = get_u32(&c);
+                severity = get_u32(&c);
+                HASH_FIND_INT(sentry->rules, &type, rule);
+
+                if (rule == NULL) {
+                    rule = xalloc(sizeof(*rule));
+                    rule->type = type;
+                    HASH_ADD_INT(sentry->rules, type, rule);
+                }
+
+                rule->severity = severity;
+            }
+
+            TAILQ_INSERT_TAIL(ri->security, sentry, items);
+        }
+    } else if (section == SNAPSHOT_ICONS) {
+        set_str(&c, &ri->icons_filename);
+        set_list(&c, &ri->icons);
+    }
+
+    if (c.bad) {
+        errx(RI_PROGRAM_ERROR, _("*** configuration snapshot %s is damaged"), snapshot->path);
+    }
+
+    return true;
+}
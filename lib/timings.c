@@ -0,0 +1,328 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/**
+ * @file timings.c
+ * @brief Record where a run spends its time (-m).
+ * @copyright LGPL-3.0-or-later
+ *
+ * Each phase of a run and each inspection is bracketed by
+ * start_timing() and stop_timing().  The wall clock time, the CPU
+ * time of rpminspect and the commands it waited for, the growth of
+ * the peak resident set size, and the number of files visited and
+ * commands run in between are added to ri->timings.  Entering a phase
+ * more than once adds to the same entry.  The start and end are also
+ * written to the event stream (-e) with what was used in between.
+ * Nothing is measured unless ri->timings or ri->events was set up.
+ * Inspections run in another process, like the header inspections of
+ * pipelined mode, are measured there with measure_timing() and sent
+ * back for add_timing().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <assert.h>
+#include <err.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <json.h>
+
+#include "rpminspect.h"
+
+/* files and commands counted since the program started */
+static unsigned long int files_visited = 0;
+static unsigned long int commands_run = 0;
+
+/* Count one payload file visited by extraction or an inspection */
+void count_timed_file(void)
+{
+    files_visited++;
+    return;
+}
+
+/* Count one external command run */
+void count_timed_command(void)
+{
+    commands_run++;
+    return;
+}
+
+/* CPU seconds used by this process and the children it waited for */
+static double cpu_seconds(long *maxrss)
+{
+    struct rusage self;
+    struct rusage children;
+
+    if (getrusage(RUSAGE_SELF, &self) == -1 || getrusage(RUSAGE_CHILDREN, &children) == -1) {
+        warn("*** getrusage");
+        return 0;
+    }
+
+    if (maxrss) {
+        *maxrss = self.ru_maxrss;
+    }
+
+    return self.ru_utime.tv_sec + self.ru_stime.tv_sec + children.ru_utime.tv_sec + children.ru_stime.tv_sec
+           + ((self.ru_utime.tv_usec + self.ru_stime.tv_usec + children.ru_utime.tv_usec + children.ru_stime.tv_usec) / 1000000.0);
+}
+
+/*
+ * Take the starting measurements for a phase or inspection of the
+ * given type ("phase" or "inspection") and name.
+ */
+void start_timing(const struct rpminspect *ri, const char *type, const char *name, struct timing_mark *mark)
+{
+    assert(ri != NULL);
+    assert(type != NULL);
+    assert(name != NULL);
+    assert(mark != NULL);
+
+    if (ri->timings == NULL && ri->events == NULL) {
+        return;
+    }
+
+    emit_timing_event(ri, type, name, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &mark->wall);
+    mark->cpu = cpu_seconds(&mark->maxrss);
+    mark->files = files_visited;
+    mark->commands = commands_run;
+
+    return;
+}
+
+/*
+ * Fill in used with what was used since mark was taken by
+ * start_timing().  Only the measurements in used are set.
+ */
+void measure_timing(const struct timing_mark *mark, timing_entry_t *used)
+{
+    long maxrss = 0;
+    double cpu = 0;
+    struct timespec now;
+
+    assert(mark != NULL);
+    assert(used != NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    cpu = cpu_seconds(&maxrss);
+
+    memset(used, 0, sizeof(*used));
+    used->wall = (now.tv_sec - mark->wall.tv_sec) + ((now.tv_nsec - mark->wall.tv_nsec) / 1000000000.0);
+    used->cpu = cpu - mark->cpu;
+    used->rss = maxrss - mark->maxrss;
+    used->files = files_visited - mark->files;
+    used->commands = commands_run - mark->commands;
+
+    return;
+}
+
+/*
+ * Add what was used since mark to the timing entry of the given type
+ * ("phase" or "inspection") and name for the current build.
+ */
+void stop_timing(struct rpminspect *ri, const char *type, const char *name, const struct timing_mark *mark)
+{
+    timing_entry_t used;
+
+    assert(ri != NULL);
+    assert(type != NULL);
+    assert(name != NULL);
+    assert(mark != NULL);
+
+    if (ri->timings == NULL && ri->events == NULL) {
+        return;
+    }
+
+    measure_timing(mark, &used);
+    emit_timing_event(ri, type, name, &used);
+    add_timing(ri, type, name, &used);
+    return;
+}
+
+/*
+ * Add used to the timing entry of the given type ("phase" or
+ * "inspection") and name for the current build.  The type must be a
+ * string constant.
+ */
+void add_timing(struct rpminspect *ri, const char *type, const char *name, const timing_entry_t *used)
+{
+    timing_entry_t *entry = NULL;
+
+    assert(ri != NULL);
+    assert(type != NULL);
+    assert(name != NULL);
+    assert(used != NULL);
+
+    if (ri->timings == NULL) {
+        return;
+    }
+
+    TAILQ_FOREACH(entry, ri->timings, items) {
+        if (!strcmp(entry->type, type) && !strcmp(entry->name, name) && !strcmp(entry->build, ri->after ? ri->after : "")) {
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        entry = xalloc(sizeof(*entry));
+        entry->type = type;
+        entry->name = strdup(name);
+        assert(entry->name != NULL);
+        entry->build = strdup(ri->after ? ri->after : "");
+        assert(entry->build != NULL);
+        TAILQ_INSERT_TAIL(ri->timings, entry, items);
+    }
+
+    entry->wall += used->wall;
+    entry->cpu += used->cpu;
+    entry->rss += used->rss;
+    entry->files += used->files;
+    entry->commands += used->commands;
+
+    return;
+}
+
+/*
+ * Add a diagnostics result with the timings recorded for the current
+ * comparison.  Timings recorded before a build was named, such as
+ * loading the configuration, are part of every comparison.
+ */
+void add_timings_result(struct rpminspect *ri)
+{
+    char *line = NULL;
+    timing_entry_t *entry = NULL;
+    results_entry_t *result = NULL;
+    results_entry_t *diag = NULL;
+    struct result_params params;
+
+    assert(ri != NULL);
+
+    if (ri->timings == NULL || TAILQ_EMPTY(ri->timings)) {
+        return;
+    }
+
+    init_result_params(&params);
+    params.severity = RESULT_DIAG;
+    params.waiverauth = NOT_WAIVABLE;
+    params.header = NAME_DIAGNOSTICS;
+    xasprintf(&params.msg, _("Time and resources used by each phase and inspection."));
+    xasprintf(&params.details, "%-12s %-16s %10s %10s %10s %8s %8s\n", _("type"), _("name"), _("wall (s)"), _("cpu (s)"), _("rss (KiB)"), _("files"), _("commands"));
+
+    TAILQ_FOREACH(entry, ri->timings, items) {
+        if (*entry->build != '\0' && (ri->after == NULL || strcmp(entry->build, ri->after))) {
+            continue;
+        }
+
+        xasprintf(&line, "%-12s %-16s %10.3f %10.3f %10ld %8lu %8lu\n", entry->type, entry->name, entry->wall, entry->cpu, entry->rss, entry->files, entry->commands);
+        params.details = strappend(params.details, line, NULL);
+        free(line);
+    }
+
+    add_result_entry(&ri->results, &params);
+    free(params.msg);
+    free(params.details);
+
+    /*
+     * The inspections ran since the other diagnostics were added.
+     * Move this result up behind them so the output has a single
+     * diagnostics section.
+     */
+    result = TAILQ_LAST(ri->results, results_s);
+    diag = TAILQ_PREV(result, results_s, items);
+
+    while (diag != NULL && strcmp(diag->header, NAME_DIAGNOSTICS)) {
+        diag = TAILQ_PREV(diag, results_s, items);
+    }
+
+    if (diag != NULL && diag != TAILQ_PREV(result, results_s, items)) {
+        TAILQ_REMOVE(ri->results, result, items);
+        TAILQ_INSERT_AFTER(ri->results, diag, result, items);
+    }
+
+    return;
+}
+
+/*
+ * Write all of the recorded timings to path as a JSON array.
+ */
+void write_timings(const struct rpminspect *ri, const char *path)
+{
+    int r = 0;
+    FILE *fp = NULL;
+    const char *json_string = NULL;
+    struct json_object *j = NULL;
+    struct json_object *jt = NULL;
+    timing_entry_t *entry = NULL;
+
+    assert(ri != NULL);
+    assert(path != NULL);
+
+    if (ri->timings == NULL) {
+        return;
+    }
+
+    j = json_object_new_array();
+
+    TAILQ_FOREACH(entry, ri->timings, items) {
+        jt = json_object_new_object();
+        json_object_object_add(jt, "build", json_object_new_string(entry->build));
+        json_object_object_add(jt, "type", json_object_new_string(entry->type));
+        json_object_object_add(jt, "name", json_object_new_string(entry->name));
+        json_object_object_add(jt, "wall", json_object_new_double(entry->wall));
+        json_object_object_add(jt, "cpu", json_object_new_double(entry->cpu));
+        json_object_object_add(jt, "rss delta", json_object_new_int64(entry->rss));
+        json_object_object_add(jt, "files", json_object_new_int64(entry->files));
+        json_object_object_add(jt, "commands", json_object_new_int64(entry->commands));
+        json_object_array_add(j, jt);
+    }
+
+    fp = fopen(path, "w");
+
+    if (fp == NULL) {
+        warn(_("*** error opening %s for writing"), path);
+        json_object_put(j);
+        return;
+    }
+
+    json_string = json_object_to_json_string_ext(j, JSON_C_TO_STRING_SPACED | JSON_C_TO_STRING_PRETTY);
+
+    if (json_string == NULL) {
+        errx(RI_PROGRAM_ERROR, "*** failed to stringify object to json format");
+    }
+
+    fprintf(fp, "%s\n", json_string);
+    r = fclose(fp);
+    assert(r == 0);
+    json_object_put(j);
+
+    return;
+}
+
+/*
+ * Free the recorded timings.
+ */
+void free_timings(timing_list_t *timings)
+{
+    timing_entry_t *entry = NULL;
+
+    if (timings == NULL) {
+        return;
+    }
+
+    while (!TAILQ_EMPTY(timings)) {
+        entry = TAILQ_FIRST(timings);
+        TAILQ_REMOVE(timings, entry, items);
+        free(entry->name);
+        free(entry->build);
+        free(entry);
+    }
+
+    free(timings);
+    return;
+}
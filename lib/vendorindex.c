@@ -0,0 +1,162 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/**
+ * @file vendorindex.c
+ * @brief Indexes for searching vendor data lists.
+ * @copyright LGPL-3.0-or-later
+ *
+ * The fileinfo, capabilities, and rebaseable lists are searched for
+ * every file or package an inspection looks at, and the lists can be
+ * thousands of lines long.  A vendor_index_t is built over a list the
+ * first time it is searched.  Literal keys go in a hash table.  Keys
+ * with fnmatch(3) wildcards are kept in the order they appear in the
+ * file and are only tried when the string starts with the part of the
+ * pattern before the first wildcard.  A lookup returns the first
+ * matching entry in file order, the same entry a search through the
+ * list would have found.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fnmatch.h>
+#include "uthash.h"
+#include "rpminspect.h"
+
+/* characters that make a key an fnmatch(3) pattern (FNM_NOESCAPE) */
+#define WILDCARD_CHARS "*?["
+
+/**
+ * @brief Create an empty vendor data index.
+ *
+ * @param wildcards True if keys with fnmatch(3) wildcards are
+ *        patterns, false to treat every key as a literal string.
+ * @return Newly allocated index; free with free_vendor_index().
+ */
+vendor_index_t *new_vendor_index(const bool wildcards)
+{
+    vendor_index_t *index = xalloc(sizeof(*index));
+
+    index->wildcards = wildcards;
+    TAILQ_INIT(&index->patterns);
+    return index;
+}
+
+/**
+ * @brief Add a key to a vendor data index.  Keys must be added in the
+ * order they appear in the vendor data file.  The key string is not
+ * copied and must live as long as the index.  When a literal key is
+ * added more than once, the first one is kept.
+ *
+ * @param index The index to add to.
+ * @param key The key string.
+ * @param data The entry returned when the key matches.
+ */
+void vendor_index_add(vendor_index_t *index, const char *key, void *data)
+{
+    size_t prefix = 0;
+    vendor_key_t *entry = NULL;
+    vendor_pattern_t *pattern = NULL;
+
+    assert(index != NULL);
+
+    if (key == NULL) {
+        return;
+    }
+
+    prefix = index->wildcards ? strcspn(key, WILDCARD_CHARS) : strlen(key);
+
+    if (key[prefix] != '\0') {
+        pattern = xalloc(sizeof(*pattern));
+        pattern->pattern = key;
+        pattern->prefix = prefix;
+        pattern->pos = index->count++;
+        pattern->data = data;
+        TAILQ_INSERT_TAIL(&index->patterns, pattern, items);
+        return;
+    }
+
+    HASH_FIND_STR(index->keys, key, entry);
+
+    if (entry == NULL) {
+        entry = xalloc(sizeof(*entry));
+        entry->key = key;
+        entry->pos = index->count;
+        entry->data = data;
+        HASH_ADD_KEYPTR(hh, index->keys, entry->key, strlen(entry->key), entry);
+    }
+
+    index->count++;
+    return;
+}
+
+/**
+ * @brief Find the first entry in a vendor data index matching s.
+ *
+ * @param index The index to search.
+ * @param s The string to look up.
+ * @return The data of the first matching key in file order, or NULL
+ *         if nothing matches.
+ */
+void *vendor_index_find(const vendor_index_t *index, const char *s)
+{
+    vendor_key_t *entry = NULL;
+    vendor_pattern_t *pattern = NULL;
+
+    if (index == NULL || s == NULL) {
+        return NULL;
+    }
+
+    HASH_FIND_STR(index->keys, s, entry);
+
+    /* a pattern earlier in the file than the literal match wins */
+    TAILQ_FOREACH(pattern, &index->patterns, items) {
+        if (entry != NULL && pattern->pos > entry->pos) {
+            break;
+        }
+
+        if (strncmp(s, pattern->pattern, pattern->prefix)) {
+            continue;
+        }
+
+        if (!strcmp(pattern->pattern, s) || !fnmatch(pattern->pattern, s, FNM_NOESCAPE)) {
+            return pattern->data;
+        }
+    }
+
+    return (entry == NULL) ? NULL : entry->data;
+}
+
+/**
+ * @brief Free a vendor data index.  The keys and data are owned by the
+ * list the index was built over and are not freed.
+ *
+ * @param index The index to free.
+ */
+void free_vendor_index(vendor_index_t *index)
+{
+    vendor_key_t *entry = NULL;
+    vendor_key_t *tmp_entry = NULL;
+    vendor_pattern_t *pattern = NULL;
+
+    if (index == NULL) {
+        return;
+    }
+
+    HASH_ITER(hh, index->keys, entry, tmp_entry) {
+        HASH_DEL(index->keys, entry);
+        free(entry);
+    }
+
+    while (!TAILQ_EMPTY(&index->patterns)) {
+        pattern = TAILQ_FIRST(&index->patterns);
+        TAILQ_REMOVE(&index->patterns, pattern, items);
+        free(pattern);
+    }
+
+    free(index);
+    return;
+}
@@ -0,0 +1,150 @@
+#!/usr/bin/python3
+#
+# Helper for perf-kernel.sh.  Collects the timings (-m) and peak memory
+# use of rpminspect runs in to one results file, and compares a results
+# file against a baseline.
+#
+#     perf-compare.py collect OUTPUT BEFORE AFTER RSSFILE TIMINGS...
+#         Write OUTPUT from the -m timings files and RSSFILE.  RSSFILE
+#         has one "name KiB" line per run with the peak RSS reported by
+#         /usr/bin/time, "ALL" being the run with every inspection.
+#
+#     perf-compare.py compare [options] BASELINE CURRENT
+#         Print the time and peak RSS of every phase and inspection
+#         against the baseline and exit with 1 if any of them grew by
+#         more than --threshold percent.
+#
+# Copyright David Cantrell <dcantrell@redhat.com>
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+import argparse
+import json
+import sys
+
+
+def collect(args):
+    results = {"before": args.before, "after": args.after, "phases": {}, "inspections": {}, "run": {}}
+    rss = {}
+
+    with open(args.rssfile, "r") as f:
+        for line in f:
+            fields = line.split()
+
+            if len(fields) == 2:
+                rss[fields[0]] = int(fields[1])
+
+    for path in args.timings:
+        with open(path, "r") as f:
+            timings = json.load(f)
+
+        for t in timings:
+            group = "phases" if t["type"] == "phase" else "inspections"
+            entry = results[group].setdefault(t["name"], {"seconds": 0, "cpu": 0, "rss": 0})
+
+            # phases repeat in every individual run, keep the slowest
+            if group == "phases":
+                entry["seconds"] = max(entry["seconds"], round(t["wall"], 3))
+                entry["cpu"] = max(entry["cpu"], round(t["cpu"], 3))
+                entry["rss"] = max(entry["rss"], t["rss delta"])
+            else:
+                entry["seconds"] = round(t["wall"], 3)
+                entry["cpu"] = round(t["cpu"], 3)
+                entry["rss"] = rss.get(t["name"], t["rss delta"])
+
+    if "ALL" in rss:
+        results["run"]["peak rss"] = rss["ALL"]
+
+    results["run"]["seconds"] = round(sum(e["seconds"] for e in results["phases"].values())
+                                      + sum(e["seconds"] for e in results["inspections"].values()), 3)
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=4, sort_keys=True)
+        f.write("\n")
+
+    return 0
+
+
+def grew(old, new, threshold, floor):
+    """True if new is more than threshold percent and floor over old."""
+    return new - old > floor and old > 0 and (new - old) * 100 / old > threshold
+
+
+def compare(args):
+    with open(args.baseline, "r") as f:
+        baseline = json.load(f)
+
+    with open(args.current, "r") as f:
+        current = json.load(f)
+
+    regressions = []
+
+    print("baseline: %s -> %s" % (baseline.get("before"), baseline.get("after")))
+    print("current:  %s -> %s\n" % (current.get("before"), current.get("after")))
+    print("%-12s %-20s %10s %10s %8s %12s %12s %8s" % ("", "name", "old (s)", "new (s)", "change", "old (KiB)", "new (KiB)", "change"))
+
+    for group in ["phases", "inspections"]:
+        for (name, old) in sorted(baseline.get(group, {}).items()):
+            new = current.get(group, {}).get(name)
+
+            if new is None:
+                continue
+
+            flags = []
+
+            if grew(old["seconds"], new["seconds"], args.threshold, args.min_seconds):
+                flags.append("time")
+
+            if grew(old["rss"], new["rss"], args.threshold, args.min_rss):
+                flags.append("rss")
+
+            if flags:
+                regressions.append("%s (%s)" % (name, ", ".join(flags)))
+
+            print("%-12s %-20s %10.2f %10.2f %+7.1f%% %12d %12d %+7.1f%%%s" % (
+                group, name,
+                old["seconds"], new["seconds"], (new["seconds"] - old["seconds"]) * 100 / old["seconds"] if old["seconds"] else 0,
+                old["rss"], new["rss"], (new["rss"] - old["rss"]) * 100 / old["rss"] if old["rss"] else 0,
+                "  REGRESSION" if flags else ""))
+
+    old = baseline.get("run", {}).get("peak rss", 0)
+    new = current.get("run", {}).get("peak rss", 0)
+
+    if grew(old, new, args.threshold, args.min_rss):
+        regressions.append("peak rss")
+
+    print("\npeak rss: %d KiB -> %d KiB" % (old, new))
+
+    if regressions:
+        print("\n*** regressed by more than %g%%: %s" % (args.threshold, "; ".join(regressions)))
+        return 1
+
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Collect and compare rpminspect performance results.")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("collect", help="combine timings and peak RSS in to a results file")
+    p.add_argument("output")
+    p.add_argument("before")
+    p.add_argument("after")
+    p.add_argument("rssfile")
+    p.add_argument("timings", nargs="+")
+    p.set_defaults(func=collect)
+
+    p = sub.add_parser("compare", help="compare a results file against a baseline")
+    p.add_argument("--threshold", type=float, default=10, help="allowed growth in percent (default: 10)")
+    p.add_argument("--min-seconds", type=float, default=1, help="ignore time growth below this many seconds (default: 1)")
+    p.add_argument("--min-rss", type=int, default=16384, help="ignore RSS growth below this many KiB (default: 16384)")
+    p.add_argument("baseline")
+    p.add_argument("current")
+    p.set_defaults(func=compare)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
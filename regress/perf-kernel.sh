@@ -0,0 +1,144 @@
+#!/bin/sh
+#
+# Performance regression check on kernel comparisons.  Runs rpminspect
+# on two kernel builds kept in a local cache, records the time and peak
+# memory of every phase and inspection, and compares them against a
+# stored baseline.  Any inspection whose time or peak RSS grew by more
+# than THRESHOLD percent is reported and the script exits non-zero.
+# The first run, or a run with UPDATE_BASELINE=y, stores the results
+# as the new baseline.
+#
+# Builds are downloaded in to KERNEL_CACHE once (this needs koji) and
+# used from there afterwards, so later runs work offline.  Without
+# BEFORE_BUILD and AFTER_BUILD the two most recent COMPLETE kernel
+# builds in the latest Fedora tag are used, or the two newest builds
+# in the cache when koji is not available.
+#
+# Environment:
+#     RPMINSPECT       rpminspect command (default: rpminspect)
+#     KERNEL_CACHE     downloaded builds (default: /var/tmp/rpminspect-kernel-cache)
+#     BASELINE         baseline results (default: ./kernel-perf-baseline.json)
+#     THRESHOLD        allowed growth in percent (default: 10)
+#     MODE             'all' runs every inspection at once, 'indiv' runs each
+#                      inspection separately for a per-inspection peak RSS
+#                      (default: all)
+#     BEFORE_BUILD     before build NVR (optional)
+#     AFTER_BUILD      after build NVR (optional)
+#     UPDATE_BASELINE  set to any value to store this run as the baseline
+#
+# Copyright David Cantrell <dcantrell@redhat.com>
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+PATH=/bin:/usr/bin
+PKG=kernel
+CWD="$(pwd)"
+BINDIR="$(cd "$(dirname "$0")" && pwd)"
+RPMINSPECT=${RPMINSPECT:-rpminspect}
+KERNEL_CACHE=${KERNEL_CACHE:-/var/tmp/rpminspect-kernel-cache}
+BASELINE=${BASELINE:-${CWD}/kernel-perf-baseline.json}
+THRESHOLD=${THRESHOLD:-10}
+MODE=${MODE:-all}
+TIMECMD="/usr/bin/time"
+TMPDIR="$(mktemp -d -p /var/tmp -t "$(basename "$0" .sh)".XXXXXX)"
+trap 'rm -rf "${TMPDIR}"' EXIT
+
+# Make sure we have additional commands available
+for cmd in ${RPMINSPECT} ${TIMECMD} python3 ; do
+    ${cmd} --help >/dev/null 2>&1
+    if [ $? -eq 127 ]; then
+        echo "*** Missing ${cmd}, exiting." >&2
+        exit 1
+    fi
+done
+
+koji --help >/dev/null 2>&1
+if [ $? -eq 127 ]; then
+    HAVE_KOJI=n
+else
+    HAVE_KOJI=y
+fi
+
+mkdir -p "${KERNEL_CACHE}" || exit 1
+
+# Pick the builds
+if [ -z "${BEFORE_BUILD}" ] || [ -z "${AFTER_BUILD}" ]; then
+    if [ "${HAVE_KOJI}" = "y" ]; then
+        LATEST_TAG="$(koji list-tags | grep -E '^f[0-9]+$' | sort | tail -n 1)"
+        DIST_TAG="$(echo "${LATEST_TAG}" | sed -e 's/f/fc/g')"
+        BUILDS="$(koji list-builds --package=${PKG} | grep "\.${DIST_TAG}" | grep -E ' COMPLETE$' | cut -d ' ' -f 1)"
+    else
+        BUILDS="$(find "${KERNEL_CACHE}" -mindepth 1 -maxdepth 1 -type d -name "${PKG}-*" -exec basename {} \; | sort -V)"
+    fi
+
+    BEFORE_BUILD="$(echo "${BUILDS}" | tail -n 2 | head -n 1)"
+    AFTER_BUILD="$(echo "${BUILDS}" | tail -n 1)"
+fi
+
+if [ -z "${BEFORE_BUILD}" ] || [ -z "${AFTER_BUILD}" ] || [ "${BEFORE_BUILD}" = "${AFTER_BUILD}" ]; then
+    echo "*** Unable to find two ${PKG} builds, set BEFORE_BUILD and AFTER_BUILD." >&2
+    exit 1
+fi
+
+# Download builds missing from the cache
+for build in "${BEFORE_BUILD}" "${AFTER_BUILD}" ; do
+    if [ ! -d "${KERNEL_CACHE}/${build}" ]; then
+        if [ "${HAVE_KOJI}" = "n" ]; then
+            echo "*** ${build} is not in ${KERNEL_CACHE} and koji is not available." >&2
+            exit 1
+        fi
+
+        "${RPMINSPECT}" -f -w "${KERNEL_CACHE}" "${build}" || exit 1
+    fi
+done
+
+echo "before: ${BEFORE_BUILD}"
+echo "after:  ${AFTER_BUILD}"
+
+# Run one comparison, recording timings and peak RSS under the given name
+run_rpminspect() {
+    name="${1}"
+    shift
+
+    ${TIMECMD} -f "%M" -o "${TMPDIR}/${name}.rss" \
+        "${RPMINSPECT}" -w "${TMPDIR}" -F json -o "${TMPDIR}/${name}.results" -m "${TMPDIR}/${name}.timings" "$@" \
+        "${KERNEL_CACHE}/${BEFORE_BUILD}" "${KERNEL_CACHE}/${AFTER_BUILD}" >"${CWD}/${PKG}-perf-${name}.log" 2>&1
+
+    # exit code 1 means the inspections found something, that is fine here
+    if [ $? -gt 1 ]; then
+        echo "*** rpminspect failed for ${name}, see ${CWD}/${PKG}-perf-${name}.log" >&2
+        exit 1
+    fi
+
+    echo "${name} $(tail -n 1 "${TMPDIR}/${name}.rss")" >> "${TMPDIR}/rss"
+}
+
+: > "${TMPDIR}/rss"
+
+if [ "${MODE}" = "indiv" ]; then
+    ${RPMINSPECT} -l | sed -e '1,/^Available inspections:$/d' | while read -r inspection ; do
+        echo ">>> ${inspection}"
+        run_rpminspect "${inspection}" -T "${inspection}"
+    done || exit 1
+else
+    run_rpminspect ALL -T ALL
+fi
+
+# Gather the results and compare against the baseline
+RESULTS="${CWD}/${PKG}-perf-${AFTER_BUILD}.json"
+python3 "${BINDIR}"/perf-compare.py collect "${RESULTS}" "${BEFORE_BUILD}" "${AFTER_BUILD}" "${TMPDIR}"/rss "${TMPDIR}"/*.timings || exit 1
+echo "results: ${RESULTS}"
+
+ret=0
+
+if [ -f "${BASELINE}" ]; then
+    python3 "${BINDIR}"/perf-compare.py compare --threshold "${THRESHOLD}" "${BASELINE}" "${RESULTS}"
+    ret=$?
+fi
+
+if [ ! -f "${BASELINE}" ] || [ -n "${UPDATE_BASELINE}" ]; then
+    cp "${RESULTS}" "${BASELINE}" || exit 1
+    echo "baseline stored in ${BASELINE}"
+fi
+
+exit ${ret}
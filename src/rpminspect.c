@@ -9,6 +9,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <err.h>
+#include <ftw.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
@@ -30,6 +31,22 @@ extern int strverscmp (const char *, const char *);
 #endif
 
 #include "rpminspect.h"
+#include "parallel.h"
+#include "internal/probes.h"
+
+/* set in processes running a request received by the --serve mode */
+static bool job_mode = false;
+
+/* configuration the --serve mode read ahead of time and what it was read from */
+static struct rpminspect *preloaded = NULL;
+static char *preloaded_cfgfile = NULL;
+static char *preloaded_profile = NULL;
+static struct timespec preloaded_changed;
+
+/* latest change time seen by the nftw() helper of config_changed() */
+static struct timespec newest_change;
+
+static int run_job(int argc, char **argv);
 
 void sigabrt_handler(__attribute__ ((unused)) int i)
 {
@@ -47,6 +64,8 @@ static void usage(void)
 {
     printf(_("Compare package builds for policy compliance and consistency.\n\n"));
     printf(_("Usage: %s [OPTIONS] [before build] [after build]\n"), COMMAND_NAME);
+    printf(_("       %s [OPTIONS] -B FILE [before build]\n"), COMMAND_NAME);
+    printf(_("       %s -S PATH [OPTIONS]\n"), COMMAND_NAME);
     printf(_("Options:\n"));
     printf(_("  -c FILE, --config=FILE      Configuration file to use\n"));
     printf(_("  -p NAME, --profile=NAME     Configuration profile to use\n"));
@@ -72,8 +91,28 @@ static void usage(void)
     printf(_("  -f, --fetch-only            Fetch builds only, do not perform inspections\n"));
     printf(_("                                (implies -k)\n"));
     printf(_("  -k, --keep                  Do not remove the comparison working files\n"));
+    printf(_("  -P, --pipeline              Extract packages while downloading the rest\n"));
+    printf(_("                                and run header-only inspections meanwhile\n"));
+    printf(_("  -j N, --workers=N           Number of parallel worker processes\n"));
+    printf(_("                                (default: usable CPUs, see rpminspect(1))\n"));
+    printf(_("  -B FILE, --batch=FILE       Compare the before build with each after\n"));
+    printf(_("                                build listed in FILE\n"));
+    printf(_("  -S PATH, --serve=PATH       Run as a service listening on the Unix\n"));
+    printf(_("                                socket PATH\n"));
+    printf(_("  -C PATH, --connect=PATH     Run this command on the service listening\n"));
+    printf(_("                                on the Unix socket PATH\n"));
+    printf(_("  -R DIR, --result-cache=DIR  Reuse inspection results saved in DIR\n"));
+    printf(_("                                by earlier runs on the same builds\n"));
+    printf(_("  -m FILE, --timings=FILE     Record the time and resources used by each\n"));
+    printf(_("                                phase and inspection, write them to FILE\n"));
+    printf(_("  -e FILE, --events=FILE      Write phases, inspections, and results to\n"));
+    printf(_("                                FILE as they happen, one JSON object per\n"));
+    printf(_("                                line; digits name an open descriptor\n"));
     printf(_("  -d, --debug                 Debugging mode output\n"));
     printf(_("  -D, --dump-config           Dump configuration settings (in YAML format)\n"));
+    printf(_("  -K FILE, --compile-config=FILE\n"));
+    printf(_("                              Write the configuration and vendor data for\n"));
+    printf(_("                                the product release to FILE for use with -c\n"));
     printf(_("  -v, --verbose               Verbose inspection output\n"));
     printf(_("                              when finished, display full path\n"));
     printf(_("  -?, --help                  Display usage information\n"));
@@ -306,29 +345,548 @@ static void check_found(const bool found, const char *inspection)
         errx(RI_PROGRAM_ERROR, _("*** See `%s --help` for more information."), COMMAND_NAME);
     }
 
-    return;
-}
+    return;
+}
+
+/*
+ * Copy the option argument, but error out if we have already done
+ * that.  Enforces single use of options on the command line.
+ */
+static char *gather_arg(char *val, char *arg, const char *opt)
+{
+    char *r = NULL;
+
+    if (arg) {
+        warnx(_("*** multiple instances of command line option: `%s`"), opt);
+        errx(RI_PROGRAM_ERROR, _("*** See `%s --help` for more information."), COMMAND_NAME);
+    }
+
+    r = strdup(val);
+    assert(r != NULL);
+
+    return r;
+}
+
+/*
+ * Return the main configuration file to read: the -c file if given or
+ * the vendor one otherwise.  Returns NULL if it cannot be read, else
+ * the resolved path which the caller must free.
+ */
+static char *main_cfgfile(const char *cfgfile)
+{
+    char *path = NULL;
+    char *r = NULL;
+
+    if (cfgfile == NULL) {
+        xasprintf(&path, "%s/%s", VENDOR_DATA_DIR, CFGFILE);
+    } else {
+        path = strdup(cfgfile);
+        assert(path != NULL);
+    }
+
+    if (access(path, F_OK|R_OK) == 0) {
+        r = realpath(path, NULL);
+    }
+
+    free(path);
+    return r;
+}
+
+/*
+ * Helper used by nftw() in config_changed() to find the latest change
+ * time of the files below a directory.
+ */
+static int find_newest_change(__attribute__((unused)) const char *fpath, const struct stat *sb, __attribute__((unused)) int tflag, __attribute__((unused)) struct FTW *ftwbuf)
+{
+    if (sb->st_ctim.tv_sec > newest_change.tv_sec || (sb->st_ctim.tv_sec == newest_change.tv_sec && sb->st_ctim.tv_nsec > newest_change.tv_nsec)) {
+        newest_change = sb->st_ctim;
+    }
+
+    return 0;
+}
+
+/*
+ * True if the configuration files, profiles, or vendor data ri was
+ * read from changed since preloaded_changed was recorded.  The change
+ * time is used so files replaced with older copies are noticed too.
+ * The latest change time is left in newest_change.
+ */
+static bool config_changed(const struct rpminspect *ri)
+{
+    string_entry_t *entry = NULL;
+
+    assert(ri != NULL);
+
+    memset(&newest_change, 0, sizeof(newest_change));
+
+    if (ri->cfgfiles) {
+        TAILQ_FOREACH(entry, ri->cfgfiles, items) {
+            nftw(entry->data, find_newest_change, FOPEN_MAX, 0);
+        }
+    }
+
+    if (ri->profiledir) {
+        nftw(ri->profiledir, find_newest_change, FOPEN_MAX, 0);
+    }
+
+    if (ri->vendor_data_dir) {
+        nftw(ri->vendor_data_dir, find_newest_change, FOPEN_MAX, 0);
+    }
+
+    return newest_change.tv_sec != preloaded_changed.tv_sec || newest_change.tv_nsec != preloaded_changed.tv_nsec;
+}
+
+/*
+ * True if a --serve request reads the same main configuration file
+ * and profile the server preloaded, and they have not changed since.
+ */
+static bool is_preloaded(const char *cfgfile, const char *profile)
+{
+    if (!job_mode || preloaded == NULL || cfgfile == NULL || strcmp(cfgfile, preloaded_cfgfile)) {
+        return false;
+    }
+
+    if (profile == NULL || preloaded_profile == NULL) {
+        if (profile != preloaded_profile) {
+            return false;
+        }
+    } else if (strcmp(profile, preloaded_profile)) {
+        return false;
+    }
+
+    /* configuration edited since the server read it */
+    return !config_changed(preloaded);
+}
+
+/*
+ * Gather the diagnostic results, run the selected inspections on the
+ * builds in ri, and write the results to output.  Returns the exit
+ * code for the comparison.
+ */
+static int inspect_builds(struct rpminspect *ri, int argc, char **argv, int formatidx, const char *output, bool verbose)
+{
+    int ret = RI_SUCCESS;
+    int i = 0;
+    char *r = NULL;
+    char *tmp = NULL;
+    char *hsz = NULL;
+    char *tail = NULL;
+    size_t cmdlen = 0;
+    bool ires = false;
+    string_list_t *diags = NULL;
+    rpmpeer_entry_t *peer = NULL;
+    results_entry_t *last = NULL;
+    output_stream_t *stream = NULL;
+    pid_t early = 0;
+    FILE *earlyfp = NULL;
+    struct timing_mark mark;
+    const char *after_rel = NULL;
+    const char *before_rel = NULL;
+    struct result_params params;
+
+    assert(ri != NULL);
+
+    /* Determine product release unless the user specified one. */
+    if (ri->product_release == NULL) {
+        if (ri->peers == NULL || TAILQ_EMPTY(ri->peers)) {
+            free_rpminspect(ri);
+            rpmFreeMacros(NULL);
+            rpmFreeRpmrc();
+            errx(RI_PROGRAM_ERROR, _("*** no peers, ensure packages exist for specified architecture(s)"));
+        }
+
+        /* try to find a before and after peer */
+        TAILQ_FOREACH(peer, ri->peers, items) {
+            after_rel = headerGetString(peer->after_hdr, RPMTAG_RELEASE);
+
+            if (ri->before) {
+                before_rel = headerGetString(peer->before_hdr, RPMTAG_RELEASE);
+            }
+
+            if (before_rel && after_rel) {
+                break;
+            }
+        }
+
+        /* if we got here with no before and after release values, bad */
+        if ((ri->before && before_rel == NULL) && after_rel == NULL) {
+            free_rpminspect(ri);
+            rpmFreeMacros(NULL);
+            rpmFreeRpmrc();
+            errx(RI_PROGRAM_ERROR, _("*** unable to find a set of peer packages between the before and after builds"));
+        }
+
+        /* get the product release */
+        if (ri->product_release == NULL) {
+            ri->product_release = get_product_release(ri->products, ri->favor_release, before_rel, after_rel);
+        }
+
+        DEBUG_PRINT("product_release=%s\n", ri->product_release);
+
+        if (ri->product_release == NULL) {
+            free_rpminspect(ri);
+            rpmFreeMacros(NULL);
+            rpmFreeRpmrc();
+            errx(RI_PROGRAM_ERROR, _("*** unable to determine product release or none specified (-r)."));
+        }
+    }
+
+    /*
+     * In pipelined mode the packages not unpacked while downloading
+     * are extracted now while a child process runs the inspections
+     * that only read the headers and have no cached results.  Their
+     * results are replayed in order with the others below.
+     */
+    if (ri->pipeline) {
+        find_cached_results(ri);
+        early = start_header_inspections(ri, &earlyfp);
+        ret = extract_peers(ri, false);
+        finish_header_inspections(ri, early, earlyfp);
+
+        if (ret != RI_SUCCESS) {
+            warnx("*** %s", strexitcode(ret));
+            return ret;
+        }
+    }
+
+    /* general information in the results */
+    init_result_params(&params);
+    params.severity = RESULT_DIAG;
+    params.header = NAME_DIAGNOSTICS;
+
+    /* gather version information for dependent programs and libraries */
+    diags = gather_diags(ri, COMMAND_NAME, PACKAGE_VERSION);
+
+    /* add version information to the results output */
+    xasprintf(&params.msg, _("Version information for libraries and programs used by %s as well as storage requirements.  This result is for informational and diagnostic purposes only."), COMMAND_NAME);
+    params.details = list_to_string(diags, "\n");
+    params.details = strappend(params.details, "\n\n", NULL);
+
+    /* add disk space requirements */
+    hsz = human_size(ri->download_size);
+    assert(hsz != NULL);
+    xasprintf(&tmp, _("Space required to download artifacts: %lu bytes (%s)\n"), ri->download_size, hsz);
+    assert(tmp != NULL);
+    params.details = strappend(params.details, tmp, NULL);
+    free(tmp);
+    free(hsz);
+
+    hsz = human_size(ri->unpacked_size);
+    assert(hsz != NULL);
+    xasprintf(&tmp, _("Space required to unpack artifacts: %lu bytes (%s)\n"), ri->unpacked_size, hsz);
+    assert(tmp != NULL);
+    params.details = strappend(params.details, tmp, NULL);
+    free(tmp);
+    free(hsz);
+
+    add_result_entry(&ri->results, &params);
+    free(params.msg);
+    free(params.details);
+    list_free(diags, free);
+
+    /* add command line information to the results output */
+    xasprintf(&params.msg, _("Command line arguments used to invoke %s."), COMMAND_NAME);
+
+    for (i = 0; i < argc; i++) {
+        cmdlen += strlen(argv[i]) + 1;
+    }
+
+    params.details = xalloc(cmdlen + 1);
+    assert(params.details != NULL);
+    tail = params.details;
+
+    for (i = 0; i < argc; i++) {
+        if (i != 0) {
+            tail = stpcpy(tail, " ");
+        }
+
+        tail = stpcpy(tail, argv[i]);
+    }
+
+    add_result_entry(&ri->results, &params);
+    free(params.msg);
+    free(params.details);
+
+    /* report optional local configuration file */
+    if (ri->localcfg && ri->locallines && !TAILQ_EMPTY(ri->locallines)) {
+        xasprintf(&params.msg, _("Local configuration file: %s"), ri->localcfg);
+        params.details = list_to_string(ri->locallines, "\n");
+        add_result_entry(&ri->results, &params);
+        free(params.msg);
+        free(params.details);
+    }
+
+    /* add the builds */
+    if (ri->before != NULL) {
+        /* before build */
+        params.msg = _("Before Build");
+        params.details = ri->before;
+        add_result_entry(&ri->results, &params);
+
+        /* after build */
+        params.msg = _("After Build");
+    } else {
+        /* only have single build */
+        params.msg = _("Build");
+    }
+
+    params.details = ri->after;
+    add_result_entry(&ri->results, &params);
+
+    /* make sure the worst result is set before running inspections */
+    ri->worst_result = params.severity;
+
+    /*
+     * JSON and xUnit results going to a file are written out as each
+     * inspection finishes.  The diagnostics are held until the end
+     * because the timings (-m) are added to them then.
+     */
+    if (output != NULL) {
+        stream = open_output_stream(formatidx, output, ri->threshold, ri->suppress);
+    }
+
+    /* perform the selected inspections */
+    for (i = 0; inspections[i].name != NULL; i++) {
+        /* test not selected by user */
+        if (!(ri->tests & inspections[i].flag)) {
+            /*
+             * tell the user this inspection is skipped when in
+             * verbose mode
+             */
+            if (verbose) {
+                xasprintf(&r, _("Skipping %s inspection..."), inspections[i].name);
+                assert(r != NULL);
+                printf("%-36s", r);
+                free(r);
+
+                printf("%5s\n", _("skip"));
+            }
+
+            /* add a skipped result for this inspection */
+            init_result_params(&params);
+            params.header = inspections[i].name;
+            params.severity = RESULT_SKIP;
+            params.verb = VERB_SKIP;
+            add_result(ri, &params);
+
+            /* next inspection */
+            continue;
+        }
+
+        /* inspection requires before/after builds and we have one */
+        if (ri->before == NULL && !inspections[i].single_build) {
+            continue;
+        }
+
+        if (verbose) {
+            xasprintf(&r, _("Running %s inspection..."), inspections[i].name);
+            assert(r != NULL);
+            printf("%-36s", r);
+            free(r);
+        }
+
+        start_timing(ri, "inspection", inspections[i].name, &mark);
+        RI_PROBE1(inspection__start, inspections[i].name);
+
+        if (!replay_cached_results(ri, &inspections[i], &ires)) {
+            last = (ri->results == NULL) ? NULL : TAILQ_LAST(ri->results, results_s);
+            ires = inspections[i].driver(ri);
+            save_cached_results(ri, &inspections[i], last, ires);
+        }
+
+        RI_PROBE2(inspection__done, inspections[i].name, ires);
+        stop_timing(ri, "inspection", inspections[i].name, &mark);
+
+        if (stream != NULL) {
+            write_output_stream(stream, ri->results);
+        }
+
+        if (verbose) {
+            printf("%5s\n", ires ? _("pass") : _("FAIL"));
+        }
+    }
+
+    if (verbose) {
+        printf("\n");
+    }
+
+    /* output the results */
+    if (formatidx == -1) {
+        formatidx = 0;                 /* default to 'text' output */
+    }
+
+    /* report where the time went if asked to */
+    add_timings_result(ri);
+
+    if (stream != NULL) {
+        close_output_stream(stream, ri->results);
+    } else if (ri->results != NULL) {
+        formats[formatidx].driver(ri->results, output, ri->threshold, ri->suppress);
+    }
+
+    /* Set exit code based on result threshold */
+    if (ri->worst_result >= ri->threshold) {
+        ret = RI_INSPECTION_FAILURE;
+    }
+
+    emit_finish_event(ri);
+    return ret;
+}
+
+/*
+ * Read a batch mode job list.  Each line names an after build and the
+ * file to write the results of comparing it with the before build to,
+ * separated by whitespace.  Blank lines and lines starting with '#'
+ * are ignored.  Returns a list with the after builds as keys and the
+ * output files as values, or NULL if the job list cannot be read or
+ * is not valid.
+ */
+static pair_list_t *read_jobs(const char *jobfile)
+{
+    int line = 0;
+    int n = 0;
+    const char *after = NULL;
+    const char *output = NULL;
+    string_list_t *contents = NULL;
+    string_list_t *fields = NULL;
+    string_entry_t *entry = NULL;
+    string_entry_t *field = NULL;
+    pair_list_t *jobs = NULL;
+    pair_entry_t *job = NULL;
+
+    assert(jobfile != NULL);
+
+    contents = read_file(jobfile);
+
+    if (contents == NULL) {
+        warn(_("*** unable to read job list %s"), jobfile);
+        return NULL;
+    }
+
+    jobs = xalloc(sizeof(*jobs));
+    TAILQ_INIT(jobs);
+
+    TAILQ_FOREACH(entry, contents, items) {
+        line++;
+
+        if (*entry->data == '\0' || *entry->data == '#') {
+            continue;
+        }
+
+        /* runs of whitespace give empty fields, skip those */
+        fields = strsplit(entry->data, " \t");
+        after = NULL;
+        output = NULL;
+        n = 0;
+
+        TAILQ_FOREACH(field, fields, items) {
+            if (*field->data == '\0') {
+                continue;
+            }
+
+            n++;
+
+            if (n == 1) {
+                after = field->data;
+            } else if (n == 2) {
+                output = field->data;
+            }
+        }
+
+        if (n != 2) {
+            warnx(_("*** invalid job on line %d of %s, expected an after build and an output file"), line, jobfile);
+            list_free(fields, free);
+            list_free(contents, free);
+            free_pair(jobs);
+            return NULL;
+        }
+
+        job = xalloc(sizeof(*job));
+        job->key = strdup(after);
+        assert(job->key != NULL);
+        job->value = strdup(output);
+        assert(job->value != NULL);
+        TAILQ_INSERT_TAIL(jobs, job, items);
+
+        list_free(fields, free);
+    }
+
+    list_free(contents, free);
+
+    if (TAILQ_EMPTY(jobs)) {
+        warnx(_("*** job list %s is empty"), jobfile);
+        free_pair(jobs);
+        return NULL;
+    }
+
+    return jobs;
+}
+
+/*
+ * Batch mode.  Compare the before build with each after build in the
+ * job list and write each set of results to its own output file.
+ * The before build is only downloaded and extracted once, its headers
+ * and file lists as well as libmagic and the clamav engine stay
+ * loaded between comparisons.  Returns the worst exit code.
+ */
+static int run_batch(struct rpminspect *ri, pair_list_t *jobs, int argc, char **argv, int formatidx, bool verbose)
+{
+    int r = 0;
+    int ret = RI_SUCCESS;
+    bool user_release = false;
+    pair_entry_t *job = NULL;
+
+    assert(ri != NULL);
+    assert(ri->before != NULL);
+    assert(jobs != NULL);
+
+    user_release = (ri->product_release != NULL);
+
+    TAILQ_FOREACH(job, jobs, items) {
+        free(ri->after);
+        ri->after = strdup(job->key);
+        assert(ri->after != NULL);
+
+        if (verbose) {
+            printf(_("Comparing %s to %s, writing results to %s\n"), ri->before, ri->after, job->value);
+        }
+
+        if (job == TAILQ_FIRST(jobs)) {
+            r = gather_builds(ri, false);
+        } else {
+            /* results and the release belong to the previous comparison */
+            free_results(ri->results);
+            ri->results = NULL;
+
+            if (!user_release) {
+                free(ri->product_release);
+                ri->product_release = NULL;
+            }
+
+            r = regather_after_build(ri);
+        }
+
+        if (r) {
+            if (r > 0) {
+                warnx("*** %s", strexitcode(r));
+            }
 
-/*
- * Copy the option argument, but error out if we have already done
- * that.  Enforces single use of options on the command line.
- */
-static char *gather_arg(char *val, char *arg, const char *opt)
-{
-    char *r = NULL;
+            return r;
+        }
 
-    if (arg) {
-        warnx(_("*** multiple instances of command line option: `%s`"), opt);
-        errx(RI_PROGRAM_ERROR, _("*** See `%s --help` for more information."), COMMAND_NAME);
+        if (inspect_builds(ri, argc, argv, formatidx, job->value, verbose) != RI_SUCCESS) {
+            ret = RI_INSPECTION_FAILURE;
+        }
     }
 
-    r = strdup(val);
-    assert(r != NULL);
-
-    return r;
+    return ret;
 }
 
-int main(int argc, char **argv)
+/*
+ * Run one rpminspect command line.  This is the whole program for a
+ * normal invocation and the job run for every request in --serve mode.
+ */
+static int run(int argc, char **argv)
 {
     struct sigaction abrt;
     struct sigaction winch;
@@ -339,7 +897,7 @@ int main(int argc, char **argv)
     int ret = RI_SUCCESS;
     wordexp_t expand;
     struct stat sb;
-    char *short_options = "c:p:T:E:a:r:nb:o:F:lw:t:s:fkdDv\?V";
+    char *short_options = "c:p:T:E:a:r:nb:o:F:lw:t:s:fkPj:B:S:C:R:m:e:dDK:v\?V";
     struct option long_options[] = {
         { "config", required_argument, 0, 'c' },
         { "profile", required_argument, 0, 'p' },
@@ -357,22 +915,30 @@ int main(int argc, char **argv)
         { "suppress", required_argument, 0, 's' },
         { "fetch-only", no_argument, 0, 'f' },
         { "keep", no_argument, 0, 'k' },
+        { "pipeline", no_argument, 0, 'P' },
+        { "workers", required_argument, 0, 'j' },
+        { "batch", required_argument, 0, 'B' },
+        { "serve", required_argument, 0, 'S' },
+        { "connect", required_argument, 0, 'C' },
+        { "result-cache", required_argument, 0, 'R' },
+        { "timings", required_argument, 0, 'm' },
+        { "events", required_argument, 0, 'e' },
         { "debug", no_argument, 0, 'd' },
         { "dump-config", no_argument, 0, 'D' },
+        { "compile-config", required_argument, 0, 'K' },
         { "verbose", no_argument, 0, 'v' },
         { "help", no_argument, 0, '?' },
         { "version", no_argument, 0, 'V' },
         { 0, 0, 0, 0 }
     };
     char *cfgfile = NULL;
-    char *tmp_cfgfile = NULL;
+    char *mainconf = NULL;
     char *profile = NULL;
     bool initialized = false;
     char *archopt = NULL;
     char *walk = NULL;
     char *token = NULL;
     char *cwd = NULL;
-    char *r = NULL;
     char *output = NULL;
     char *release = NULL;
     bool rebase_detection = true;
@@ -382,9 +948,21 @@ int main(int argc, char **argv)
     int formatidx = -1;
     bool fetch_only = false;
     bool keep = false;
+    bool pipeline = false;
+    char *workers = NULL;
+    unsigned long int nworkers = 0;
+    char *jobfile = NULL;
+    pair_list_t *jobs = NULL;
+    char *serve_path = NULL;
+    char *connect_path = NULL;
+    char *rescache = NULL;
+    char *timings = NULL;
+    char *events = NULL;
+    struct timing_mark mark;
     bool list = false;
     bool verbose = false;
     bool dump_config = false;
+    char *compile = NULL;
     int mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
     bool found = false;
     char *inspection = NULL;
@@ -396,15 +974,6 @@ int main(int argc, char **argv)
     size_t width = tty_width();
     string_list_t *valid_arches = NULL;
     string_entry_t *arch = NULL;
-    rpmpeer_entry_t *peer = NULL;
-    const char *after_rel = NULL;
-    const char *before_rel = NULL;
-    char *hsz = NULL;
-    struct result_params params;
-    size_t cmdlen = 0;
-    char *tail = NULL;
-    bool ires = false;
-    string_list_t *diags = NULL;
     struct rpminspect *ri = NULL;
 
     /* Be friendly to "rpminspect ... 2>&1 | tee" use case */
@@ -550,12 +1119,46 @@ int main(int argc, char **argv)
             case 'k':
                 keep = true;
                 break;
+            case 'P':
+                pipeline = true;
+                break;
+            case 'j':
+                workers = gather_arg(optarg, workers, "-j");
+                break;
+            case 'B':
+                jobfile = gather_arg(optarg, jobfile, "-B");
+                break;
+            case 'S':
+                /* a job sent to the service cannot start another one */
+                if (!job_mode) {
+                    serve_path = gather_arg(optarg, serve_path, "-S");
+                }
+
+                break;
+            case 'C':
+                if (!job_mode) {
+                    connect_path = gather_arg(optarg, connect_path, "-C");
+                }
+
+                break;
+            case 'R':
+                rescache = gather_arg(optarg, rescache, "-R");
+                break;
+            case 'm':
+                timings = gather_arg(optarg, timings, "-m");
+                break;
+            case 'e':
+                events = gather_arg(optarg, events, "-e");
+                break;
             case 'd':
                 set_debug_mode(true);
                 break;
             case 'D':
                 dump_config = true;
                 break;
+            case 'K':
+                compile = gather_arg(optarg, compile, "-K");
+                break;
             case 'v':
                 verbose = true;
                 break;
@@ -570,6 +1173,57 @@ int main(int argc, char **argv)
         }
     }
 
+    /* a descriptor number would name a descriptor of the service, not this process */
+    if (events && is_events_fd(events) && (connect_path || job_mode)) {
+        errx(RI_PROGRAM_ERROR, _("*** -e with a file descriptor cannot be used with -C."));
+    }
+
+    /* hand the whole command line to a running service */
+    if (connect_path) {
+        if (serve_path) {
+            errx(RI_PROGRAM_ERROR, _("*** -S and -C cannot be used together."));
+        }
+
+        ret = serve_request(connect_path, argc, argv);
+        free(connect_path);
+        return ret;
+    }
+
+    /*
+     * Service mode loads libmagic, the clamav engine, the configuration
+     * and the license database indexes once and then forks for every
+     * request.  Requests naming a different configuration file or
+     * profile, or arriving after the configuration, profiles, or
+     * vendor data were edited, read their own.  The clamav engine is
+     * reloaded when the service is idle if its databases changed, and
+     * a request that needs it before then reloads it on its own.
+     */
+    if (serve_path) {
+        preload_magic();
+        preload_virus_engine();
+        preloaded_cfgfile = main_cfgfile(cfgfile);
+
+        if (preloaded_cfgfile) {
+            preloaded = read_rpminspect_config(NULL, preloaded_cfgfile, profile);
+            preloaded_profile = profile;
+            profile = NULL;
+            load_license_index(preloaded);
+
+            /* requests read their own once any of it is edited */
+            config_changed(preloaded);
+            preloaded_changed = newest_change;
+        }
+
+        ret = serve(serve_path, &run_job, &refresh_virus_engine);
+        free(serve_path);
+        free(cfgfile);
+        free(profile);
+        free(preloaded_cfgfile);
+        free(preloaded_profile);
+        free_rpminspect(preloaded);
+        return ret;
+    }
+
     /* list inspections and formats and exit if asked to */
     if (list) {
         /* list the available build types */
@@ -631,10 +1285,35 @@ int main(int argc, char **argv)
     }
 
     /* Set up the main program data structure */
+    mainconf = main_cfgfile(cfgfile);
+
+    if (is_preloaded(mainconf, profile)) {
+        ri = preloaded;
+    }
+
     ri = xalloc_rpminspect(ri);
     ri->progname = strdup(argv[0]);
     ri->verbose = verbose;
     ri->rebase_detection = rebase_detection;
+    ri->pipeline = pipeline;
+    ri->compile_config = (compile != NULL);
+
+    /* record timings from here on if asked to */
+    if (timings) {
+        ri->timings = xalloc(sizeof(*ri->timings));
+        TAILQ_INIT(ri->timings);
+    }
+
+    /* stream events as they happen if asked to */
+    if (events) {
+        if (!open_events(ri, events)) {
+            err(RI_PROGRAM_ERROR, _("*** error opening %s for writing"), events);
+        }
+
+        free(events);
+    }
+
+    start_timing(ri, "phase", "config", &mark);
 
     /*
      * Find an appropriate configuration file. This involves:
@@ -646,27 +1325,21 @@ int main(int argc, char **argv)
      * This loop also handles reading in multiple configuration files
      * for overrides.
      */
-    xasprintf(&tmp_cfgfile, "%s/%s", VENDOR_DATA_DIR, CFGFILE);
-
-    if (cfgfile == NULL && (access(tmp_cfgfile, F_OK|R_OK) == 0)) {
-        /* /usr/share/rpminspect/rpminspect.yaml exists */
-        ri = init_rpminspect(ri, tmp_cfgfile, profile);
+    if (ri == preloaded) {
+        /* the server already read it */
+        ri = init_local_rpminspect(ri);
         initialized = true;
-
-        if (ri == NULL) {
-            errx(RI_PROGRAM_ERROR, _("*** failed to read configuration file %s"), tmp_cfgfile);
-        }
-    } else if (cfgfile && (access(cfgfile, F_OK|R_OK) == 0)) {
-        /* -c configuration file if it exists */
-        ri = init_rpminspect(ri, cfgfile, profile);
+    } else if (mainconf) {
+        /* -c configuration file or /usr/share/rpminspect/rpminspect.yaml */
+        ri = init_rpminspect(ri, mainconf, profile);
         initialized = true;
 
         if (ri == NULL) {
-            errx(RI_PROGRAM_ERROR, _("*** failed to read configuration file %s"), cfgfile);
+            errx(RI_PROGRAM_ERROR, _("*** failed to read configuration file %s"), mainconf);
         }
     }
 
-    free(tmp_cfgfile);
+    free(mainconf);
     free(cfgfile);
 
     /*
@@ -688,6 +1361,18 @@ int main(int argc, char **argv)
         errx(RI_PROGRAM_ERROR, _("*** Please specify a configuration file using '-c' or supply ./%s"), CFGFILE);
     }
 
+    stop_timing(ri, "phase", "config", &mark);
+
+    /* Write a configuration snapshot and exit if asked to */
+    if (compile) {
+        ret = write_snapshot(ri, compile, profile, release ? release : ri->product_release);
+        free(compile);
+        free(profile);
+        free(release);
+        free_rpminspect(ri);
+        return (ret == 0) ? RI_SUCCESS : RI_PROGRAM_ERROR;
+    }
+
     free(profile);
 
     /* Product release specified on the command line overrides config file */
@@ -699,6 +1384,20 @@ int main(int argc, char **argv)
     /* Koji build type may have been specified */
     ri->buildtype = buildtype;
 
+    /* Worker count on the command line overrides the config file */
+    if (workers) {
+        errno = 0;
+        nworkers = strtoul(workers, &tmp, 10);
+
+        if (errno != 0 || *tmp != '\0' || *workers == '-' || nworkers == 0 || nworkers > 1024) {
+            free_rpminspect(ri);
+            errx(RI_PROGRAM_ERROR, _("*** Invalid number of workers: %s"), workers);
+        }
+
+        default_parallel_processes = nworkers;
+        free(workers);
+    }
+
     /* Reporting threshold and suppression levels */
     ri->threshold = getseverity(threshold, RESULT_VERIFY);
     ri->suppress = getseverity(suppress, RESULT_NULL);
@@ -749,7 +1448,24 @@ int main(int argc, char **argv)
      * (a before and after build).  Except for fetch-only we can take a
      * list of builds.
      */
-    if (!fetch_only) {
+    if (jobfile) {
+        /* batch mode takes just the before build, after builds are in the job list */
+        if (fetch_only || output || optind != (argc - 1)) {
+            free_rpminspect(ri);
+            warnx(_("*** Batch mode takes a single before build and cannot be used with -f or -o."));
+            errx(RI_PROGRAM_ERROR, _("*** See `%s --help` for more information."), COMMAND_NAME);
+        }
+
+        ri->before = strdup(argv[optind]);
+        assert(ri->before != NULL);
+        jobs = read_jobs(jobfile);
+        free(jobfile);
+
+        if (jobs == NULL) {
+            free_rpminspect(ri);
+            exit(RI_PROGRAM_ERROR);
+        }
+    } else if (!fetch_only) {
         if (optind == (argc - 1)) {
             /* only a single build specified */
             ri->after = strdup(argv[optind]);
@@ -769,6 +1485,9 @@ int main(int argc, char **argv)
         }
     }
 
+    /* work out which phases the selected inspections need */
+    ri->needs = inspection_needs(ri->tests, ri->before == NULL);
+
     /* initialize librpm, we'll be using it */
     if (init_librpm(ri) != RPMRC_OK) {
         errx(RI_PROGRAM_ERROR, _("*** unable to read RPM configuration"));
@@ -823,6 +1542,18 @@ int main(int argc, char **argv)
         errx(RI_PROGRAM_ERROR, _("*** unable to create directory %s"), ri->workdir);
     }
 
+    /* create the result cache directory */
+    if (rescache) {
+        if (mkdirp(rescache, mode)) {
+            free_rpminspect(ri);
+            rpmFreeMacros(NULL);
+            rpmFreeRpmrc();
+            errx(RI_PROGRAM_ERROR, _("*** unable to create directory %s"), rescache);
+        }
+
+        ri->result_cache = rescache;
+    }
+
     /* validate and gather the builds specified */
     if (fetch_only) {
         /* iterate over each specified build and fetch it */
@@ -854,6 +1585,10 @@ int main(int argc, char **argv)
         rpmFreeMacros(NULL);
         rpmFreeRpmrc();
         return RI_SUCCESS;
+    } else if (jobs != NULL) {
+        /* compare the before build with each after build in the job list */
+        ret = run_batch(ri, jobs, argc, argv, formatidx, verbose);
+        free_pair(jobs);
     } else {
         j = gather_builds(ri, false);
 
@@ -868,207 +1603,15 @@ int main(int argc, char **argv)
                 exit(j);
             }
         }
-    }
-
-    /* general information in the results */
-    init_result_params(&params);
-    params.severity = RESULT_DIAG;
-    params.header = NAME_DIAGNOSTICS;
-
-    /* gather version information for dependent programs and libraries */
-    diags = gather_diags(ri, COMMAND_NAME, PACKAGE_VERSION);
-
-    /* add version information to the results output */
-    xasprintf(&params.msg, _("Version information for libraries and programs used by %s as well as storage requirements.  This result is for informational and diagnostic purposes only."), COMMAND_NAME);
-    params.details = list_to_string(diags, "\n");
-    params.details = strappend(params.details, "\n\n", NULL);
-
-    /* add disk space requirements */
-    hsz = human_size(ri->download_size);
-    assert(hsz != NULL);
-    xasprintf(&tmp, _("Space required to download artifacts: %lu bytes (%s)\n"), ri->download_size, hsz);
-    assert(tmp != NULL);
-    params.details = strappend(params.details, tmp, NULL);
-    free(tmp);
-    free(hsz);
-
-    hsz = human_size(ri->unpacked_size);
-    assert(hsz != NULL);
-    xasprintf(&tmp, _("Space required to unpack artifacts: %lu bytes (%s)\n"), ri->unpacked_size, hsz);
-    assert(tmp != NULL);
-    params.details = strappend(params.details, tmp, NULL);
-    free(tmp);
-    free(hsz);
-
-    add_result_entry(&ri->results, &params);
-    free(params.msg);
-    free(params.details);
-    list_free(diags, free);
-
-    /* add command line information to the results output */
-    xasprintf(&params.msg, _("Command line arguments used to invoke %s."), COMMAND_NAME);
-
-    for (i = 0; i < argc; i++) {
-        cmdlen += strlen(argv[i]) + 1;
-    }
-
-    params.details = xalloc(cmdlen + 1);
-    assert(params.details != NULL);
-    tail = params.details;
-
-    for (i = 0; i < argc; i++) {
-        if (i != 0) {
-            tail = stpcpy(tail, " ");
-        }
-
-        tail = stpcpy(tail, argv[i]);
-    }
-
-    add_result_entry(&ri->results, &params);
-    free(params.msg);
-    free(params.details);
-
-    /* report optional local configuration file */
-    if (ri->localcfg && ri->locallines && !TAILQ_EMPTY(ri->locallines)) {
-        xasprintf(&params.msg, _("Local configuration file: %s"), ri->localcfg);
-        params.details = list_to_string(ri->locallines, "\n");
-        add_result_entry(&ri->results, &params);
-        free(params.msg);
-        free(params.details);
-    }
-
-    /* add the builds */
-    if (ri->before != NULL) {
-        /* before build */
-        params.msg = _("Before Build");
-        params.details = ri->before;
-        add_result_entry(&ri->results, &params);
 
-        /* after build */
-        params.msg = _("After Build");
-    } else {
-        /* only have single build */
-        params.msg = _("Build");
+        ret = inspect_builds(ri, argc, argv, formatidx, output, verbose);
     }
 
-    params.details = ri->after;
-    add_result_entry(&ri->results, &params);
-
-    /* make sure the worst result is set before running inspections */
-    ri->worst_result = params.severity;
-
-    /* perform the selected inspections */
-    if (!fetch_only) {
-        /* Determine product release unless the user specified one. */
-        if (ri->product_release == NULL) {
-            if (ri->peers == NULL || TAILQ_EMPTY(ri->peers)) {
-                free_rpminspect(ri);
-                rpmFreeMacros(NULL);
-                rpmFreeRpmrc();
-                errx(RI_PROGRAM_ERROR, _("*** no peers, ensure packages exist for specified architecture(s)"));
-            }
-
-            /* try to find a before and after peer */
-            TAILQ_FOREACH(peer, ri->peers, items) {
-                after_rel = headerGetString(peer->after_hdr, RPMTAG_RELEASE);
+    free(output);
 
-                if (ri->before) {
-                    before_rel = headerGetString(peer->before_hdr, RPMTAG_RELEASE);
-                }
-
-                if (before_rel && after_rel) {
-                    break;
-                }
-            }
-
-            /* if we got here with no before and after release values, bad */
-            if ((ri->before && before_rel == NULL) && after_rel == NULL) {
-                free_rpminspect(ri);
-                rpmFreeMacros(NULL);
-                rpmFreeRpmrc();
-                errx(RI_PROGRAM_ERROR, _("*** unable to find a set of peer packages between the before and after builds"));
-            }
-
-            /* get the product release */
-            if (ri->product_release == NULL) {
-                ri->product_release = get_product_release(ri->products, ri->favor_release, before_rel, after_rel);
-            }
-
-            DEBUG_PRINT("product_release=%s\n", ri->product_release);
-
-            if (ri->product_release == NULL) {
-                free_rpminspect(ri);
-                rpmFreeMacros(NULL);
-                rpmFreeRpmrc();
-                errx(RI_PROGRAM_ERROR, _("*** unable to determine product release or none specified (-r)."));
-            }
-        }
-
-        for (i = 0; inspections[i].name != NULL; i++) {
-            /* test not selected by user */
-            if (!(ri->tests & inspections[i].flag)) {
-                /*
-                 * tell the user this inspection is skipped when in
-                 * verbose mode
-                 */
-                if (verbose) {
-                    xasprintf(&r, _("Skipping %s inspection..."), inspections[i].name);
-                    assert(r != NULL);
-                    printf("%-36s", r);
-                    free(r);
-
-                    printf("%5s\n", _("skip"));
-                }
-
-                /* add a skipped result for this inspection */
-                init_result_params(&params);
-                params.header = inspections[i].name;
-                params.severity = RESULT_SKIP;
-                params.verb = VERB_SKIP;
-                add_result(ri, &params);
-
-                /* next inspection */
-                continue;
-            }
-
-            /* inspection requires before/after builds and we have one */
-            if (ri->before == NULL && !inspections[i].single_build) {
-                continue;
-            }
-
-            if (verbose) {
-                xasprintf(&r, _("Running %s inspection..."), inspections[i].name);
-                assert(r != NULL);
-                printf("%-36s", r);
-                free(r);
-            }
-
-            ires = inspections[i].driver(ri);
-
-            if (verbose) {
-                printf("%5s\n", ires ? _("pass") : _("FAIL"));
-            }
-        }
-
-        if (verbose) {
-            printf("\n");
-        }
-
-        /* output the results */
-        if (formatidx == -1) {
-            formatidx = 0;                 /* default to 'text' output */
-        }
-
-        if (ri->results != NULL) {
-            formats[formatidx].driver(ri->results, output, ri->threshold, ri->suppress);
-        }
-
-        free(output);
-    }
-
-    /* Set exit code based on result threshold */
-    if (ri->worst_result >= ri->threshold) {
-        ret = RI_INSPECTION_FAILURE;
+    if (timings) {
+        write_timings(ri, timings);
+        free(timings);
     }
 
     /* Clean up */
@@ -1087,3 +1630,20 @@ int main(int argc, char **argv)
 
     return ret;
 }
+
+/*
+ * Run a request received by the --serve mode.  This happens in a
+ * process forked from the server, so getopt is reset and the command
+ * line is parsed from the start.
+ */
+static int run_job(int argc, char **argv)
+{
+    job_mode = true;
+    optind = 0;
+    return run(argc, argv);
+}
+
+int main(int argc, char **argv)
+{
+    return run(argc, argv);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Benchmark the per-file library calls every run makes on each payload
+ * file: computing checksums, detecting MIME types, and matching the
+ * configured ignore rules for every inspection.  Takes a configuration
+ * file and an unpacked payload tree and prints one JSON object with the
+ * files handled, the time taken, and the files per second for each.
+ * For the ignore rules a "file" is one file and inspection pair.
+ *
+ * Usage: bench-files CONFIG ROOT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <ftw.h>
+#include <err.h>
+#include <sys/stat.h>
+
+#include "rpminspect.h"
+
+/* payload files found under the root */
+static char **paths = NULL;
+static size_t npaths = 0;
+static size_t nalloc = 0;
+static size_t rootlen = 0;
+
+static int collect(const char *fpath, const struct stat *sb, int typeflag, __attribute__((unused)) struct FTW *ftwbuf)
+{
+    if (typeflag != FTW_F || !S_ISREG(sb->st_mode)) {
+        return 0;
+    }
+
+    if (npaths == nalloc) {
+        nalloc = nalloc ? nalloc * 2 : 1024;
+        paths = xrealloc(paths, nalloc * sizeof(*paths));
+    }
+
+    paths[npaths] = strdup(fpath);
+    assert(paths[npaths] != NULL);
+    npaths++;
+    return 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1000000000.0);
+}
+
+static void report(const char *name, size_t files, double seconds, bool last)
+{
+    printf("    \"%s\": { \"files\": %zu, \"seconds\": %.6f, \"files/sec\": %.1f }%s\n",
+           name, files, seconds, seconds > 0 ? files / seconds : 0, last ? "" : ",");
+    return;
+}
+
+int main(int argc, char **argv)
+{
+    size_t i = 0;
+    size_t n = 0;
+    int j = 0;
+    double start = 0;
+    char *digest = NULL;
+    struct rpminspect *ri = NULL;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s CONFIG ROOT\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ri = init_rpminspect(NULL, argv[1], NULL);
+
+    if (ri == NULL) {
+        errx(EXIT_FAILURE, "unable to read %s", argv[1]);
+    }
+
+    rootlen = strlen(argv[2]);
+
+    if (nftw(argv[2], collect, 64, FTW_PHYS) == -1) {
+        err(EXIT_FAILURE, "nftw %s", argv[2]);
+    }
+
+    printf("{\n");
+
+    /* checksums, the way the changedfiles and other inspections ask for them */
+    start = now();
+
+    for (i = 0; i < npaths; i++) {
+        digest = compute_checksum(paths[i], NULL, SHA256SUM);
+        free(digest);
+    }
+
+    report("checksum", npaths, now() - start, false);
+
+    /* MIME types, uncached as every new file is */
+    start = now();
+
+    for (i = 0; i < npaths; i++) {
+        mime_type(ri, paths[i]);
+    }
+
+    report("mime", npaths, now() - start, false);
+
+    /* ignore rules for every inspection, as foreach_peer_file() checks them */
+    start = now();
+
+    for (i = 0; i < npaths; i++) {
+        for (j = 0; inspections[j].name != NULL; j++) {
+            ignore_path(ri, inspections[j].name, paths[i] + rootlen, argv[2]);
+            n++;
+        }
+    }
+
+    report("ignore", n, now() - start, true);
+    printf("}\n");
+
+    for (i = 0; i < npaths; i++) {
+        free(paths[i]);
+    }
+
+    free(paths);
+    free_rpminspect(ri);
+    return EXIT_SUCCESS;
+}
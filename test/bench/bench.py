@@ -0,0 +1,252 @@
+#!/usr/bin/python3
+#
+# Copyright The rpminspect Project Authors
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+# Throughput benchmarks for rpminspect.  Generates a synthetic before
+# and after build (see genbuild.py), compares them with every
+# inspection enabled while recording timings (-m), and then runs
+# bench-files on the unpacked after payload to measure checksums, MIME
+# detection, and ignore matching on their own.
+#
+# The results are written as JSON with files/sec for extraction, peer
+# matching, each inspection, and each library call, along with the
+# peak RSS of the whole run.  Pass --baseline with an earlier results
+# file to fail when throughput drops or memory use grows by more than
+# --tolerance.  This is what 'meson test --benchmark' runs.
+#
+# Requires rpmbuild(8) and either bsdtar(1) or rpm2cpio(8) and cpio(1).
+#
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import yaml
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import genbuild  # noqa: E402
+
+
+def config_file(path, workdir):
+    """Write a configuration file for the benchmark run."""
+    with open(os.environ["RPMINSPECT_YAML"], "r") as f:
+        cfg = yaml.full_load(f)
+
+    if "RPMINSPECT_TEST_DATA_PATH" in os.environ:
+        cfg["vendor"]["vendor_data_dir"] = os.environ["RPMINSPECT_TEST_DATA_PATH"]
+        cfg["vendor"]["licensedb"] = ["test.json"]
+
+    cfg["common"]["workdir"] = workdir
+
+    with open(path, "w") as f:
+        f.write(yaml.dump(cfg, width=float("inf")).replace("- ", "  - "))
+
+
+def run_rpminspect(args, conffile, before, after, outdir):
+    """
+    Compare the builds and return the recorded timings, the wall time,
+    and the peak RSS in KiB.
+    """
+    timings = os.path.join(outdir, "timings.json")
+    cmd = [
+        args.rpminspect,
+        "-c", conffile,
+        "-F", "json",
+        "-o", os.path.join(outdir, "results.json"),
+        "-m", timings,
+        before,
+        after,
+    ]
+
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+
+    # drain stderr before reaping so a chatty run cannot fill the pipe and block
+    err = proc.stderr.read()
+    proc.stderr.close()
+    (pid, status, usage) = os.wait4(proc.pid, 0)
+    wall = time.monotonic() - start
+    proc.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+
+    # 0 and 1 are both fine, the synthetic builds are expected to fail some inspections
+    if proc.returncode not in [0, 1]:
+        sys.stderr.write(err.decode(errors="replace"))
+        raise RuntimeError("rpminspect exited with %d" % proc.returncode)
+
+    with open(timings, "r") as f:
+        return (json.load(f), wall, usage.ru_maxrss)
+
+
+def unpack(build, dest):
+    """Unpack every binary package of the build under dest."""
+    os.makedirs(dest, exist_ok=True)
+
+    for (root, dirs, files) in os.walk(build):
+        if os.path.basename(root) == "src":
+            continue
+
+        for name in files:
+            rpm = os.path.join(root, name)
+
+            if not name.endswith(".rpm"):
+                continue
+
+            if shutil.which("bsdtar"):
+                subprocess.run(["bsdtar", "-xf", rpm, "-C", dest], check=True)
+            else:
+                rpm2cpio = subprocess.Popen(["rpm2cpio", rpm], stdout=subprocess.PIPE)
+                subprocess.run(["cpio", "-idm", "--quiet"], stdin=rpm2cpio.stdout, cwd=dest, check=True)
+                rpm2cpio.stdout.close()
+                rpm2cpio.wait()
+
+
+def rate(files, seconds):
+    return round(files / seconds, 1) if seconds > 0 else 0
+
+
+def summarize(timings, payload):
+    """Turn the -m timings in to files/sec per phase and inspection."""
+    ret = {"phases": {}, "inspections": {}}
+
+    for t in timings:
+        group = "phases" if t["type"] == "phase" else "inspections"
+        files = t["files"] if t["files"] > 0 else payload
+
+        ret[group][t["name"]] = {
+            "files": files,
+            "seconds": round(t["wall"], 6),
+            "cpu": round(t["cpu"], 6),
+            "rss delta": t["rss delta"],
+            "commands": t["commands"],
+            "files/sec": rate(files, t["wall"]),
+        }
+
+    return ret
+
+
+def compare(baseline, current, tolerance):
+    """Print the differences from the baseline, return the regressions."""
+    regressions = []
+
+    for group in ["phases", "inspections", "library"]:
+        for (name, old) in sorted(baseline.get(group, {}).items()):
+            new = current.get(group, {}).get(name)
+
+            if new is None or old["files/sec"] == 0:
+                continue
+
+            change = (new["files/sec"] - old["files/sec"]) / old["files/sec"]
+            flag = ""
+
+            if change < -tolerance:
+                flag = "  REGRESSION"
+                regressions.append("%s/%s" % (group, name))
+
+            print("%-12s %-24s %12.1f %12.1f %+8.1f%%%s" % (group, name, old["files/sec"], new["files/sec"], change * 100, flag))
+
+    old = baseline.get("run", {}).get("peak rss", 0)
+    new = current["run"]["peak rss"]
+
+    if old > 0:
+        change = (new - old) / old
+        flag = ""
+
+        if change > tolerance:
+            flag = "  REGRESSION"
+            regressions.append("run/peak rss")
+
+        print("%-12s %-24s %12d %12d %+8.1f%%%s" % ("run", "peak rss (KiB)", old, new, change * 100, flag))
+
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark rpminspect on synthetic builds.")
+    genbuild.add_arguments(parser)
+    parser.add_argument("--rpminspect", default=os.environ.get("RPMINSPECT"), help="rpminspect executable (default: $RPMINSPECT)")
+    parser.add_argument("--bench-files", default=None, help="bench-files executable for the library benchmarks")
+    parser.add_argument("--workdir", default=None, help="directory for the generated builds (default: $TMPDIR)")
+    parser.add_argument("--output", default="benchmark.json", help="write results to this file (default: benchmark.json)")
+    parser.add_argument("--baseline", default=os.environ.get("RPMINSPECT_BENCH_BASELINE") or None,
+                        help="compare against results from an earlier run (default: $RPMINSPECT_BENCH_BASELINE)")
+    parser.add_argument("--tolerance", type=float, default=0.25, help="allowed slowdown or memory growth (default: 0.25)")
+    parser.add_argument("--keep", action="store_true", help="keep the generated builds and results")
+    args = parser.parse_args()
+
+    if not args.rpminspect or "RPMINSPECT_YAML" not in os.environ:
+        sys.stderr.write("*** set RPMINSPECT and RPMINSPECT_YAML or pass --rpminspect\n")
+        return 1
+
+    if shutil.which("rpmbuild") is None:
+        sys.stderr.write("*** rpmbuild not found in PATH\n")
+        return 1
+
+    top = tempfile.mkdtemp(prefix="rpminspect-bench-", dir=args.workdir)
+
+    try:
+        (before, after) = genbuild.generate(args, top)
+        conffile = os.path.join(top, "rpminspect.yaml")
+        config_file(conffile, os.path.join(top, "work"))
+        os.makedirs(os.path.join(top, "work"))
+
+        (timings, wall, maxrss) = run_rpminspect(args, conffile, before, after, top)
+        payload = sum(t["files"] for t in timings if t["type"] == "phase" and t["name"] == "extract")
+
+        results = {
+            "parameters": {
+                "files": args.files,
+                "subpackages": args.subpackages,
+                "mix": args.mix,
+                "lines": args.lines,
+                "symlinks": args.symlinks,
+                "renames": args.renames,
+                "changes": args.changes,
+                "seed": args.seed,
+            },
+            "run": {
+                "files": payload,
+                "seconds": round(wall, 6),
+                "files/sec": rate(payload, wall),
+                "peak rss": maxrss,
+            },
+        }
+        results.update(summarize(timings, payload))
+
+        if args.bench_files:
+            tree = os.path.join(top, "payload")
+            unpack(after, tree)
+            out = subprocess.run([args.bench_files, conffile, tree], stdout=subprocess.PIPE, check=True)
+            results["library"] = json.loads(out.stdout)
+
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=4, sort_keys=True)
+            f.write("\n")
+
+        print("results written to %s" % args.output)
+
+        if args.baseline:
+            with open(args.baseline, "r") as f:
+                baseline = json.load(f)
+
+            regressions = compare(baseline, results, args.tolerance)
+
+            if regressions:
+                sys.stderr.write("*** slower or larger than the baseline: %s\n" % ", ".join(regressions))
+                return 1
+    finally:
+        if args.keep:
+            print("generated builds kept in %s" % top)
+        else:
+            shutil.rmtree(top, ignore_errors=True)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
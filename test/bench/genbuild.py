@@ -0,0 +1,273 @@
+#!/usr/bin/python3
+#
+# Copyright The rpminspect Project Authors
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+# Generate a synthetic before and after build for benchmarking.  The
+# builds are laid out like a local Koji build (src/ and one directory
+# per architecture) and can be passed straight to rpminspect.
+#
+# The payload is made up at the requested scale:
+#
+#     --files N          payload files per subpackage
+#     --subpackages N    number of subpackages besides the main one
+#     --mix E:T:C        relative share of ELF, text, and gzip files
+#     --symlinks F       fraction of files that get a symlink to them
+#     --renames F        fraction of files moved to a versioned path in
+#                        the after build so peer matching has work to do
+#     --changes F        fraction of files whose contents change
+#
+# ELF files are copies of a small system executable with some unique
+# bytes appended, which keeps them valid ELF objects.  rpmbuild post
+# processing and dependency generation are turned off so building a
+# large package only costs the time to write the payload.
+#
+# Requires rpmbuild(8).
+#
+
+import argparse
+import gzip
+import os
+import random
+import shutil
+import subprocess
+import sys
+
+NAME = "benchware"
+BEFORE_VER = "1.0"
+AFTER_VER = "1.1"
+BEFORE_REL = "1"
+AFTER_REL = "1"
+
+WORDS = (
+    "alpha bravo charlie delta echo foxtrot golf hotel india juliett kilo lima mike "
+    "november oscar papa quebec romeo sierra tango uniform victor whiskey xray yankee zulu"
+).split()
+
+
+def elf_template():
+    """Return the bytes of a small ELF executable to copy."""
+    for prog in ["true", "false", "sleep", "echo"]:
+        path = shutil.which(prog)
+
+        if path:
+            with open(os.path.realpath(path), "rb") as f:
+                data = f.read()
+
+            if data[:4] == b"\x7fELF":
+                return data
+
+    raise RuntimeError("unable to find an ELF executable to copy")
+
+
+def text(rng, lines):
+    return "".join(" ".join(rng.choice(WORDS) for w in range(10)) + "\n" for i in range(lines))
+
+
+def plan(args):
+    """
+    Decide the payload: a list of (subpackage, kind, index) tuples with
+    the kind being 'elf', 'text', or 'gzip'.
+    """
+    mix = [int(x) for x in args.mix.split(":")]
+
+    if len(mix) != 3 or sum(mix) == 0:
+        raise ValueError("--mix must be three non-negative integers, e.g. 2:6:2")
+
+    kinds = ["elf"] * mix[0] + ["text"] * mix[1] + ["gzip"] * mix[2]
+    files = []
+
+    for sub in range(args.subpackages + 1):
+        for i in range(args.files):
+            files.append((sub, kinds[i % len(kinds)], i))
+
+    return files
+
+
+def payload_path(sub, kind, i, version, renamed):
+    """Where a file lives in the payload."""
+    if kind == "elf":
+        base = "/usr/libexec/%s-%d" % (NAME, sub)
+        name = "prog%05d" % i
+    elif kind == "gzip":
+        base = "/usr/share/doc/%s-%d" % (NAME, sub)
+        name = "notes%05d.gz" % i
+    else:
+        base = "/usr/share/%s-%d" % (NAME, sub)
+        name = "data%05d.txt" % i
+
+    if renamed:
+        base += "-" + version
+
+    return "%s/d%03d/%s" % (base, i // 100, name)
+
+
+def write_tree(args, root, version, after, elf):
+    """
+    Write the payload for one build under root.  Returns a dict mapping
+    subpackage number to the list of payload paths it owns.
+    """
+    owned = {}
+
+    for (sub, kind, i) in plan(args):
+        # each file draws from its own generator so both builds agree
+        rng = random.Random("%d-%d-%d" % (args.seed, sub, i))
+        renamed = rng.random() < args.renames and after
+        changed = rng.random() < args.changes and after
+        linked = rng.random() < args.symlinks
+        path = payload_path(sub, kind, i, version, renamed)
+        dest = root + path
+        os.makedirs(os.path.dirname(dest), exist_ok=True)
+        tag = ("%s-%d-%d-%s" % (kind, sub, i, version if changed else "")).encode()
+
+        if kind == "elf":
+            with open(dest, "wb") as f:
+                f.write(elf + tag)
+
+            os.chmod(dest, 0o755)
+        elif kind == "gzip":
+            with gzip.GzipFile(dest, "wb", mtime=0) as f:
+                f.write(tag + b"\n" + text(rng, args.lines).encode())
+        else:
+            with open(dest, "w") as f:
+                f.write(tag.decode() + "\n" + text(rng, args.lines))
+
+        owned.setdefault(sub, []).append(path)
+
+        if linked:
+            link = dest + ".link"
+            os.symlink(os.path.basename(dest), link)
+            owned[sub].append(path + ".link")
+
+    return owned
+
+
+def spec(args, version, release, owned):
+    lines = [
+        "%global __os_install_post %{nil}",
+        "%global debug_package %{nil}",
+        "%global _build_id_links none",
+        "Name: " + NAME,
+        "Version: " + version,
+        "Release: " + release,
+        "Summary: Synthetic package for benchmarking",
+        "License: GPL-3.0-or-later",
+        "URL: https://github.com/rpminspect/rpminspect",
+        "AutoReqProv: no",
+        "",
+        "%description",
+        "Synthetic package generated for benchmarking rpminspect.",
+        "",
+    ]
+
+    for sub in range(1, args.subpackages + 1):
+        lines += [
+            "%%package sub%d" % sub,
+            "Summary: Synthetic subpackage %d" % sub,
+            "",
+            "%%description sub%d" % sub,
+            "Synthetic subpackage %d generated for benchmarking rpminspect." % sub,
+            "",
+        ]
+
+    lines += [
+        "%install",
+        "cp -a %{_sourcedir}/tree/. %{buildroot}/",
+        "",
+    ]
+
+    for sub in range(args.subpackages + 1):
+        lines.append("%files" if sub == 0 else "%%files sub%d" % sub)
+        lines += sorted(owned.get(sub, []))
+        lines.append("")
+
+    lines += [
+        "%changelog",
+        "* Mon Jan 05 2026 Benchmark <bench@example.com> - %s-%s" % (version, release),
+        "- Synthetic build",
+        "",
+    ]
+
+    return "\n".join(lines)
+
+
+def build(args, outdir, version, release, after, elf):
+    """Generate and build one package, laid out as a local Koji build."""
+    topdir = os.path.join(outdir, "rpmbuild-" + version)
+
+    for sub in ["BUILD", "BUILDROOT", "RPMS", "SOURCES", "SPECS", "SRPMS"]:
+        os.makedirs(os.path.join(topdir, sub), exist_ok=True)
+
+    owned = write_tree(args, os.path.join(topdir, "SOURCES", "tree"), version, after, elf)
+    specfile = os.path.join(topdir, "SPECS", NAME + ".spec")
+
+    with open(specfile, "w") as f:
+        f.write(spec(args, version, release, owned))
+
+    subprocess.run(
+        [
+            "rpmbuild",
+            "--nodeps",
+            "--define", "_topdir " + topdir,
+            "--define", "_rpmfilename %%{ARCH}/%%{NAME}-%%{VERSION}-%%{RELEASE}.%%{ARCH}.rpm",
+            "-ba",
+            specfile,
+        ],
+        check=True,
+        stdout=subprocess.DEVNULL,
+    )
+
+    builddir = os.path.join(outdir, "%s-%s-%s" % (NAME, version, release))
+
+    if os.path.isdir(builddir):
+        shutil.rmtree(builddir)
+
+    os.makedirs(os.path.join(builddir, "src"))
+
+    for srpm in os.listdir(os.path.join(topdir, "SRPMS")):
+        shutil.copy(os.path.join(topdir, "SRPMS", srpm), os.path.join(builddir, "src"))
+
+    for arch in os.listdir(os.path.join(topdir, "RPMS")):
+        shutil.copytree(os.path.join(topdir, "RPMS", arch), os.path.join(builddir, arch))
+
+    shutil.rmtree(topdir)
+    return builddir
+
+
+def add_arguments(parser):
+    parser.add_argument("--files", type=int, default=2000, help="payload files per subpackage (default: 2000)")
+    parser.add_argument("--subpackages", type=int, default=4, help="subpackages besides the main one (default: 4)")
+    parser.add_argument("--mix", default="2:6:2", help="relative share of ELF:text:gzip files (default: 2:6:2)")
+    parser.add_argument("--lines", type=int, default=40, help="lines of text in each text file (default: 40)")
+    parser.add_argument("--symlinks", type=float, default=0.1, help="fraction of files with a symlink (default: 0.1)")
+    parser.add_argument("--renames", type=float, default=0.1, help="fraction of files renamed in the after build (default: 0.1)")
+    parser.add_argument("--changes", type=float, default=0.2, help="fraction of files changed in the after build (default: 0.2)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed so runs are repeatable (default: 1)")
+
+
+def generate(args, outdir):
+    """Generate both builds under outdir, returns (before, after) paths."""
+    elf = elf_template()
+    before = build(args, outdir, BEFORE_VER, BEFORE_REL, False, elf)
+    after = build(args, outdir, AFTER_VER, AFTER_REL, True, elf)
+    return (before, after)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate synthetic before and after builds for benchmarking.")
+    parser.add_argument("outdir", metavar="DIR", help="directory to write the builds to")
+    add_arguments(parser)
+    args = parser.parse_args()
+
+    if shutil.which("rpmbuild") is None:
+        sys.stderr.write("*** rpmbuild not found in PATH\n")
+        return 1
+
+    (before, after) = generate(args, os.path.abspath(args.outdir))
+    print(before)
+    print(after)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,94 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdint.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+static arena_t *arena = NULL;
+
+int init_test_arena(void) {
+    arena = new_arena(256);
+    return 0;
+}
+
+int clean_test_arena(void) {
+    free_arena(arena);
+    return 0;
+}
+
+void test_arena_alloc(void) {
+    char *small = NULL;
+    char *big = NULL;
+    int i = 0;
+
+    /* allocations are aligned and zeroed */
+    for (i = 0; i < 100; i++) {
+        small = arena_alloc(arena, 3);
+        RI_ASSERT_EQUAL((uintptr_t) small % alignof(max_align_t), 0);
+        RI_ASSERT_EQUAL(small[0] | small[1] | small[2], 0);
+        memset(small, 'x', 3);
+    }
+
+    /* bigger than a block */
+    big = arena_alloc(arena, 4096);
+    RI_ASSERT_PTR_NOT_NULL(big);
+    RI_ASSERT_EQUAL((uintptr_t) big % alignof(max_align_t), 0);
+    memset(big, 'y', 4096);
+
+    /* the current block is still used after a big request */
+    small = arena_alloc(arena, 8);
+    RI_ASSERT_PTR_NOT_NULL(small);
+    RI_ASSERT_EQUAL(small[0], 0);
+}
+
+void test_arena_strings(void) {
+    const char *a = NULL;
+    const char *b = NULL;
+    char *c = NULL;
+
+    RI_ASSERT_PTR_NULL(arena_strdup(arena, NULL));
+    RI_ASSERT_EQUAL(arena_intern(arena, NULL) == NULL, true);
+
+    c = arena_strdup(arena, "x86_64");
+    RI_ASSERT_STRING_EQUAL(c, "x86_64");
+
+    /* interned strings are stored once */
+    a = arena_intern(arena, "x86_64");
+    b = arena_intern(arena, c);
+    RI_ASSERT_STRING_EQUAL(a, "x86_64");
+    RI_ASSERT_EQUAL(a == b, true);
+    RI_ASSERT_EQUAL(a == c, false);
+
+    b = arena_intern(arena, "aarch64");
+    RI_ASSERT_STRING_EQUAL(b, "aarch64");
+    RI_ASSERT_EQUAL(a == b, false);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("arena", init_test_arena, clean_test_arena);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test arena_alloc()", test_arena_alloc) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test arena_strdup() and arena_intern()", test_arena_strings) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
@@ -0,0 +1,444 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <sys/stat.h>
+#include <json.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+static char tmpdir[] = "/tmp/test-output.XXXXXX";
+static char *dest = NULL;
+
+int init_test_output(void) {
+    if (mkdtemp(tmpdir) == NULL) {
+        return -1;
+    }
+
+    xasprintf(&dest, "%s/results", tmpdir);
+    return 0;
+}
+
+int clean_test_output(void) {
+    unlink(dest);
+    rmdir(tmpdir);
+    free(dest);
+    return 0;
+}
+
+/* Add a result, msg and details may be NULL */
+static void add(results_t **results, const char *header, const severity_t severity, const waiverauth_t waiverauth, const char *msg, const char *details)
+{
+    struct result_params params;
+
+    init_result_params(&params);
+    params.header = header;
+    params.severity = severity;
+    params.waiverauth = waiverauth;
+    params.msg = (char *) msg;
+    params.details = (char *) details;
+    add_result_entry(results, &params);
+    return;
+}
+
+/*
+ * The first half of the results.  The strings need every kind of
+ * escaping the JSON writer does.
+ */
+static void add_first(results_t **results)
+{
+    add(results, NAME_DIAGNOSTICS, RESULT_DIAG, NOT_WAIVABLE, "Build", "foo-1.0-1");
+    add(results, NAME_LICENSE, RESULT_BAD, WAIVABLE_BY_ANYONE, "Tag \"GPL\" is not approved", "C:\\path/to\tfile\nsecond line\r\b\f");
+    add(results, NAME_LICENSE, RESULT_INFO, NOT_WAIVABLE, "control \x01\x1f and UTF-8 \xc3\xbcnic\xc3\xb8\x64\x65", NULL);
+    add(results, NAME_EMPTYRPM, RESULT_OK, NULL_WAIVERAUTH, NULL, NULL);
+    return;
+}
+
+/* The second half adds to inspections the first half already has */
+static void add_second(results_t **results)
+{
+    add(results, NAME_POLITICS, RESULT_VERIFY, WAIVABLE_BY_SECURITY, "<xml> & 'quotes'", "details");
+    add(results, NAME_LICENSE, RESULT_OK, NULL_WAIVERAUTH, "later license result", NULL);
+    add(results, NAME_DIAGNOSTICS, RESULT_DIAG, NOT_WAIVABLE, "Timings", "{\"wall\": 1.5}");
+    return;
+}
+
+/*
+ * The JSON document the json-c writer produced, with the results for
+ * each inspection gathered in one array.  A streamed run holds the
+ * diagnostics until the end, so they go last if diag_last is true.
+ */
+static char *json_c_output(const results_t *results, const severity_t suppress, const bool diag_last)
+{
+    int pass = 0;
+    char *r = NULL;
+    const results_entry_t *result = NULL;
+    struct json_object *j = NULL;
+    struct json_object *ji = NULL;
+    struct json_object *jr = NULL;
+
+    for (pass = 0; pass < 2; pass++) {
+        TAILQ_FOREACH(result, results, items) {
+            if (suppressed_results(results, result->header, suppress)) {
+                continue;
+            }
+
+            if (diag_last && (pass == 0) == !strcmp(result->header, NAME_DIAGNOSTICS)) {
+                continue;
+            } else if (!diag_last && pass == 1) {
+                break;
+            }
+
+            if (j == NULL) {
+                j = json_object_new_object();
+            }
+
+            if (!json_object_object_get_ex(j, result->header, &ji)) {
+                ji = json_object_new_array();
+                json_object_object_add(j, result->header, ji);
+            }
+
+            jr = json_object_new_object();
+            json_object_object_add(jr, "result", json_object_new_string(strseverity(result->severity)));
+
+            if (result->waiverauth > NULL_WAIVERAUTH) {
+                json_object_object_add(jr, "waiver authorization", json_object_new_string(strwaiverauth(result->waiverauth)));
+            }
+
+            if (result->msg != NULL) {
+                json_object_object_add(jr, "message", json_object_new_string(result->msg));
+            }
+
+            if (result->details != NULL) {
+                json_object_object_add(jr, "details", json_object_new_string(result->details));
+            }
+
+            json_object_array_add(ji, jr);
+        }
+    }
+
+    if (j == NULL) {
+        return NULL;
+    }
+
+    xasprintf(&r, "%s\n", json_object_to_json_string_ext(j, JSON_C_TO_STRING_SPACED | JSON_C_TO_STRING_PRETTY));
+    json_object_put(j);
+    return r;
+}
+
+/* Read the output file, or return NULL if there is none */
+static char *read_output(void)
+{
+    FILE *fp = NULL;
+    char *r = NULL;
+    long len = 0;
+
+    fp = fopen(dest, "r");
+
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    len = ftell(fp);
+    rewind(fp);
+    r = xalloc(len + 1);
+
+    if (fread(r, 1, len, fp) != (size_t) len) {
+        free(r);
+        r = NULL;
+    }
+
+    fclose(fp);
+    return r;
+}
+
+/* Number of files in the output directory */
+static int count_files(void)
+{
+    int n = 0;
+    DIR *d = NULL;
+    struct dirent *de = NULL;
+
+    d = opendir(tmpdir);
+
+    if (d == NULL) {
+        return -1;
+    }
+
+    while ((de = readdir(d)) != NULL) {
+        if (strcmp(de->d_name, ".") && strcmp(de->d_name, "..")) {
+            n++;
+        }
+    }
+
+    closedir(d);
+    return n;
+}
+
+/* Read everything waiting in a pipe without blocking */
+static char *read_pipe(int fd)
+{
+    char *r = NULL;
+    size_t len = 0;
+    ssize_t n = 0;
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    r = xalloc(BUFSIZ + 1);
+
+    while ((n = read(fd, r + len, BUFSIZ)) > 0) {
+        len += n;
+        r = xrealloc(r, len + BUFSIZ + 1);
+    }
+
+    r[len] = '\0';
+    return r;
+}
+
+/* Number of times needle appears in s */
+static int count_string(const char *s, const char *needle)
+{
+    int n = 0;
+
+    while (s != NULL && (s = strstr(s, needle)) != NULL) {
+        n++;
+        s += strlen(needle);
+    }
+
+    return n;
+}
+
+/* Check the output file against the json-c writer */
+static void check_output(const results_t *results, const severity_t suppress, const bool diag_last)
+{
+    char *expected = NULL;
+    char *actual = NULL;
+
+    expected = json_c_output(results, suppress, diag_last);
+    actual = read_output();
+
+    RI_ASSERT_PTR_NOT_NULL(expected);
+    RI_ASSERT_PTR_NOT_NULL(actual);
+
+    if (expected != NULL && actual != NULL) {
+        RI_ASSERT_STRING_EQUAL(actual, expected);
+    }
+
+    /* only the output file is left behind */
+    RI_ASSERT_EQUAL(count_files(), 1);
+
+    free(expected);
+    free(actual);
+    unlink(dest);
+    return;
+}
+
+void test_output_json(void) {
+    results_t *results = NULL;
+
+    add_first(&results);
+    add_second(&results);
+    output_json(results, dest, RESULT_VERIFY, RESULT_NULL);
+    check_output(results, RESULT_NULL, false);
+    free_results(results);
+    return;
+}
+
+void test_output_json_suppress(void) {
+    results_t *results = NULL;
+
+    add_first(&results);
+    add_second(&results);
+    output_json(results, dest, RESULT_VERIFY, RESULT_INFO);
+    check_output(results, RESULT_INFO, false);
+    free_results(results);
+    return;
+}
+
+void test_output_stream_contiguous(void) {
+    results_t *results = NULL;
+    output_stream_t *stream = NULL;
+    char *actual = NULL;
+
+    stream = open_output_stream(FORMAT_JSON, dest, RESULT_VERIFY, RESULT_NULL);
+    RI_ASSERT_PTR_NOT_NULL(stream);
+
+    add_first(&results);
+    write_output_stream(stream, results);
+
+    /* the finished inspections can be read already, the diagnostics are held */
+    actual = read_output();
+    RI_ASSERT_PTR_NOT_NULL(actual);
+    RI_ASSERT_EQUAL(count_string(actual, "\"license\": ["), 1);
+    RI_ASSERT_EQUAL(count_string(actual, "\"diagnostics\": ["), 0);
+    free(actual);
+
+    add(&results, NAME_POLITICS, RESULT_VERIFY, WAIVABLE_BY_SECURITY, "<xml> & 'quotes'", "details");
+    write_output_stream(stream, results);
+    close_output_stream(stream, results);
+    check_output(results, RESULT_NULL, true);
+    free_results(results);
+    return;
+}
+
+void test_output_stream_regroup(void) {
+    results_t *results = NULL;
+    output_stream_t *stream = NULL;
+
+    stream = open_output_stream(FORMAT_JSON, dest, RESULT_VERIFY, RESULT_NULL);
+    RI_ASSERT_PTR_NOT_NULL(stream);
+
+    add_first(&results);
+    write_output_stream(stream, results);
+    add_second(&results);
+    write_output_stream(stream, results);
+    close_output_stream(stream, results);
+    check_output(results, RESULT_NULL, false);
+    free_results(results);
+    return;
+}
+
+void test_output_stream_in_place(void) {
+    results_t *results = NULL;
+    output_stream_t *stream = NULL;
+    char *link = NULL;
+    FILE *fp = NULL;
+    struct stat sb;
+
+    /* an existing file reached through a symlink keeps its mode */
+    fp = fopen(dest, "w");
+    RI_ASSERT_PTR_NOT_NULL(fp);
+    fputs("old contents that are longer than nothing\n", fp);
+    fclose(fp);
+    RI_ASSERT_EQUAL(chmod(dest, 0640), 0);
+    xasprintf(&link, "%s/link", tmpdir);
+    RI_ASSERT_EQUAL(symlink(dest, link), 0);
+
+    stream = open_output_stream(FORMAT_JSON, link, RESULT_VERIFY, RESULT_NULL);
+    RI_ASSERT_PTR_NOT_NULL(stream);
+    add_first(&results);
+    write_output_stream(stream, results);
+    add_second(&results);
+    write_output_stream(stream, results);
+    close_output_stream(stream, results);
+
+    RI_ASSERT_EQUAL(lstat(link, &sb), 0);
+    RI_ASSERT_TRUE(S_ISLNK(sb.st_mode));
+    RI_ASSERT_EQUAL(stat(dest, &sb), 0);
+    RI_ASSERT_EQUAL(sb.st_mode & 07777, 0640);
+    unlink(link);
+    free(link);
+
+    check_output(results, RESULT_NULL, false);
+    free_results(results);
+    return;
+}
+
+void test_output_stream_pipe(void) {
+    int pfd[2];
+    results_t *results = NULL;
+    output_stream_t *stream = NULL;
+    char *path = NULL;
+    char *actual = NULL;
+
+    RI_ASSERT_EQUAL(pipe(pfd), 0);
+    xasprintf(&path, "/dev/fd/%d", pfd[1]);
+
+    stream = open_output_stream(FORMAT_JSON, path, RESULT_VERIFY, RESULT_NULL);
+    RI_ASSERT_PTR_NOT_NULL(stream);
+    add_first(&results);
+    write_output_stream(stream, results);
+    add_second(&results);
+    write_output_stream(stream, results);
+    close_output_stream(stream, results);
+
+    /*
+     * a pipe is never written twice, the late license result is a
+     * second group and the held diagnostics come once at the end
+     */
+    actual = read_pipe(pfd[0]);
+    RI_ASSERT_EQUAL(count_string(actual, "{\n  \""), 1);
+    RI_ASSERT_EQUAL(count_string(actual, "\n}\n"), 1);
+    RI_ASSERT_EQUAL(count_string(actual, "\"license\": ["), 2);
+    RI_ASSERT_EQUAL(count_string(actual, "\"diagnostics\": ["), 1);
+    RI_ASSERT_EQUAL(count_string(actual, "later license result"), 1);
+    RI_ASSERT_EQUAL(count_string(actual, "Timings"), 1);
+
+    close(pfd[0]);
+    close(pfd[1]);
+    free(actual);
+    free(path);
+    free_results(results);
+    return;
+}
+
+void test_output_stream_xunit(void) {
+    results_t *results = NULL;
+    output_stream_t *stream = NULL;
+    char *actual = NULL;
+    char *testcase = NULL;
+
+    stream = open_output_stream(FORMAT_XUNIT, dest, RESULT_VERIFY, RESULT_NULL);
+    RI_ASSERT_PTR_NOT_NULL(stream);
+    add_first(&results);
+    write_output_stream(stream, results);
+    add_second(&results);
+    write_output_stream(stream, results);
+    close_output_stream(stream, results);
+
+    /* one test case per inspection with the late results in it */
+    actual = read_output();
+    RI_ASSERT_PTR_NOT_NULL(actual);
+    RI_ASSERT_EQUAL(count_string(actual, "<?xml"), 1);
+    RI_ASSERT_EQUAL(count_string(actual, "<testsuite tests=\"4\" failures=\"2\""), 1);
+    RI_ASSERT_EQUAL(count_string(actual, "<testcase name=\"/license\""), 1);
+    RI_ASSERT_EQUAL(count_string(actual, "<testcase name=\"/diagnostics\""), 1);
+    RI_ASSERT_EQUAL(count_string(actual, "</testcase>"), 4);
+
+    testcase = (actual == NULL) ? NULL : strstr(actual, "<testcase name=\"/license\"");
+    RI_ASSERT_PTR_NOT_NULL(testcase);
+
+    if (testcase != NULL) {
+        *strstr(testcase, "</testcase>") = '\0';
+        RI_ASSERT_EQUAL(count_string(testcase, "later license result"), 1);
+    }
+
+    RI_ASSERT_EQUAL(count_files(), 1);
+    free(actual);
+    unlink(dest);
+    free_results(results);
+    return;
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("output", init_test_output, clean_test_output);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test output_json()", test_output_json) == NULL ||
+        CU_add_test(pSuite, "test output_json() with suppressed results", test_output_json_suppress) == NULL ||
+        CU_add_test(pSuite, "test write_output_stream()", test_output_stream_contiguous) == NULL ||
+        CU_add_test(pSuite, "test write_output_stream() regrouping results", test_output_stream_regroup) == NULL ||
+        CU_add_test(pSuite, "test write_output_stream() writing a file in place", test_output_stream_in_place) == NULL ||
+        CU_add_test(pSuite, "test write_output_stream() writing to a pipe", test_output_stream_pipe) == NULL ||
+        CU_add_test(pSuite, "test write_output_stream() in xUnit format", test_output_stream_xunit) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
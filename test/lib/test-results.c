@@ -66,6 +66,30 @@ void test_suppressed_results(void) {
     return;
 }
 
+void test_get_results_header(void) {
+    results_header_t *hentry = NULL;
+
+    params_license.severity = RESULT_BAD;
+    add_result(ri, &params_license);
+    params_license.severity = RESULT_INFO;
+    add_result(ri, &params_license);
+
+    hentry = get_results_header(ri->results, NAME_LICENSE);
+    RI_ASSERT_PTR_NOT_NULL(hentry);
+    RI_ASSERT_EQUAL(3, hentry->count);
+    RI_ASSERT_EQUAL(RESULT_BAD, hentry->worst);
+    RI_ASSERT_FALSE(suppressed_results(ri->results, NAME_LICENSE, RESULT_VERIFY));
+
+    hentry = get_results_header(ri->results, NAME_EMPTYRPM);
+    RI_ASSERT_PTR_NOT_NULL(hentry);
+    RI_ASSERT_EQUAL(1, hentry->count);
+    RI_ASSERT_EQUAL(RESULT_DIAG, hentry->worst);
+
+    RI_ASSERT_PTR_NULL(get_results_header(ri->results, NAME_POLITICS));
+    RI_ASSERT_TRUE(suppressed_results(ri->results, NAME_POLITICS, RESULT_INFO));
+    return;
+}
+
 CU_pSuite get_suite(void) {
     CU_pSuite pSuite = NULL;
 
@@ -79,7 +103,8 @@ CU_pSuite get_suite(void) {
     if (CU_add_test(pSuite, "test init_results()", test_init_results) == NULL ||
         CU_add_test(pSuite, "test add_result_entry()", test_add_result_entry) == NULL ||
         CU_add_test(pSuite, "test add_result()", test_add_result) == NULL ||
-        CU_add_test(pSuite, "test suppressed_results()", test_suppressed_results) == NULL) {
+        CU_add_test(pSuite, "test suppressed_results()", test_suppressed_results) == NULL ||
+        CU_add_test(pSuite, "test get_results_header()", test_get_results_header) == NULL) {
         return NULL;
     }
 
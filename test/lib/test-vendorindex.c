@@ -0,0 +1,79 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+/* entries in vendor data file order */
+static char *keys[] = { "/usr/bin/foo", "/usr/lib/*.so", "/usr/lib/libbar.so", "/usr/bin/foo", "/usr/sbin/b?z", NULL };
+static vendor_index_t *literal = NULL;
+static vendor_index_t *wildcard = NULL;
+
+int init_test_vendorindex(void) {
+    int i = 0;
+
+    literal = new_vendor_index(false);
+    wildcard = new_vendor_index(true);
+
+    for (i = 0; keys[i] != NULL; i++) {
+        vendor_index_add(literal, keys[i], &keys[i]);
+        vendor_index_add(wildcard, keys[i], &keys[i]);
+    }
+
+    return 0;
+}
+
+int clean_test_vendorindex(void) {
+    free_vendor_index(literal);
+    free_vendor_index(wildcard);
+    return 0;
+}
+
+void test_vendor_index_literal(void) {
+    /* the first of two identical keys wins */
+    RI_ASSERT_PTR_NOT_NULL(vendor_index_find(literal, "/usr/bin/foo"));
+    RI_ASSERT_EQUAL(vendor_index_find(literal, "/usr/bin/foo") == &keys[0], true);
+
+    /* wildcards are plain characters */
+    RI_ASSERT_EQUAL(vendor_index_find(literal, "/usr/lib/*.so") == &keys[1], true);
+    RI_ASSERT_EQUAL(vendor_index_find(literal, "/usr/lib/libbar.so") == &keys[2], true);
+    RI_ASSERT_PTR_NULL(vendor_index_find(literal, "/usr/lib/libqux.so"));
+    RI_ASSERT_PTR_NULL(vendor_index_find(literal, "/usr/sbin/baz"));
+}
+
+void test_vendor_index_wildcard(void) {
+    RI_ASSERT_EQUAL(vendor_index_find(wildcard, "/usr/bin/foo") == &keys[0], true);
+
+    /* a pattern earlier in the file than a literal key wins */
+    RI_ASSERT_EQUAL(vendor_index_find(wildcard, "/usr/lib/libbar.so") == &keys[1], true);
+    RI_ASSERT_EQUAL(vendor_index_find(wildcard, "/usr/lib/libqux.so") == &keys[1], true);
+    RI_ASSERT_EQUAL(vendor_index_find(wildcard, "/usr/sbin/baz") == &keys[4], true);
+    RI_ASSERT_PTR_NULL(vendor_index_find(wildcard, "/usr/sbin/bazz"));
+    RI_ASSERT_PTR_NULL(vendor_index_find(wildcard, "/usr/lib64/libbar.so"));
+    RI_ASSERT_PTR_NULL(vendor_index_find(NULL, "/usr/bin/foo"));
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("vendorindex", init_test_vendorindex, clean_test_vendorindex);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test vendor_index_find() with literal keys", test_vendor_index_literal) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test vendor_index_find() with wildcards", test_vendor_index_wildcard) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
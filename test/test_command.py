@@ -3,6 +3,8 @@
 # SPDX-License-Identifier: GPL-3.0-or-later
 #
 
+import json
+import os
 import shutil
 import subprocess
 import tempfile
@@ -74,3 +76,153 @@ class RpminspectEmptyPeerList(RequiresRpminspect):
     def tearDown(self):
         super().tearDown()
         shutil.rmtree(self.emptybuild, ignore_errors=True)
+
+
+# Verify a compiled configuration snapshot can be used with -c and is
+# replaced by the original configuration file once that changes
+class RpminspectCompileConfig(RequiresRpminspect):
+    def setUp(self):
+        super().setUp()
+        self.emptybuild = tempfile.mkdtemp()
+        (handle, self.snapshot) = tempfile.mkstemp()
+        os.close(handle)
+
+    def runTest(self):
+        super().configFile()
+        p = subprocess.Popen(
+            [
+                self.rpminspect,
+                "-c",
+                self.conffile,
+                "-r",
+                "GENERIC",
+                "-K",
+                self.snapshot,
+            ],
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+        )
+        (out, err) = p.communicate()
+        self.assertEqual(p.returncode, 0)
+
+        with open(self.snapshot, "rb") as f:
+            self.assertEqual(f.read(8), b"RPMISNAP")
+
+        cmd = [
+            self.rpminspect,
+            "-c",
+            self.snapshot,
+            "-b",
+            self.buildtype,
+            "-F",
+            "json",
+            "-r",
+            "GENERIC",
+            "-o",
+            self.outputfile,
+            self.emptybuild,
+        ]
+
+        p = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        (out, err) = p.communicate()
+        self.assertEqual(p.returncode, 0)
+        self.assertNotIn(b"out of date", err)
+
+        # changing the configuration file makes the snapshot stale
+        st = os.stat(self.conffile)
+        os.utime(self.conffile, ns=(st.st_atime_ns, st.st_mtime_ns + 1000000000))
+
+        p = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        (out, err) = p.communicate()
+        self.assertEqual(p.returncode, 0)
+        self.assertIn(b"out of date", err)
+
+    def tearDown(self):
+        super().tearDown()
+        shutil.rmtree(self.emptybuild, ignore_errors=True)
+        os.unlink(self.snapshot)
+
+
+# Verify -e writes one JSON object per line and an event for every
+# result in the output, including the diagnostics
+class RpminspectEvents(RequiresRpminspect):
+    def setUp(self):
+        super().setUp()
+        self.emptybuild = tempfile.mkdtemp()
+        (handle, self.eventsfile) = tempfile.mkstemp()
+        os.close(handle)
+
+    def runTest(self):
+        super().configFile()
+        p = subprocess.Popen(
+            [
+                self.rpminspect,
+                "-c",
+                self.conffile,
+                "-b",
+                self.buildtype,
+                "-F",
+                "json",
+                "-r",
+                "GENERIC",
+                "-o",
+                self.outputfile,
+                "-e",
+                self.eventsfile,
+                self.emptybuild,
+            ],
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+        )
+        (out, err) = p.communicate()
+        self.assertEqual(p.returncode, 0)
+
+        with open(self.eventsfile) as f:
+            lines = f.read().splitlines()
+
+        events = [json.loads(line) for line in lines]
+        self.assertTrue(all(isinstance(e, dict) for e in events))
+        self.assertEqual(events[-1]["event"], "finish")
+
+        with open(self.outputfile) as f:
+            results = json.load(f)
+
+        expected = sorted(
+            (inspection, r["result"], r.get("message", ""))
+            for (inspection, inspection_results) in results.items()
+            for r in inspection_results
+        )
+        reported = sorted(
+            (e["inspection"], e["result"], e.get("message", ""))
+            for e in events
+            if e["event"] == "result"
+        )
+        self.assertEqual(reported, expected)
+
+    def tearDown(self):
+        super().tearDown()
+        shutil.rmtree(self.emptybuild, ignore_errors=True)
+        os.unlink(self.eventsfile)
+
+
+# Verify -e with a file descriptor is refused with -C since the
+# descriptor would belong to the service
+class RpminspectEventsFdConnect(RequiresRpminspect):
+    def runTest(self):
+        super().configFile()
+        p = subprocess.Popen(
+            [
+                self.rpminspect,
+                "-C",
+                os.path.join(tempfile.gettempdir(), "rpminspect-no-service"),
+                "-e",
+                "1",
+                "-c",
+                self.conffile,
+            ],
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+        )
+        (out, err) = p.communicate()
+        self.assertEqual(p.returncode, 2)
+        self.assertIn(b"-e with a file descriptor cannot be used with -C", err)
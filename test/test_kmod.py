@@ -3,6 +3,7 @@
 # SPDX-License-Identifier: GPL-3.0-or-later
 #
 
+import ctypes
 import glob
 import os
 import shutil
@@ -111,6 +112,74 @@ def get_derp_kmod_aliases(rpminspect):
     return build_module(rpminspect, build_ext="-aliases")
 
 
+# Reference for the alias comparison: the linear fnmatch(3) search
+# compare_module_aliases() did before it used a trie
+libc = ctypes.CDLL(None)
+
+
+def module_aliases(rpminspect, build_ext=""):
+    build_module(rpminspect, build_ext=build_ext or None)
+    kmod = os.path.join(
+        os.path.dirname(rpminspect), "derp-kmod" + build_ext, "derp.ko"
+    )
+    out = subprocess.run(
+        ["modinfo", "-F", "alias", kmod], stdout=subprocess.PIPE, check=True
+    )
+    aliases = {}
+
+    for alias in out.stdout.decode().splitlines():
+        if alias.startswith("pci:"):
+            aliases.setdefault(alias, []).append("derp")
+
+    return aliases
+
+
+def linear_alias_search(alias, after):
+    modules = []
+
+    for pattern, after_modules in after.items():
+        if libc.fnmatch(pattern.encode(), alias.encode(), 0) == 0:
+            modules += after_modules
+
+    return modules
+
+
+def linear_alias_messages(before, after):
+    messages = []
+
+    for alias, before_modules in before.items():
+        after_modules = after.get(alias)
+
+        if after_modules is None or set(before_modules) - set(after_modules):
+            after_modules = linear_alias_search(alias, after)
+
+        if set(before_modules) - set(after_modules):
+            for m in before_modules:
+                messages.append("Kernel module '%s' lost alias '%s'" % (m, alias))
+
+            for m in after_modules:
+                messages.append("Kernel module '%s' gained alias '%s'" % (m, alias))
+
+    return sorted(messages)
+
+
+class LinearAliasesMixin:
+    def runTest(self):
+        super().runTest()
+
+        if not self.inspection:
+            return
+
+        before = module_aliases(self.rpminspect, self.before_ext)
+        after = module_aliases(self.rpminspect, self.after_ext)
+        reported = sorted(
+            r["message"]
+            for r in self.results[self.result_inspection]
+            if " alias '" in r.get("message", "")
+        )
+        self.assertEqual(reported, linear_alias_messages(before, after))
+
+
 ############################
 # kernel module parameters #
 ############################
@@ -403,3 +472,94 @@ class KmodChangingPathCompareKoji(TestCompareKoji):
         self.inspection = "kmod"
         self.result = "OK"
         self.waiver_auth = "Not Waivable"
+
+
+###########################################################
+# alias comparison agrees with a linear fnmatch(3) search #
+###########################################################
+# Same aliases before and after RPMs
+class LinearGoodKmodAliasesRPMs(LinearAliasesMixin, TestCompareRPMs):
+    @unittest.skipUnless(have_kernel_devel, "Need kernel devel files")
+    def setUp(self):
+        super().setUp()
+
+        self.before_rpm.add_installed_file(
+            "/usr/lib/modules/" + kver + "/extra/drivers/derp.ko",
+            rpmfluff.SourceFile("derp.ko", get_derp_kmod_aliases(self.rpminspect)),
+        )
+        self.after_rpm.add_installed_file(
+            "/usr/lib/modules/" + kver + "/extra/drivers/derp.ko",
+            rpmfluff.SourceFile("derp.ko", get_derp_kmod_aliases(self.rpminspect)),
+        )
+
+        self.before_ext = "-aliases"
+        self.after_ext = "-aliases"
+        self.inspection = "kmod"
+        self.result = "OK"
+        self.waiver_auth = "Not Waivable"
+
+
+# Lost aliases between before and after RPMs, some still matched by a wildcard
+class LinearLostKmodAliasesRPMs(LinearAliasesMixin, TestCompareRPMs):
+    @unittest.skipUnless(have_kernel_devel, "Need kernel devel files")
+    def setUp(self):
+        super().setUp()
+
+        self.before_rpm.add_installed_file(
+            "/usr/lib/modules/" + kver + "/extra/drivers/derp.ko",
+            rpmfluff.SourceFile("derp.ko", get_derp_kmod_aliases(self.rpminspect)),
+        )
+        self.after_rpm.add_installed_file(
+            "/usr/lib/modules/" + kver + "/extra/drivers/derp.ko",
+            rpmfluff.SourceFile("derp.ko", get_derp_kmod(self.rpminspect)),
+        )
+
+        self.before_ext = "-aliases"
+        self.after_ext = ""
+        self.inspection = "kmod"
+        self.result = "INFO"
+        self.waiver_auth = "Not Waivable"
+
+
+# Gained aliases between before and after RPMs
+class LinearGainedKmodAliasesRPMs(LinearAliasesMixin, TestCompareRPMs):
+    @unittest.skipUnless(have_kernel_devel, "Need kernel devel files")
+    def setUp(self):
+        super().setUp()
+
+        self.before_rpm.add_installed_file(
+            "/usr/lib/modules/" + kver + "/extra/drivers/derp.ko",
+            rpmfluff.SourceFile("derp.ko", get_derp_kmod(self.rpminspect)),
+        )
+        self.after_rpm.add_installed_file(
+            "/usr/lib/modules/" + kver + "/extra/drivers/derp.ko",
+            rpmfluff.SourceFile("derp.ko", get_derp_kmod_aliases(self.rpminspect)),
+        )
+
+        self.before_ext = ""
+        self.after_ext = "-aliases"
+        self.inspection = "kmod"
+        self.result = "OK"
+        self.waiver_auth = "Not Waivable"
+
+
+# Lost aliases between before and after Koji builds
+class LinearLostKmodAliasesKoji(LinearAliasesMixin, TestCompareKoji):
+    @unittest.skipUnless(have_kernel_devel, "Need kernel devel files")
+    def setUp(self):
+        super().setUp()
+
+        self.before_rpm.add_installed_file(
+            "/usr/lib/modules/" + kver + "/extra/drivers/derp.ko",
+            rpmfluff.SourceFile("derp.ko", get_derp_kmod_aliases(self.rpminspect)),
+        )
+        self.after_rpm.add_installed_file(
+            "/usr/lib/modules/" + kver + "/extra/drivers/derp.ko",
+            rpmfluff.SourceFile("derp.ko", get_derp_kmod(self.rpminspect)),
+        )
+
+        self.before_ext = "-aliases"
+        self.after_ext = ""
+        self.inspection = "kmod"
+        self.result = "INFO"
+        self.waiver_auth = "Not Waivable"
@@ -3,9 +3,12 @@
 # SPDX-License-Identifier: GPL-3.0-or-later
 #
 
+import json
+import os
+import re
 import unittest
 
-from baseclass import TestSRPM, TestRPMs, TestKoji
+from baseclass import AFTER_NAME, TestSRPM, TestRPMs, TestKoji
 
 
 # Empty License tag fails on SRPM (BAD)
@@ -652,3 +655,282 @@ class InvalidSPDXCapitalizationKoji(TestKoji):
         self.inspection = "license"
         self.result = "BAD"
         self.waiver_auth = "Not Waivable"
+
+
+############################################################
+# indexed lookups agree with a linear walk of the database #
+############################################################
+
+
+# Read the test license database.  json-c accepts the trailing commas
+# in it, the json module does not.
+def read_licensedb():
+    path = os.path.join(
+        os.environ["RPMINSPECT_TEST_DATA_PATH"], "licenses", "test.json"
+    )
+
+    with open(path) as f:
+        return json.loads(re.sub(r",(\s*[}\]])", r"\1", f.read()))
+
+
+# The SPDX expression, legacy abbreviations, and legacy names of each
+# license database entry approved for the package.
+def approved_entries(db, package):
+    for block in db.values():
+        lic = block.get("license", {})
+        fedora = block.get("fedora", {})
+        spdx = lic.get("expression")
+        abbrevs = fedora.get("legacy-abbreviation", [])
+        names = fedora.get("legacy-name", [])
+        approved = False
+
+        for status in lic.get("status", []):
+            if status == "allowed" or status.startswith("allowed-"):
+                approved = True
+            elif status == "not-allowed" and package in lic.get(
+                "packages_with_exceptions", []
+            ):
+                approved = True
+
+        if spdx is None:
+            spdx = block.get("spdx_abbrev")
+            abbrevs = [block.get("fedora_abbrev")]
+            names = [block.get("fedora_name")]
+            approved = str(block.get("approved")).lower() in ["yes", "true"]
+
+        if spdx and spdx.startswith("#"):
+            spdx = None
+
+        abbrevs = [a for a in abbrevs if a and not a.startswith("#")]
+        names = [n for n in names if n]
+
+        if approved:
+            yield (spdx, abbrevs, names)
+
+
+# SPDX expressions match case insensitively, but the AND, OR, and WITH
+# keywords must be all lowercase or all uppercase.
+def spdx_match(lic, spdx, keywords):
+    if not spdx or lic.lower() != spdx.lower():
+        return False
+
+    for word in lic.split(" "):
+        if word.upper() in ["AND", "OR", "WITH"] and not (
+            word.isupper() or word.islower()
+        ):
+            keywords.append(word)
+            return False
+
+    return True
+
+
+# Check a license against every approved entry, counting the SPDX,
+# legacy, and dual SPDX/legacy identifiers it matched.
+def check_abbrev(counts, entries, dual, lic):
+    valid = False
+
+    for spdx, abbrevs, names in entries:
+        if spdx_match(lic, spdx, counts["keywords"]):
+            valid = True
+            counts["spdx"] += 1
+
+            if spdx.lower() in [d.lower() for d in dual]:
+                counts["dual"] += 1
+        elif (abbrevs and lic in abbrevs) or (not abbrevs and lic in names):
+            valid = True
+            counts["legacy"] += 1
+
+            if lic in dual:
+                counts["dual"] += 1
+
+    return valid
+
+
+# The expected license inspection result for a License tag, found by
+# walking the database one entry at a time for every token.
+def linear_license_result(license, package=AFTER_NAME):
+    entries = list(approved_entries(read_licensedb(), package))
+    dual = [s for (s, a, n) in entries if s and (s in a or s in n)]
+    counts = {"spdx": 0, "legacy": 0, "dual": 0, "keywords": []}
+
+    # parens must balance
+    balance = 0
+
+    for c in license:
+        if balance < 0:
+            return "BAD"
+        elif c == "(":
+            balance += 1
+        elif c == ")":
+            balance -= 1
+
+    if balance != 0:
+        return "BAD"
+
+    # the whole tag
+    if check_abbrev(counts, entries, dual, license):
+        return "BAD" if counts["keywords"] else "INFO"
+
+    # expressions in parens
+    for exp in re.findall(r"\(+([^)]+)\)", license):
+        if check_abbrev(counts, entries, dual, exp):
+            license = license.replace("(%s)" % exp, "")
+
+    # the remaining tokens between the boolean keywords
+    tokens = []
+    booleans = []
+    words = []
+
+    for word in re.split(r"[ ()]", license):
+        if word == "":
+            continue
+        elif word.upper() in ["AND", "OR"]:
+            booleans.append(word)
+
+            if words:
+                tokens.append(" ".join(words))
+                words = []
+        else:
+            words.append(word)
+
+    if words:
+        tokens.append(" ".join(words))
+
+    result = "INFO"
+
+    for token in tokens:
+        if not check_abbrev(counts, entries, dual, token):
+            result = "BAD"
+
+    if counts["keywords"]:
+        result = "BAD"
+
+    if counts["legacy"] == 0 and counts["dual"] == 0 and counts["spdx"] > 0:
+        for word in booleans:
+            if not (word.isupper() or word.islower()):
+                result = "BAD"
+
+    if counts["legacy"] > 0 and counts["spdx"] > 0 and counts["dual"] == 0:
+        result = "BAD"
+
+    return result
+
+
+# License tag with a legacy "or later" identifier matches the linear walk
+class LinearLegacyOrLaterLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("GPLv2+")
+        self.inspection = "license"
+        self.result = linear_license_result("GPLv2+")
+        self.waiver_auth = "Not Waivable"
+
+
+# License tag with an SPDX "or later" identifier matches the linear walk
+class LinearSPDXOrLaterLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("GPL-2.0-or-later")
+        self.inspection = "license"
+        self.result = linear_license_result("GPL-2.0-or-later")
+        self.waiver_auth = "Not Waivable"
+
+
+# License tag with an SPDX "or later" identifier in another case matches the linear walk
+class LinearSPDXOrLaterMixedCaseLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("gpl-2.0-OR-LATER")
+        self.inspection = "license"
+        self.result = linear_license_result("gpl-2.0-OR-LATER")
+        self.waiver_auth = "Not Waivable"
+
+
+# SPDX "or later" identifier with an exception matches the linear walk
+class LinearSPDXOrLaterWithExceptionLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("GPL-2.0-or-later WITH Exceptions")
+        self.inspection = "license"
+        self.result = linear_license_result("GPL-2.0-or-later WITH Exceptions")
+        self.waiver_auth = "Not Waivable"
+
+
+# Wildcard after an SPDX "or later" identifier matches the linear walk
+class LinearSPDXOrLaterWildcardLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("GPL-2.0-or-later*")
+        self.inspection = "license"
+        self.result = linear_license_result("GPL-2.0-or-later*")
+        self.waiver_auth = "Not Waivable"
+
+
+# License tag with a wildcard LicenseRef identifier matches the linear walk
+class LinearLicenseRefWildcardLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("LicenseRef-*")
+        self.inspection = "license"
+        self.result = linear_license_result("LicenseRef-*")
+        self.waiver_auth = "Not Waivable"
+
+
+# License tag with a bare wildcard matches the linear walk
+class LinearWildcardLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("*")
+        self.inspection = "license"
+        self.result = linear_license_result("*")
+        self.waiver_auth = "Not Waivable"
+
+
+# License tag with a license only allowed for this package matches the linear walk
+class LinearPackageExceptionLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("DERP")
+        self.inspection = "license"
+        self.result = linear_license_result("DERP")
+        self.waiver_auth = "Not Waivable"
+
+
+# License only allowed for this package in an expression matches the linear walk
+class LinearPackageExceptionCompoundLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("DERP AND MIT")
+        self.inspection = "license"
+        self.result = linear_license_result("DERP AND MIT")
+        self.waiver_auth = "Not Waivable"
+
+
+# License tag with a mixed SPDX and legacy identifiers matches the linear walk
+class LinearMixedIdentifiersLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("ASL 2.0 and Apache-2.0")
+        self.inspection = "license"
+        self.result = linear_license_result("ASL 2.0 and Apache-2.0")
+        self.waiver_auth = "Not Waivable"
+
+
+# License tag with a legacy expression in parens matches the linear walk
+class LinearParenExpressionLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("(GPLv2+ and MIT) or ASL 2.0")
+        self.inspection = "license"
+        self.result = linear_license_result("(GPLv2+ and MIT) or ASL 2.0")
+        self.waiver_auth = "Not Waivable"
+
+
+# License tag with a mixed case SPDX keywords matches the linear walk
+class LinearMixedCaseKeywordLicenseTagSRPM(TestSRPM):
+    def setUp(self):
+        super().setUp()
+        self.rpm.addLicense("MIT aNd GPL-2.0-or-later With Exceptions")
+        self.inspection = "license"
+        self.result = linear_license_result("MIT aNd GPL-2.0-or-later With Exceptions")
+        self.waiver_auth = "Not Waivable"
@@ -3572,3 +3572,53 @@ class MissingFileinfoRuleSetgidCompareKoji(TestCompareKoji):
         self.inspection = "ownership"
         self.result = "BAD"
         self.waiver_auth = "Security"
+
+
+####################
+# no file contents #
+####################
+
+
+class OwnershipOnlyCompareRPMs(TestCompareRPMs):
+    """
+    Run only the ownership inspection, which reads no file contents.
+    No payload members are written to disk, but each file still needs
+    its full path for the ignore checks.
+    """
+
+    def setUp(self):
+        super().setUp()
+
+        for rpm in [self.before_rpm, self.after_rpm]:
+            rpm.add_installed_file(
+                installPath="usr/bin/rpminspect",
+                sourceFile=rpmfluff.SourceFile("rpminspect", ri_bytes),
+                owner="root",
+                group="root",
+            )
+
+        self.inspection = "ownership"
+        self.result = "OK"
+
+
+class OwnershipWithXmlCompareRPMs(TestCompareRPMs):
+    """
+    Run ownership with an inspection that reads only some files.  The
+    xml inspection does not want the binary, so it is not written to
+    disk, and ownership still has to handle it.
+    """
+
+    def setUp(self):
+        super().setUp()
+
+        for rpm in [self.before_rpm, self.after_rpm]:
+            rpm.add_installed_file(
+                installPath="usr/bin/rpminspect",
+                sourceFile=rpmfluff.SourceFile("rpminspect", ri_bytes),
+                owner="root",
+                group="root",
+            )
+
+        self.inspection = "ownership,xml"
+        self.result_inspection = "ownership"
+        self.result = "OK"
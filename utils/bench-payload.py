@@ -0,0 +1,152 @@
+#!/usr/bin/python3
+#
+# Copyright The rpminspect Project Authors
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+# Measure payload extraction throughput for the ways rpminspect can
+# unpack a package:
+#
+#     libarchive   libarchive reads the RPM directly and decompresses
+#                  and writes files on one thread (bsdtar -xf pkg.rpm)
+#     helper-1     xz/zstd decompresses in a separate process with one
+#                  thread and pipes the cpio stream to libarchive
+#     helper-N     same, but xz uses one thread per CPU (-T0)
+#
+# For each mode the wall time, the CPU time of all processes, and the
+# uncompressed throughput both overall and per CPU second are
+# reported.  Pass representative packages on the command line, the
+# largest debuginfo packages are the interesting ones.
+#
+# Requires bsdtar(1), xz(1), and zstd(1) in the PATH.
+#
+
+import argparse
+import os
+import resource
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+RPMTAG_PAYLOADCOMPRESSOR = 1125
+RPM_STRING_TYPE = 6
+LEAD_SIZE = 96
+HEADER_INTRO = 16
+
+
+def read_header(f, pad):
+    """Read a header structure and return its tag data and total size."""
+    intro = f.read(HEADER_INTRO)
+
+    if len(intro) != HEADER_INTRO or intro[:3] != b"\x8e\xad\xe8":
+        raise ValueError("bad header magic")
+
+    (il, dl) = struct.unpack(">II", intro[8:])
+    index = f.read(il * 16)
+    store = f.read(dl)
+    size = HEADER_INTRO + len(index) + len(store)
+
+    if pad and size % 8:
+        f.read(8 - (size % 8))
+        size += 8 - (size % 8)
+
+    tags = {}
+
+    for i in range(il):
+        (tag, kind, offset, count) = struct.unpack(">IIII", index[i * 16:(i + 1) * 16])
+
+        if kind == RPM_STRING_TYPE:
+            tags[tag] = store[offset:store.index(b"\x00", offset)].decode()
+
+    return (tags, size)
+
+
+def payload_info(rpm):
+    """Return the payload offset and compressor for the named RPM."""
+    with open(rpm, "rb") as f:
+        f.seek(LEAD_SIZE)
+        read_header(f, True)
+        (tags, _) = read_header(f, False)
+        return (f.tell(), tags.get(RPMTAG_PAYLOADCOMPRESSOR, "gzip"))
+
+
+def run(argv, stdin, dest):
+    """Run argv into bsdtar extracting to dest, return wall and CPU seconds."""
+    before = resource.getrusage(resource.RUSAGE_CHILDREN)
+    start = time.monotonic()
+
+    if argv:
+        helper = subprocess.Popen(argv, stdin=stdin, stdout=subprocess.PIPE)
+        tar = subprocess.Popen(["bsdtar", "-xf", "-", "-C", dest], stdin=helper.stdout)
+        helper.stdout.close()
+        helper.wait()
+    else:
+        tar = subprocess.Popen(["bsdtar", "-xf", stdin.name, "-C", dest])
+
+    tar.wait()
+    wall = time.monotonic() - start
+    after = resource.getrusage(resource.RUSAGE_CHILDREN)
+    cpu = (after.ru_utime - before.ru_utime) + (after.ru_stime - before.ru_stime)
+
+    if tar.returncode != 0 or (argv and helper.returncode != 0):
+        raise RuntimeError("extraction failed")
+
+    return (wall, cpu)
+
+
+def tree_size(path):
+    total = 0
+
+    for (root, dirs, files) in os.walk(path):
+        for name in files:
+            fullpath = os.path.join(root, name)
+
+            if not os.path.islink(fullpath):
+                total += os.path.getsize(fullpath)
+
+    return total
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure RPM payload extraction throughput.")
+    parser.add_argument("rpms", metavar="RPM", nargs="+", help="package to extract")
+    parser.add_argument("-w", "--workdir", default=None, help="directory to extract in to (default: $TMPDIR)")
+    args = parser.parse_args()
+
+    for tool in ["bsdtar", "xz", "zstd"]:
+        if shutil.which(tool) is None:
+            sys.stderr.write("*** %s not found in PATH\n" % tool)
+            return 1
+
+    print("%-40s %-10s %8s %8s %8s %10s %12s" % ("package", "mode", "MiB", "wall", "cpu", "MiB/s", "MiB/s/cpu"))
+
+    for rpm in args.rpms:
+        (offset, compressor) = payload_info(rpm)
+        modes = [("libarchive", None)]
+
+        if compressor == "xz":
+            modes.append(("helper-1", ["xz", "-d", "-c", "-q", "-T1"]))
+            modes.append(("helper-N", ["xz", "-d", "-c", "-q", "-T0"]))
+        elif compressor == "zstd":
+            modes.append(("helper-1", ["zstd", "-d", "-c", "-q"]))
+
+        for (mode, argv) in modes:
+            dest = tempfile.mkdtemp(dir=args.workdir)
+
+            with open(rpm, "rb") as f:
+                f.seek(offset)
+                (wall, cpu) = run(argv, f, dest)
+
+            mib = tree_size(dest) / 1048576
+            shutil.rmtree(dest)
+
+            print("%-40s %-10s %8.1f %8.2f %8.2f %10.1f %12.1f" % (os.path.basename(rpm)[:40], mode, mib, wall, cpu,
+                                                                   mib / wall if wall else 0, mib / cpu if cpu else 0))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())